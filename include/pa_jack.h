@@ -42,6 +42,11 @@
 /** @file
  *  @ingroup public_header
  *  @brief JACK-specific PortAudio API extension header file.
+ *
+ *  The environment variable PA_JACK_WORKER_THREADS, read during Pa_Initialize, sets the number of threads that
+ *  help the JACK process thread with processing streams, so that independent streams are spread over several
+ *  cores. The threads are woken every cycle in which there is more than one stream to process. It is unset or 0
+ *  by default, in which case all streams are processed by the JACK process thread, and is limited to 32.
  */
 
 #include "portaudio.h"
@@ -70,6 +75,24 @@ PaError PaJack_SetClientName( const char* name );
  */
 PaError PaJack_GetClientName(const char** clientName);
 
+/** Latency ranges of a stream's JACK connections, see PaJack_GetStreamLatencyRanges. */
+typedef struct PaJackStreamLatencyRanges
+{
+    PaTime inputMin;    /**< Shortest time for captured audio to reach the stream, 0 for output-only streams */
+    PaTime inputMax;    /**< Longest time for captured audio to reach the stream, 0 for output-only streams */
+    PaTime outputMin;   /**< Shortest time for the stream's output to be heard, 0 for input-only streams */
+    PaTime outputMax;   /**< Longest time for the stream's output to be heard, 0 for input-only streams */
+}
+PaJackStreamLatencyRanges;
+
+/** Get the latency ranges of a stream's connections, as reported by the JACK server.
+ *
+ * The ranges span all ports of the devices the stream is connected to, and are updated when JACK reports that
+ * latencies have changed. Unlike the latencies in PaStreamInfo they don't include the stream's own buffering. The
+ * upper ends of the ranges are used for the inputBufferAdcTime and outputBufferDacTime passed to the stream callback.
+ */
+PaError PaJack_GetStreamLatencyRanges( PaStream *s, PaJackStreamLatencyRanges *ranges );
+
 #ifdef __cplusplus
 }
 #endif
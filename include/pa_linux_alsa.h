@@ -80,6 +80,24 @@ PaError PaAlsa_GetStreamInputCard( PaStream *s, int *card );
 /** Get the ALSA-lib card index of this stream's output device. */
 PaError PaAlsa_GetStreamOutputCard( PaStream *s, int *card );
 
+/** Xrun statistics of a stream, see PaAlsa_GetStreamXrunStats. */
+typedef struct PaAlsaStreamXrunStats
+{
+    unsigned long underrunCount;    /**< Playback underruns since the stream was opened */
+    unsigned long overrunCount;     /**< Capture overruns since the stream was opened */
+    unsigned long restartCount;     /**< Xruns that could only be recovered from by restarting the stream */
+    PaTime lastUnderrunTime;        /**< Time of the most recent underrun, in terms of Pa_GetStreamTime, 0 if none */
+    PaTime lastOverrunTime;         /**< Time of the most recent overrun, in terms of Pa_GetStreamTime, 0 if none */
+}
+PaAlsaStreamXrunStats;
+
+/** Get the xrun statistics of a stream.
+ *
+ * Xruns are counted as the ALSA devices report them, which may be more often than the stream callback is notified
+ * of them through its status flags. May be called from any thread while the stream is open.
+ */
+PaError PaAlsa_GetStreamXrunStats( PaStream *s, PaAlsaStreamXrunStats *stats );
+
 /** Set the number of periods (buffer fragments) to configure devices with.
  *
  * By default the number of periods is 4, this is the lowest number of periods that works well on
@@ -134,7 +134,8 @@ typedef enum PaErrorCode
     paCanNotReadFromAnOutputOnlyStream,
     paCanNotWriteToAnInputOnlyStream,
     paIncompatibleStreamHostApi,
-    paBadBufferPtr
+    paBadBufferPtr,
+    paWriteBufferNotCommitted
 } PaErrorCode;
 
 
@@ -971,6 +972,80 @@ PaError Pa_SetStreamFinishedCallback( PaStream *stream, PaStreamFinishedCallback
 PaError Pa_StartStream( PaStream *stream );
 
 
+/** Does as much of the work of starting a stream as possible in advance, so
+ that a later Pa_StartStream() or Pa_StartStreamAt() gets audio going with as
+ little delay as possible.
+
+ Depending on the host API the device is readied, output buffers are filled
+ with silence or primed, and the stream callback's thread is created and left
+ waiting. The stream remains stopped until it is started, which it has to be
+ before it can be prepared again. Closing a prepared stream undoes the
+ preparation. For host APIs with nothing to prepare this does nothing.
+
+ @param stream A stopped stream.
+
+ @return paNoError on success, paStreamIsNotStopped if the stream is running,
+ otherwise an error code indicating the cause of the error.
+
+ @see Pa_StartStream
+*/
+PaError Pa_PrepareStream( PaStream *stream );
+
+
+/** Commences audio processing at a given time, with sample accuracy where the
+ host API supports it.
+
+ The first frame of output passes the DAC at when, and the first frame of input
+ is the one captured at when, in the same terms as the timeInfo passed to the
+ stream callback. Until then output is silent and input is discarded. The
+ stream is active from the time Pa_StartStreamAt returns, the stream callback
+ is first called for the buffer starting at when. The buffers of a full duplex
+ stream callback stay paired as usual, so for these when applies to output and
+ input starts with the frames captured alongside.
+
+ Several streams started at the same when are aligned to each other as far as
+ their clocks agree, for which they should share a host API.
+
+ @param stream The stream to start.
+
+ @param when The start time, in terms of Pa_GetStreamTime(). If when has
+ already passed, or lies closer than the stream's latency allows, the stream is
+ started as soon as possible like Pa_StartStream() does. A when of zero or less
+ always starts the stream as soon as possible, whatever the stream's time, so a
+ stream whose time is still at or below zero can't be scheduled.
+
+ @note Host APIs which can't schedule the start wait until when and then start
+ the stream, which is only as accurate as the operating system's scheduling.
+
+ @see Pa_StartStream, Pa_GetStreamTime
+*/
+PaError Pa_StartStreamAt( PaStream *stream, PaTime when );
+
+
+/** Commences audio processing on several streams at once, so that they start
+ together within a frame or so rather than one after another.
+
+ Streams of the same host API are started by it as a group where it supports
+ this. Otherwise the streams are started with Pa_StartStreamAt() at a common
+ time a little ahead, which delays the start by about the largest latency of the
+ streams.
+
+ @note Streams of host APIs which can't schedule a start are started one after
+ another once the others have been, and there is no bound on how far apart
+ they start.
+
+ @param streams An array of stopped streams, each of which may appear only once.
+
+ @param count The number of streams in the array.
+
+ @return paNoError once all streams are started. Otherwise none of them are
+ running, unless a host API couldn't take back a partial start.
+
+ @see Pa_StartStream, Pa_StopStreams
+*/
+PaError Pa_StartStreams( PaStream **streams, int count );
+
+
 /** Terminates audio processing. It waits until all pending
  audio buffers have been played before it returns.
 */
@@ -983,6 +1058,19 @@ PaError Pa_StopStream( PaStream *stream );
 PaError Pa_AbortStream( PaStream *stream );
 
 
+/** Terminates audio processing on several streams at once, as Pa_StopStream()
+ does for each of them. Host APIs which support grouped streams stop the
+ streams in the same buffer, others stop them one after another.
+
+ @param streams An array of running streams, each of which may appear only once.
+
+ @param count The number of streams in the array.
+
+ @see Pa_StopStream, Pa_StartStreams
+*/
+PaError Pa_StopStreams( PaStream **streams, int count );
+
+
 /** Determine whether the stream is stopped.
  A stream is considered to be stopped prior to a successful call to
  Pa_StartStream and after a successful call to Pa_StopStream or Pa_AbortStream.
@@ -1158,6 +1246,129 @@ PaError Pa_WriteStream( PaStream* stream,
                         unsigned long frames );
 
 
+/** Read samples from an input stream, waiting no longer than a timeout for
+ them. Unlike Pa_ReadStream() this function may return having read fewer frames
+ than requested, possibly none.
+
+ @param stream A pointer to an open stream previously created with Pa_OpenStream.
+
+ @param buffer A pointer to a buffer of sample frames, as passed to Pa_ReadStream().
+
+ @param frames On entry the number of frames to be read into buffer, on return
+ the number of frames actually read.
+
+ @param timeout The time in seconds to wait for the frames at most. If zero, only
+ the frames which can be read without waiting are read.
+
+ @return On success paNoError will be returned, or paInputOverflowed if input
+ data was discarded by PortAudio after the previous call and before this call.
+
+ @see Pa_ReadStream, Pa_GetStreamPollDescriptor
+*/
+PaError Pa_ReadStreamTimeout( PaStream* stream,
+                              void *buffer,
+                              unsigned long *frames,
+                              PaTime timeout );
+
+
+/** Write samples to an output stream, waiting no longer than a timeout for the
+ stream to accept them. Unlike Pa_WriteStream() this function may return having
+ written fewer frames than requested, possibly none.
+
+ @param stream A pointer to an open stream previously created with Pa_OpenStream.
+
+ @param buffer A pointer to a buffer of sample frames, as passed to Pa_WriteStream().
+
+ @param frames On entry the number of frames to be written from buffer, on return
+ the number of frames actually written.
+
+ @param timeout The time in seconds to wait for the stream at most. If zero, only
+ the frames which can be written without waiting are written.
+
+ @return On success paNoError will be returned, or paOutputUnderflowed if
+ additional output data was inserted after the previous call and before this
+ call.
+
+ @see Pa_WriteStream, Pa_GetStreamPollDescriptor
+*/
+PaError Pa_WriteStreamTimeout( PaStream* stream,
+                               const void *buffer,
+                               unsigned long *frames,
+                               PaTime timeout );
+
+
+/** Retrieve a file descriptor which can be waited on with poll(), select() or
+ epoll for a blocking mode stream to become ready. The descriptor is readable
+ when frames may be read from or written to the stream without waiting. Its
+ readiness is a hint only: it may be readable when the stream can transfer no
+ frames after all, so use Pa_ReadStreamTimeout() and Pa_WriteStreamTimeout()
+ with a zero timeout, or Pa_GetStreamReadAvailable() and
+ Pa_GetStreamWriteAvailable(), to find out.
+
+ The descriptor belongs to the stream and is valid until the stream is closed.
+ It must not be read from, written to or closed by the caller.
+
+ @param stream A pointer to an open stream previously created with Pa_OpenStream.
+
+ @param fd Receives the file descriptor.
+
+ @return On success paNoError will be returned, or paIncompatibleStreamHostApi
+ if the stream's host API provides no such descriptor. For a callback stream
+ paCanNotWriteToACallbackStream will be returned if it has output, otherwise
+ paCanNotReadFromACallbackStream.
+*/
+PaError Pa_GetStreamPollDescriptor( PaStream* stream, int *fd );
+
+
+/** Acquire space in an output stream's buffer to write samples into directly.
+ Where the host buffer holds samples in the format and layout the stream was
+ opened with the returned buffer points into it, and this function waits until
+ at least one frame can be written. Otherwise it is a staging buffer with room
+ for the frames wanted, which is handed out at once and converted when
+ committed; Pa_CommitStreamWriteBuffer() then waits like Pa_WriteStream() does.
+ Each call must be followed by a call to Pa_CommitStreamWriteBuffer() before the
+ stream is written to again, or the stream must be stopped or aborted, which
+ releases the buffer.
+
+ @param stream A pointer to an open stream previously created with Pa_OpenStream.
+
+ @param buffer Receives a pointer to the buffer, laid out as the buffer passed
+ to Pa_WriteStream(). If non-interleaved samples were requested using the
+ paNonInterleaved sample format flag, it receives a pointer to the first element
+ of an array of buffer pointers, one non-interleaved buffer for each channel.
+
+ @param frames On entry the number of frames wanted, on return the number of
+ frames that may be written to buffer, which is at least one and may be less
+ than the number wanted.
+
+ @return On success paNoError will be returned, or paWriteBufferNotCommitted if
+ the buffer acquired before has not been committed yet.
+
+ @see Pa_CommitStreamWriteBuffer
+*/
+PaError Pa_GetStreamWriteBuffer( PaStream* stream,
+                                 void **buffer,
+                                 unsigned long *frames );
+
+
+/** Commit samples written to the buffer acquired with Pa_GetStreamWriteBuffer().
+
+ @param stream A pointer to an open stream previously created with Pa_OpenStream.
+
+ @param frames The number of frames written to the start of the buffer, at most
+ the number of frames returned by Pa_GetStreamWriteBuffer(). Zero releases the
+ buffer without writing anything.
+
+ @return On success paNoError will be returned, or paOutputUnderflowed if
+ additional output data was inserted after the previous write and before this
+ call.
+
+ @see Pa_GetStreamWriteBuffer
+*/
+PaError Pa_CommitStreamWriteBuffer( PaStream* stream,
+                                    unsigned long frames );
+
+
 /** Retrieve the number of frames that can be read from the stream without
  waiting.
 
@@ -0,0 +1,428 @@
+/*
+ * $Id$
+ * Portable Audio I/O Library
+ * Blocking I/O on top of a host API callback
+ *
+ * Based on the Open Source API proposed by Ross Bencina
+ * Copyright (c) 1999-2008 Ross Bencina, Phil Burk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The text above constitutes the entire PortAudio license; however,
+ * the PortAudio community also makes the following non-binding requests:
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version. It is also
+ * requested that these non-binding requests be included along with the
+ * license above.
+ */
+
+/** @file
+ @ingroup common_src
+
+ @brief Blocking read/write for host APIs which only offer a callback.
+
+ The threshold handshake: a waiting thread stores the number of frames it
+ needs, then checks the ring buffer again, while the callback advances the ring
+ buffer, then checks the threshold. A full barrier between the store and the
+ load on either side ensures that at least one of them sees what the other did,
+ so a wakeup can't be lost. Both sides may see each other, in which case the
+ wake function is called for a thread that doesn't wait anymore. This costs the
+ next wait one spurious wakeup, which it tolerates, and saves an atomic
+ compare-and-swap which not every compiler PortAudio supports provides.
+*/
+
+
+#include <string.h>
+
+#include "pa_blockingadapter.h"
+#include "pa_util.h"
+#include "pa_memorybarrier.h"
+
+
+static PaError InitializeFifo( PaUtilRingBuffer *fifo, unsigned long frames, unsigned long bytesPerFrame )
+{
+    void *buffer;
+
+    if( !(buffer = PaUtil_AllocateMemory( frames * bytesPerFrame )) )
+        return paInsufficientMemory;
+    memset( buffer, 0, frames * bytesPerFrame );
+    if( PaUtil_InitializeRingBuffer( fifo, bytesPerFrame, frames, buffer ) != 0 )
+    {
+        PaUtil_FreeMemory( buffer );
+        return paInternalError;
+    }
+
+    return paNoError;
+}
+
+
+static ring_buffer_size_t GetAvailable( PaUtilBlockingAdapter *adapter, int output )
+{
+    return output ? PaUtil_GetRingBufferWriteAvailable( &adapter->outputFifo )
+        : PaUtil_GetRingBufferReadAvailable( &adapter->inputFifo );
+}
+
+
+PaError PaUtil_InitializeBlockingAdapter( PaUtilBlockingAdapter *adapter,
+        PaUtilBufferProcessor *bufferProcessor, unsigned long minimumFrames,
+        unsigned long framesPerHostBuffer, PaUtilBlockingAdapterWaitFunction *waitFunction,
+        PaUtilBlockingAdapterWakeFunction *wakeFunction, void *waitData )
+{
+    PaError result = paNoError;
+    unsigned long frames = 32;
+
+    memset( adapter, 0, sizeof (PaUtilBlockingAdapter) );
+    adapter->bufferProcessor = bufferProcessor;
+    adapter->waitFunction = waitFunction;
+    adapter->wakeFunction = wakeFunction;
+    adapter->waitData = waitData;
+
+    while( frames < minimumFrames )
+        frames *= 2;
+    /* A waiting thread never asks for more frames than the ring buffers hold */
+    adapter->framesPerHostBuffer = framesPerHostBuffer > 0 ? framesPerHostBuffer : 1;
+    if( adapter->framesPerHostBuffer > frames )
+        adapter->framesPerHostBuffer = frames;
+
+    if( bufferProcessor->inputChannelCount > 0 )
+    {
+        result = InitializeFifo( &adapter->inputFifo, frames,
+                bufferProcessor->inputChannelCount * bufferProcessor->bytesPerHostInputSample );
+        if( result != paNoError )
+            goto error;
+        if( !(adapter->inputChannels = (void **)PaUtil_AllocateMemory(
+                        sizeof (void *) * bufferProcessor->inputChannelCount )) )
+        {
+            result = paInsufficientMemory;
+            goto error;
+        }
+    }
+
+    if( bufferProcessor->outputChannelCount > 0 )
+    {
+        result = InitializeFifo( &adapter->outputFifo, frames,
+                bufferProcessor->outputChannelCount * bufferProcessor->bytesPerHostOutputSample );
+        if( result != paNoError )
+            goto error;
+        if( !(adapter->outputChannels = (void **)PaUtil_AllocateMemory(
+                        sizeof (void *) * bufferProcessor->outputChannelCount )) )
+        {
+            result = paInsufficientMemory;
+            goto error;
+        }
+
+        /* Start out with a full buffer of silence, the first writes block until the callback has consumed some */
+        PaUtil_AdvanceRingBufferWriteIndex( &adapter->outputFifo,
+                PaUtil_GetRingBufferWriteAvailable( &adapter->outputFifo ) );
+    }
+
+    return result;
+
+error:
+    PaUtil_TerminateBlockingAdapter( adapter );
+    return result;
+}
+
+
+void PaUtil_TerminateBlockingAdapter( PaUtilBlockingAdapter *adapter )
+{
+    if( adapter->inputFifo.buffer )
+        PaUtil_FreeMemory( adapter->inputFifo.buffer );
+    adapter->inputFifo.buffer = NULL;
+    if( adapter->outputFifo.buffer )
+        PaUtil_FreeMemory( adapter->outputFifo.buffer );
+    adapter->outputFifo.buffer = NULL;
+
+    if( adapter->inputChannels )
+        PaUtil_FreeMemory( adapter->inputChannels );
+    adapter->inputChannels = NULL;
+    if( adapter->outputChannels )
+        PaUtil_FreeMemory( adapter->outputChannels );
+    adapter->outputChannels = NULL;
+}
+
+
+void PaUtil_ResetBlockingAdapter( PaUtilBlockingAdapter *adapter )
+{
+    if( adapter->inputFifo.buffer )
+        PaUtil_FlushRingBuffer( &adapter->inputFifo );
+    if( adapter->outputFifo.buffer )
+    {
+        PaUtil_FlushRingBuffer( &adapter->outputFifo );
+        memset( adapter->outputFifo.buffer, 0,
+                adapter->outputFifo.bufferSize * adapter->outputFifo.elementSizeBytes );
+        PaUtil_AdvanceRingBufferWriteIndex( &adapter->outputFifo,
+                PaUtil_GetRingBufferWriteAvailable( &adapter->outputFifo ) );
+    }
+
+    adapter->readThreshold = adapter->writeThreshold = 0;
+    adapter->inputOverflowed = adapter->outputUnderflowed = 0;
+    PaUtil_WriteMemoryBarrier();
+}
+
+
+/* Wake the waiting thread if available satisfies its threshold. Called from the host API's callback. */
+static void Wake( PaUtilBlockingAdapter *adapter, int output )
+{
+    volatile long *threshold = output ? &adapter->writeThreshold : &adapter->readThreshold;
+    long frames;
+
+    /* The ring buffer index update must be visible before the threshold is looked at */
+    PaUtil_FullMemoryBarrier();
+    frames = *threshold;
+    if( frames > 0 && GetAvailable( adapter, output ) >= frames )
+    {
+        *threshold = 0;
+        if( adapter->wakeFunction )
+            adapter->wakeFunction( adapter->waitData, output );
+    }
+}
+
+
+void PaUtil_AdvanceBlockingAdapterInput( PaUtilBlockingAdapter *adapter,
+        unsigned long frames, unsigned long framesWanted )
+{
+    if( frames < framesWanted )
+        adapter->inputOverflowed = 1;
+    PaUtil_AdvanceRingBufferWriteIndex( &adapter->inputFifo, frames );
+    Wake( adapter, 0 );
+}
+
+
+void PaUtil_AdvanceBlockingAdapterOutput( PaUtilBlockingAdapter *adapter,
+        unsigned long frames, unsigned long framesWanted )
+{
+    if( frames < framesWanted )
+        adapter->outputUnderflowed = 1;
+    PaUtil_AdvanceRingBufferReadIndex( &adapter->outputFifo, frames );
+    Wake( adapter, 1 );
+}
+
+
+PaError PaUtil_WaitForBlockingAdapter( PaUtilBlockingAdapter *adapter, int output,
+        long frames, PaTime deadline )
+{
+    PaError result = paNoError;
+    volatile long *threshold = output ? &adapter->writeThreshold : &adapter->readThreshold;
+
+    while( GetAvailable( adapter, output ) < frames )
+    {
+        *threshold = frames;
+        PaUtil_FullMemoryBarrier();
+        /* The callback may have moved on before it could see the threshold */
+        if( GetAvailable( adapter, output ) >= frames )
+            break;
+
+        if( adapter->waitFunction )
+        {
+            result = adapter->waitFunction( adapter->waitData, output, deadline );
+        }
+        else if( PaUtil_GetTime() < deadline )
+        {
+            Pa_Sleep( 1 );
+        }
+        else
+        {
+            result = paTimedOut;
+        }
+        if( result != paNoError )
+            break;
+    }
+    /* Every way out of the loop ends here, a timed out or failed wait must not leave the callback a threshold to
+       wake a thread which has stopped waiting */
+    *threshold = 0;
+
+    return result;
+}
+
+
+PaError PaUtil_ReadBlockingAdapter( PaUtilBlockingAdapter *adapter, void *buffer,
+        unsigned long *frames, PaTime deadline )
+{
+    PaError result = paNoError;
+    PaUtilBufferProcessor *bp = adapter->bufferProcessor;
+    void *userBuffer = buffer;
+    unsigned long framesLeft = *frames;
+
+    if( bp->inputChannelCount == 0 )
+    {
+        *frames = 0;
+        return paCanNotReadFromAnOutputOnlyStream;
+    }
+
+    if( !bp->userInputIsInterleaved )
+    {
+        /* PaUtil_CopyInput advances the channel pointers, so work on a copy of them */
+        userBuffer = adapter->inputChannels;
+        memcpy( userBuffer, buffer, sizeof (void *) * bp->inputChannelCount );
+    }
+
+    while( framesLeft > 0 )
+    {
+        void *data1, *data2;
+        ring_buffer_size_t size1, size2;
+
+        /* Wake up at most once per host buffer. Whatever has arrived is read on timeout */
+        result = PaUtil_WaitForBlockingAdapter( adapter, 0, framesLeft < adapter->framesPerHostBuffer ?
+                (long)framesLeft : (long)adapter->framesPerHostBuffer, deadline );
+        if( result != paNoError && result != paTimedOut )
+            break;
+
+        PaUtil_GetRingBufferReadRegions( &adapter->inputFifo, framesLeft, &data1, &size1, &data2, &size2 );
+        PaUtil_SetInputFrameCount( bp, size1 );
+        PaUtil_SetInterleavedInputChannels( bp, 0, data1, 0 );
+        PaUtil_CopyInput( bp, &userBuffer, size1 );
+        if( size2 > 0 )
+        {
+            PaUtil_SetInputFrameCount( bp, size2 );
+            PaUtil_SetInterleavedInputChannels( bp, 0, data2, 0 );
+            PaUtil_CopyInput( bp, &userBuffer, size2 );
+        }
+        PaUtil_AdvanceRingBufferReadIndex( &adapter->inputFifo, size1 + size2 );
+        framesLeft -= size1 + size2;
+
+        if( result == paTimedOut )
+            break;
+    }
+    *frames -= framesLeft;
+
+    if( (result == paNoError || result == paTimedOut) && adapter->inputOverflowed )
+    {
+        adapter->inputOverflowed = 0;
+        result = paInputOverflowed;
+    }
+
+    return result;
+}
+
+
+PaError PaUtil_WriteBlockingAdapter( PaUtilBlockingAdapter *adapter, const void *buffer,
+        unsigned long *frames, PaTime deadline )
+{
+    PaError result = paNoError;
+    PaUtilBufferProcessor *bp = adapter->bufferProcessor;
+    const void *userBuffer = buffer;
+    unsigned long framesLeft = *frames;
+
+    if( bp->outputChannelCount == 0 )
+    {
+        *frames = 0;
+        return paCanNotWriteToAnInputOnlyStream;
+    }
+
+    if( !bp->userOutputIsInterleaved )
+    {
+        /* PaUtil_CopyOutput advances the channel pointers, so work on a copy of them */
+        userBuffer = adapter->outputChannels;
+        memcpy( (void *)userBuffer, buffer, sizeof (void *) * bp->outputChannelCount );
+    }
+
+    while( framesLeft > 0 )
+    {
+        void *data1, *data2;
+        ring_buffer_size_t size1, size2;
+
+        /* Wake up at most once per host buffer. Whatever fits is written on timeout */
+        result = PaUtil_WaitForBlockingAdapter( adapter, 1, framesLeft < adapter->framesPerHostBuffer ?
+                (long)framesLeft : (long)adapter->framesPerHostBuffer, deadline );
+        if( result != paNoError && result != paTimedOut )
+            break;
+
+        PaUtil_GetRingBufferWriteRegions( &adapter->outputFifo, framesLeft, &data1, &size1, &data2, &size2 );
+        PaUtil_SetOutputFrameCount( bp, size1 );
+        PaUtil_SetInterleavedOutputChannels( bp, 0, data1, 0 );
+        PaUtil_CopyOutput( bp, &userBuffer, size1 );
+        if( size2 > 0 )
+        {
+            PaUtil_SetOutputFrameCount( bp, size2 );
+            PaUtil_SetInterleavedOutputChannels( bp, 0, data2, 0 );
+            PaUtil_CopyOutput( bp, &userBuffer, size2 );
+        }
+        PaUtil_AdvanceRingBufferWriteIndex( &adapter->outputFifo, size1 + size2 );
+        framesLeft -= size1 + size2;
+
+        if( result == paTimedOut )
+            break;
+    }
+    *frames -= framesLeft;
+
+    if( (result == paNoError || result == paTimedOut) && adapter->outputUnderflowed )
+    {
+        adapter->outputUnderflowed = 0;
+        result = paOutputUnderflowed;
+    }
+
+    return result;
+}
+
+
+PaError PaUtil_GetBlockingAdapterWriteBuffer( PaUtilBlockingAdapter *adapter, void **buffer,
+        unsigned long *frames, PaTime deadline )
+{
+    PaError result;
+    void *data2;
+    ring_buffer_size_t size1, size2;
+
+    if( adapter->bufferProcessor->outputChannelCount == 0 )
+        return paCanNotWriteToAnInputOnlyStream;
+
+    if( (result = PaUtil_WaitForBlockingAdapter( adapter, 1, 1, deadline )) != paNoError )
+        return result;
+
+    /* Only the first region is contiguous */
+    PaUtil_GetRingBufferWriteRegions( &adapter->outputFifo, *frames, buffer, &size1, &data2, &size2 );
+    *frames = size1;
+
+    return paNoError;
+}
+
+
+void PaUtil_CommitBlockingAdapterWriteBuffer( PaUtilBlockingAdapter *adapter, unsigned long frames )
+{
+    PaUtil_AdvanceRingBufferWriteIndex( &adapter->outputFifo, frames );
+}
+
+
+signed long PaUtil_GetBlockingAdapterReadAvailable( PaUtilBlockingAdapter *adapter )
+{
+    if( adapter->bufferProcessor->inputChannelCount == 0 )
+        return paCanNotReadFromAnOutputOnlyStream;
+    return PaUtil_GetRingBufferReadAvailable( &adapter->inputFifo );
+}
+
+
+signed long PaUtil_GetBlockingAdapterWriteAvailable( PaUtilBlockingAdapter *adapter )
+{
+    if( adapter->bufferProcessor->outputChannelCount == 0 )
+        return paCanNotWriteToAnInputOnlyStream;
+    return PaUtil_GetRingBufferWriteAvailable( &adapter->outputFifo );
+}
+
+
+unsigned long PaUtil_GetBlockingAdapterLatencyFrames( PaUtilBlockingAdapter *adapter, int output )
+{
+    if( output )
+        return adapter->outputFifo.buffer ? (unsigned long)adapter->outputFifo.bufferSize : 0;
+    return adapter->inputFifo.buffer ? adapter->framesPerHostBuffer : 0;
+}
@@ -0,0 +1,243 @@
+#ifndef PA_BLOCKINGADAPTER_H
+#define PA_BLOCKINGADAPTER_H
+/*
+ * $Id$
+ * Portable Audio I/O Library
+ * Blocking I/O on top of a host API callback
+ *
+ * Based on the Open Source API proposed by Ross Bencina
+ * Copyright (c) 1999-2008 Ross Bencina, Phil Burk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The text above constitutes the entire PortAudio license; however,
+ * the PortAudio community also makes the following non-binding requests:
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version. It is also
+ * requested that these non-binding requests be included along with the
+ * license above.
+ */
+
+/** @file
+ @ingroup common_src
+
+ @brief Blocking read/write for host APIs which only offer a callback.
+
+ PaUtilBlockingAdapter carries frames between a host API's callback and the
+ threads calling Pa_ReadStream() and Pa_WriteStream(), through a lock-free
+ ring buffer per direction. The ring buffers hold interleaved frames in the
+ host format of the stream's buffer processor, conversion to and from the
+ user's format is done by the buffer processor in the user's thread, straight
+ between the ring buffer and the user's buffer.
+
+ In its callback the host API fills the input ring buffer and drains the
+ output ring buffer through the regions of PaUtil_GetRingBufferWriteRegions()
+ and PaUtil_GetRingBufferReadRegions(), then reports how far it got with
+ PaUtil_AdvanceBlockingAdapterInput() and PaUtil_AdvanceBlockingAdapterOutput().
+ These record overflows and underflows, and wake a waiting user thread.
+
+ A user thread that has to wait posts the number of frames it needs as a
+ threshold, and is woken by the callback once the threshold is reached, rather
+ than on every callback. How to wait and wake is up to the host API: it may
+ pass functions built on the primitives of its platform, or none in which case
+ waiting threads poll with Pa_Sleep().
+*/
+
+
+#include "portaudio.h"
+#include "pa_ringbuffer.h"
+#include "pa_process.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+
+/** Wait to be woken by a PaUtilBlockingAdapterWakeFunction, or at most until
+ deadline. Spurious wakeups are harmless. This is also the place to fail if the
+ stream was stopped or the device has gone away.
+
+ @param output Nonzero when waiting for room in the output ring buffer, zero
+ when waiting for frames in the input ring buffer.
+
+ @return paNoError when woken or after waiting for a while, paTimedOut once the
+ deadline has passed, or an error code which aborts the wait.
+*/
+typedef PaError PaUtilBlockingAdapterWaitFunction( void *waitData, int output, PaTime deadline );
+
+
+/** Wake the thread waiting in a PaUtilBlockingAdapterWaitFunction. Called from
+ the host API's callback, so this must not block.
+*/
+typedef void PaUtilBlockingAdapterWakeFunction( void *waitData, int output );
+
+
+typedef struct PaUtilBlockingAdapter
+{
+    PaUtilRingBuffer inputFifo;     /**< Frames from the callback for Read, or no buffer */
+    PaUtilRingBuffer outputFifo;    /**< Frames from Write for the callback, or no buffer */
+    unsigned long framesPerHostBuffer;
+    PaUtilBufferProcessor *bufferProcessor;
+    void **inputChannels, **outputChannels; /**< Copies of non-interleaved user buffer pointers */
+
+    volatile long readThreshold;    /**< Frames a blocked reader is waiting for, 0 if none */
+    volatile long writeThreshold;   /**< Frames of room a blocked writer is waiting for, 0 if none */
+    volatile int inputOverflowed;   /**< The callback found the input ring buffer full since the last Read */
+    volatile int outputUnderflowed; /**< The callback found the output ring buffer empty since the last Write */
+
+    PaUtilBlockingAdapterWaitFunction *waitFunction;
+    PaUtilBlockingAdapterWakeFunction *wakeFunction;
+    void *waitData;
+} PaUtilBlockingAdapter;
+
+
+/** Initialize a blocking adapter.
+
+ @param bufferProcessor The stream's buffer processor, initialized with
+ interleaved host sample formats. It determines the channel counts and the size
+ of the frames in the ring buffers.
+
+ @param minimumFrames The minimum capacity of the ring buffers in frames, it is
+ rounded up to a power of two. The output ring buffer starts out full of zeros.
+
+ @param framesPerHostBuffer The number of frames the host API processes per
+ callback, or 0 if unknown. Waiting threads are woken at most once per buffer.
+
+ @param waitFunction, wakeFunction, waitData Functions to wait and wake with,
+ see PaUtilBlockingAdapterWaitFunction. If waitFunction is NULL, waiting threads
+ poll instead.
+*/
+PaError PaUtil_InitializeBlockingAdapter( PaUtilBlockingAdapter *adapter,
+        PaUtilBufferProcessor *bufferProcessor, unsigned long minimumFrames,
+        unsigned long framesPerHostBuffer, PaUtilBlockingAdapterWaitFunction *waitFunction,
+        PaUtilBlockingAdapterWakeFunction *wakeFunction, void *waitData );
+
+
+/** Free the resources of a blocking adapter, which may have been initialized
+ only partially.
+*/
+void PaUtil_TerminateBlockingAdapter( PaUtilBlockingAdapter *adapter );
+
+
+/** Return a blocking adapter to its initial state before the stream is
+ (re)started: the input ring buffer is emptied, the output ring buffer filled
+ with zeros, and the overflow and underflow flags cleared. The host API's
+ callback must not be using the adapter meanwhile.
+*/
+void PaUtil_ResetBlockingAdapter( PaUtilBlockingAdapter *adapter );
+
+
+/** Report frames written to the input ring buffer, from the host API's callback.
+
+ @param frames The number of frames written.
+
+ @param framesWanted The number of frames the host had to hand over, frames
+ short of this are flagged as an input overflow.
+*/
+void PaUtil_AdvanceBlockingAdapterInput( PaUtilBlockingAdapter *adapter,
+        unsigned long frames, unsigned long framesWanted );
+
+
+/** Report frames read from the output ring buffer, from the host API's callback.
+
+ @param frames The number of frames read.
+
+ @param framesWanted The number of frames the host needed, frames short of this
+ are flagged as an output underflow. The host plays silence in their place.
+*/
+void PaUtil_AdvanceBlockingAdapterOutput( PaUtilBlockingAdapter *adapter,
+        unsigned long frames, unsigned long framesWanted );
+
+
+/** Wait until at least frames frames can be read from the input ring buffer, or
+ written to the output ring buffer. The threshold the callback wakes the thread
+ at is cleared on return, whatever the outcome.
+
+ @return paTimedOut if this hasn't happened by deadline, or the error returned
+ by the wait function.
+*/
+PaError PaUtil_WaitForBlockingAdapter( PaUtilBlockingAdapter *adapter, int output,
+        long frames, PaTime deadline );
+
+
+/** Read frames into a user buffer, as passed to Pa_ReadStream().
+
+ @param frames On entry the number of frames to read, on return the number of
+ frames read.
+
+ @return paTimedOut if the frames didn't arrive by deadline, in which case the
+ frames that did are read. paInputOverflowed if the callback found the ring
+ buffer full since the previous read, which takes precedence over paTimedOut.
+*/
+PaError PaUtil_ReadBlockingAdapter( PaUtilBlockingAdapter *adapter, void *buffer,
+        unsigned long *frames, PaTime deadline );
+
+
+/** Write frames from a user buffer, as passed to Pa_WriteStream().
+
+ @param frames On entry the number of frames to write, on return the number of
+ frames written.
+
+ @return paTimedOut if there was no room for the frames by deadline, in which
+ case what fits is written. paOutputUnderflowed if the callback found the ring
+ buffer empty since the previous write, which takes precedence over paTimedOut.
+*/
+PaError PaUtil_WriteBlockingAdapter( PaUtilBlockingAdapter *adapter, const void *buffer,
+        unsigned long *frames, PaTime deadline );
+
+
+/** Hand out the output ring buffer's next contiguous region to write host
+ format frames into, waiting until deadline at most for room.
+
+ @param frames On entry the number of frames wanted, on return the number of
+ frames that may be written, at least one.
+*/
+PaError PaUtil_GetBlockingAdapterWriteBuffer( PaUtilBlockingAdapter *adapter, void **buffer,
+        unsigned long *frames, PaTime deadline );
+
+
+/** Commit frames written to the region handed out by PaUtil_GetBlockingAdapterWriteBuffer(). */
+void PaUtil_CommitBlockingAdapterWriteBuffer( PaUtilBlockingAdapter *adapter, unsigned long frames );
+
+
+/** @return The number of frames that can be read without waiting. */
+signed long PaUtil_GetBlockingAdapterReadAvailable( PaUtilBlockingAdapter *adapter );
+
+
+/** @return The number of frames that can be written without waiting. */
+signed long PaUtil_GetBlockingAdapterWriteAvailable( PaUtilBlockingAdapter *adapter );
+
+
+/** @return The latency the adapter adds in a direction, in frames. Written
+ frames queue up in the output ring buffer ahead of the callback, while input
+ frames are handed to a waiting reader after at most one host buffer.
+*/
+unsigned long PaUtil_GetBlockingAdapterLatencyFrames( PaUtilBlockingAdapter *adapter, int output );
+
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* PA_BLOCKINGADAPTER_H */
@@ -120,6 +120,18 @@ PaSampleFormat PaUtil_SelectClosestAvailableFormat(
 
 /* -------------------------------------------------------------------------- */
 
+PaError PaUtil_GetHostSampleSize( PaSampleFormat format )
+{
+    format &= ~(paNonInterleaved | paSwapEndian);
+
+    if( format == paInt24In32 )
+        return 4;
+
+    return Pa_GetSampleSize( format );
+}
+
+/* -------------------------------------------------------------------------- */
+
 #define PA_SELECT_FORMAT_( format, float32, int32, int24, int16, int8, uint8 ) \
     switch( format & ~paNonInterleaved ){                                      \
     case paFloat32:                                                            \
@@ -175,9 +187,86 @@ PaSampleFormat PaUtil_SelectClosestAvailableFormat(
 
 /* -------------------------------------------------------------------------- */
 
+#define PA_SELECT_SWAP_( format )                                              \
+    switch( PaUtil_GetHostSampleSize( format ) ){                              \
+    case 2: return paConverters.Swap_16_To_16;                                 \
+    case 3: return paConverters.Swap_24_To_24;                                 \
+    case 4: return paConverters.Swap_32_To_32;                                 \
+    default: return 0;                                                         \
+    }
+
+/* -------------------------------------------------------------------------- */
+
+/* Conversions from and to the host-only formats, see paInt24In32 and
+    paSwapEndian. Formats must have paNonInterleaved removed. */
+static PaUtilConverter* SelectHostFormatConverter( PaSampleFormat sourceFormat,
+        PaSampleFormat destinationFormat, PaStreamFlags flags )
+{
+    if( sourceFormat == destinationFormat )
+    {
+        switch( PaUtil_GetHostSampleSize( sourceFormat ) ){
+        case 2: PA_UNITY_CONVERSION_( 16 )
+        case 3: PA_UNITY_CONVERSION_( 24 )
+        case 4: PA_UNITY_CONVERSION_( 32 )
+        default: return 0;
+        }
+    }
+    else if( destinationFormat == paInt24In32 )
+    {
+        switch( sourceFormat ){
+        case paFloat32: PA_SELECT_CONVERTER_DITHER_CLIP_( flags, Float32, Int24In32 )
+        case paInt32:   PA_USE_CONVERTER_( Int32, Int24In32 )
+        case paInt24:   PA_USE_CONVERTER_( Int24, Int24In32 )
+        case paInt16:   PA_USE_CONVERTER_( Int16, Int24In32 )
+        default: return 0;
+        }
+    }
+    else if( sourceFormat == paInt24In32 )
+    {
+        switch( destinationFormat ){
+        case paFloat32: PA_USE_CONVERTER_( Int24In32, Float32 )
+        case paInt32:   PA_USE_CONVERTER_( Int24In32, Int32 )
+        case paInt24:   PA_USE_CONVERTER_( Int24In32, Int24 )
+        case paInt16:   PA_USE_CONVERTER_( Int24In32, Int16 )
+        default: return 0;
+        }
+    }
+    else if( destinationFormat == (sourceFormat | paSwapEndian)
+            || sourceFormat == (destinationFormat | paSwapEndian) )
+    {
+        PA_SELECT_SWAP_( sourceFormat )
+    }
+    else if( sourceFormat == paFloat32 )
+    {
+        switch( destinationFormat ){
+        case paInt32 | paSwapEndian:        PA_USE_CONVERTER_( Float32, Int32Swapped )
+        case paInt24In32 | paSwapEndian:    PA_USE_CONVERTER_( Float32, Int24In32Swapped )
+        case paInt16 | paSwapEndian:        PA_USE_CONVERTER_( Float32, Int16Swapped )
+        default: return 0;
+        }
+    }
+    else if( destinationFormat == paFloat32 )
+    {
+        switch( sourceFormat ){
+        case paInt32 | paSwapEndian:        PA_USE_CONVERTER_( Int32Swapped, Float32 )
+        case paInt24In32 | paSwapEndian:    PA_USE_CONVERTER_( Int24In32Swapped, Float32 )
+        case paInt16 | paSwapEndian:        PA_USE_CONVERTER_( Int16Swapped, Float32 )
+        default: return 0;
+        }
+    }
+
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
 PaUtilConverter* PaUtil_SelectConverter( PaSampleFormat sourceFormat,
         PaSampleFormat destinationFormat, PaStreamFlags flags )
 {
+    if( (sourceFormat | destinationFormat) & (paInt24In32 | paSwapEndian) )
+        return SelectHostFormatConverter( sourceFormat & ~paNonInterleaved,
+                destinationFormat & ~paNonInterleaved, flags );
+
     PA_SELECT_FORMAT_( sourceFormat,
                        /* paFloat32: */
                        PA_SELECT_FORMAT_( destinationFormat,
@@ -310,7 +399,31 @@ PaUtilConverterTable paConverters = {
     0, /* PaUtilConverter *Copy_8_To_8; */
     0, /* PaUtilConverter *Copy_16_To_16; */
     0, /* PaUtilConverter *Copy_24_To_24; */
-    0  /* PaUtilConverter *Copy_32_To_32; */
+    0, /* PaUtilConverter *Copy_32_To_32; */
+
+    0, /* PaUtilConverter *Float32_To_Int24In32; */
+    0, /* PaUtilConverter *Float32_To_Int24In32_Dither; */
+    0, /* PaUtilConverter *Float32_To_Int24In32_Clip; */
+    0, /* PaUtilConverter *Float32_To_Int24In32_DitherClip; */
+    0, /* PaUtilConverter *Int32_To_Int24In32; */
+    0, /* PaUtilConverter *Int24_To_Int24In32; */
+    0, /* PaUtilConverter *Int16_To_Int24In32; */
+
+    0, /* PaUtilConverter *Int24In32_To_Float32; */
+    0, /* PaUtilConverter *Int24In32_To_Int32; */
+    0, /* PaUtilConverter *Int24In32_To_Int24; */
+    0, /* PaUtilConverter *Int24In32_To_Int16; */
+
+    0, /* PaUtilConverter *Float32_To_Int32Swapped; */
+    0, /* PaUtilConverter *Float32_To_Int24In32Swapped; */
+    0, /* PaUtilConverter *Float32_To_Int16Swapped; */
+    0, /* PaUtilConverter *Int32Swapped_To_Float32; */
+    0, /* PaUtilConverter *Int24In32Swapped_To_Float32; */
+    0, /* PaUtilConverter *Int16Swapped_To_Float32; */
+
+    0, /* PaUtilConverter *Swap_16_To_16; */
+    0, /* PaUtilConverter *Swap_24_To_24; */
+    0  /* PaUtilConverter *Swap_32_To_32; */
 };
 
 /* -------------------------------------------------------------------------- */
@@ -1777,6 +1890,478 @@ static void Copy_32_To_32(
 
 /* -------------------------------------------------------------------------- */
 
+#define PA_SWAP_16_( x ) ((PaUint16)((((PaUint16)(x)) >> 8) | (((PaUint16)(x)) << 8)))
+
+#define PA_SWAP_32_( x ) ((PaUint32)(((((PaUint32)(x)) >> 24) & 0x000000FF) |  \
+                                     ((((PaUint32)(x)) >> 8)  & 0x0000FF00) |  \
+                                     ((((PaUint32)(x)) << 8)  & 0x00FF0000) |  \
+                                     ((((PaUint32)(x)) << 24) & 0xFF000000)))
+
+/* -------------------------------------------------------------------------- */
+
+static void Float32_To_Int24In32(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    float *src = (float*)sourceBuffer;
+    PaInt32 *dest = (PaInt32*)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        /* convert to 32 bit and shift the low 8 bits out */
+        double scaled = *src * 0x7FFFFFFF;
+        *dest = ((PaInt32) scaled) >> 8;
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Float32_To_Int24In32_Dither(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    float *src = (float*)sourceBuffer;
+    PaInt32 *dest = (PaInt32*)destinationBuffer;
+
+    while( count-- )
+    {
+        double dither  = PaUtil_GenerateFloatTriangularDither( ditherGenerator );
+        /* use smaller scaler to prevent overflow when we add the dither */
+        double dithered = ((double)*src * (2147483646.0)) + dither;
+
+        *dest = ((PaInt32) dithered) >> 8;
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Float32_To_Int24In32_Clip(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    float *src = (float*)sourceBuffer;
+    PaInt32 *dest = (PaInt32*)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        double scaled = *src * 0x7FFFFFFF;
+        PA_CLIP_( scaled, -2147483648., 2147483647.  );
+        *dest = ((PaInt32) scaled) >> 8;
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Float32_To_Int24In32_DitherClip(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    float *src = (float*)sourceBuffer;
+    PaInt32 *dest = (PaInt32*)destinationBuffer;
+
+    while( count-- )
+    {
+        double dither  = PaUtil_GenerateFloatTriangularDither( ditherGenerator );
+        /* use smaller scaler to prevent overflow when we add the dither */
+        double dithered = ((double)*src * (2147483646.0)) + dither;
+        PA_CLIP_( dithered, -2147483648., 2147483647.  );
+
+        *dest = ((PaInt32) dithered) >> 8;
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Int32_To_Int24In32(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    PaInt32 *src = (PaInt32*)sourceBuffer;
+    PaInt32 *dest = (PaInt32*)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        *dest = *src >> 8;
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Int24_To_Int24In32(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    unsigned char *src = (unsigned char*)sourceBuffer;
+    PaInt32 *dest = (PaInt32*)destinationBuffer;
+    PaInt32 temp;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+
+#if defined(PA_LITTLE_ENDIAN)
+        temp = (((PaInt32)src[0]) << 8);
+        temp = temp | (((PaInt32)src[1]) << 16);
+        temp = temp | (((PaInt32)src[2]) << 24);
+#elif defined(PA_BIG_ENDIAN)
+        temp = (((PaInt32)src[0]) << 24);
+        temp = temp | (((PaInt32)src[1]) << 16);
+        temp = temp | (((PaInt32)src[2]) << 8);
+#endif
+
+        *dest = temp >> 8;
+
+        src += sourceStride * 3;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Int16_To_Int24In32(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    PaInt16 *src = (PaInt16*)sourceBuffer;
+    PaInt32 *dest = (PaInt32*)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        *dest = ((PaInt32) *src) * 256;
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Int24In32_To_Float32(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    PaUint32 *src = (PaUint32*)sourceBuffer;
+    float *dest = (float*)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        /* the high byte is not part of the sample, shift it out */
+        *dest = (float) ((double)(PaInt32)(*src << 8) * const_1_div_2147483648_);
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Int24In32_To_Int32(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    PaUint32 *src = (PaUint32*)sourceBuffer;
+    PaInt32 *dest = (PaInt32*)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        *dest = (PaInt32)(*src << 8);
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Int24In32_To_Int24(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    PaUint32 *src = (PaUint32*)sourceBuffer;
+    unsigned char *dest = (unsigned char*)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+
+#if defined(PA_LITTLE_ENDIAN)
+        dest[0] = (unsigned char)(*src);
+        dest[1] = (unsigned char)(*src >> 8);
+        dest[2] = (unsigned char)(*src >> 16);
+#elif defined(PA_BIG_ENDIAN)
+        dest[0] = (unsigned char)(*src >> 16);
+        dest[1] = (unsigned char)(*src >> 8);
+        dest[2] = (unsigned char)(*src);
+#endif
+
+        src += sourceStride;
+        dest += destinationStride * 3;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Int24In32_To_Int16(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    PaUint32 *src = (PaUint32*)sourceBuffer;
+    PaInt16 *dest = (PaInt16*)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        /* the low 8 bits are discarded */
+        *dest = (PaInt16)(PaUint16)(*src >> 8);
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Float32_To_Int32Swapped(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    float *src = (float*)sourceBuffer;
+    PaUint32 *dest = (PaUint32*)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        double scaled = *src * 0x7FFFFFFF;
+        PA_CLIP_( scaled, -2147483648., 2147483647.  );
+        *dest = PA_SWAP_32_( (PaInt32) scaled );
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Float32_To_Int24In32Swapped(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    float *src = (float*)sourceBuffer;
+    PaUint32 *dest = (PaUint32*)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        double scaled = *src * 0x7FFFFFFF;
+        PA_CLIP_( scaled, -2147483648., 2147483647.  );
+        *dest = PA_SWAP_32_( ((PaInt32) scaled) >> 8 );
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Float32_To_Int16Swapped(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    float *src = (float*)sourceBuffer;
+    PaUint16 *dest = (PaUint16*)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        long samp = (long) (*src * (32767.0f));
+        PA_CLIP_( samp, -0x8000, 0x7FFF );
+        *dest = PA_SWAP_16_( (PaInt16) samp );
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Int32Swapped_To_Float32(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    PaUint32 *src = (PaUint32*)sourceBuffer;
+    float *dest = (float*)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        *dest = (float) ((double)(PaInt32)PA_SWAP_32_( *src ) * const_1_div_2147483648_);
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Int24In32Swapped_To_Float32(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    PaUint32 *src = (PaUint32*)sourceBuffer;
+    float *dest = (float*)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        *dest = (float) ((double)(PaInt32)(PA_SWAP_32_( *src ) << 8) * const_1_div_2147483648_);
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Int16Swapped_To_Float32(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    PaUint16 *src = (PaUint16*)sourceBuffer;
+    float *dest = (float*)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        *dest = (float)((PaInt16)PA_SWAP_16_( *src )) * const_1_div_32768_;
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Swap_16_To_16(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    PaUint16 *src = (PaUint16 *)sourceBuffer;
+    PaUint16 *dest = (PaUint16 *)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        *dest = PA_SWAP_16_( *src );
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Swap_24_To_24(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    unsigned char *src = (unsigned char*)sourceBuffer;
+    unsigned char *dest = (unsigned char*)destinationBuffer;
+    unsigned char temp;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        /* source and destination may be the same buffer */
+        temp = src[0];
+        dest[1] = src[1];
+        dest[0] = src[2];
+        dest[2] = temp;
+
+        src += sourceStride * 3;
+        dest += destinationStride * 3;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void Swap_32_To_32(
+    void *destinationBuffer, signed int destinationStride,
+    void *sourceBuffer, signed int sourceStride,
+    unsigned int count, struct PaUtilTriangularDitherGenerator *ditherGenerator )
+{
+    PaUint32 *src = (PaUint32 *)sourceBuffer;
+    PaUint32 *dest = (PaUint32 *)destinationBuffer;
+
+    (void) ditherGenerator; /* unused parameter */
+
+    while( count-- )
+    {
+        *dest = PA_SWAP_32_( *src );
+
+        src += sourceStride;
+        dest += destinationStride;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
 PaUtilConverterTable paConverters = {
     Float32_To_Int32,              /* PaUtilConverter *Float32_To_Int32; */
     Float32_To_Int32_Dither,       /* PaUtilConverter *Float32_To_Int32_Dither; */
@@ -1845,7 +2430,31 @@ PaUtilConverterTable paConverters = {
     Copy_8_To_8,                   /* PaUtilConverter *Copy_8_To_8; */
     Copy_16_To_16,                 /* PaUtilConverter *Copy_16_To_16; */
     Copy_24_To_24,                 /* PaUtilConverter *Copy_24_To_24; */
-    Copy_32_To_32                  /* PaUtilConverter *Copy_32_To_32; */
+    Copy_32_To_32,                 /* PaUtilConverter *Copy_32_To_32; */
+
+    Float32_To_Int24In32,          /* PaUtilConverter *Float32_To_Int24In32; */
+    Float32_To_Int24In32_Dither,   /* PaUtilConverter *Float32_To_Int24In32_Dither; */
+    Float32_To_Int24In32_Clip,     /* PaUtilConverter *Float32_To_Int24In32_Clip; */
+    Float32_To_Int24In32_DitherClip, /* PaUtilConverter *Float32_To_Int24In32_DitherClip; */
+    Int32_To_Int24In32,            /* PaUtilConverter *Int32_To_Int24In32; */
+    Int24_To_Int24In32,            /* PaUtilConverter *Int24_To_Int24In32; */
+    Int16_To_Int24In32,            /* PaUtilConverter *Int16_To_Int24In32; */
+
+    Int24In32_To_Float32,          /* PaUtilConverter *Int24In32_To_Float32; */
+    Int24In32_To_Int32,            /* PaUtilConverter *Int24In32_To_Int32; */
+    Int24In32_To_Int24,            /* PaUtilConverter *Int24In32_To_Int24; */
+    Int24In32_To_Int16,            /* PaUtilConverter *Int24In32_To_Int16; */
+
+    Float32_To_Int32Swapped,       /* PaUtilConverter *Float32_To_Int32Swapped; */
+    Float32_To_Int24In32Swapped,   /* PaUtilConverter *Float32_To_Int24In32Swapped; */
+    Float32_To_Int16Swapped,       /* PaUtilConverter *Float32_To_Int16Swapped; */
+    Int32Swapped_To_Float32,       /* PaUtilConverter *Int32Swapped_To_Float32; */
+    Int24In32Swapped_To_Float32,   /* PaUtilConverter *Int24In32Swapped_To_Float32; */
+    Int16Swapped_To_Float32,       /* PaUtilConverter *Int16Swapped_To_Float32; */
+
+    Swap_16_To_16,                 /* PaUtilConverter *Swap_16_To_16; */
+    Swap_24_To_24,                 /* PaUtilConverter *Swap_24_To_24; */
+    Swap_32_To_32                  /* PaUtilConverter *Swap_32_To_32; */
 };
 
 /* -------------------------------------------------------------------------- */
@@ -1856,9 +2465,12 @@ PaUtilConverterTable paConverters = {
 
 PaUtilZeroer* PaUtil_SelectZeroer( PaSampleFormat destinationFormat )
 {
-    switch( destinationFormat & ~paNonInterleaved ){
+    /* zero is the same in either byte order */
+    switch( destinationFormat & ~(paNonInterleaved | paSwapEndian) ){
     case paFloat32:
         return paZeroers.Zero32;
+    case paInt24In32:
+        return paZeroers.Zero32;
     case paInt32:
         return paZeroers.Zero32;
     case paInt24:
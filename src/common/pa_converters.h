@@ -57,6 +57,30 @@ extern "C"
 struct PaUtilTriangularDitherGenerator;
 
 
+/** Host sample formats which are not part of the public API. Host API
+ implementations may pass these to the buffer processor as host formats, so
+ that devices offering only such formats can be driven without an additional
+ conversion pass in the host's own libraries. They are never seen by clients.
+
+ paInt24In32 holds 24 bit samples in the low three bytes of a 32 bit word,
+ the high byte is ignored on input and written as sign extension on output.
+
+ paSwapEndian may be combined with paFloat32, paInt32, paInt24, paInt16 and
+ paInt24In32, and marks samples stored in the opposite of the native byte
+ order. Only conversions between the unswapped format and its swapped
+ variant, and from/to paFloat32, are supported for swapped formats.
+*/
+#define paInt24In32  ((PaSampleFormat) 0x00100000)
+#define paSwapEndian ((PaSampleFormat) 0x00200000)
+
+
+/** Get the size in bytes of a sample of the given format, which may be one
+ of the host sample formats above.
+ @return The size in bytes, or paSampleFormatNotSupported.
+*/
+PaError PaUtil_GetHostSampleSize( PaSampleFormat format );
+
+
 /** Choose an available sample format which is most appropriate for
  representing the requested format. If the requested format is not available
  higher quality formats are considered before lower quality formates.
@@ -204,6 +228,30 @@ typedef struct{
     PaUtilConverter *Copy_16_To_16;     /* copy without any conversion */
     PaUtilConverter *Copy_24_To_24;     /* copy without any conversion */
     PaUtilConverter *Copy_32_To_32;     /* copy without any conversion */
+
+    PaUtilConverter *Float32_To_Int24In32;
+    PaUtilConverter *Float32_To_Int24In32_Dither;
+    PaUtilConverter *Float32_To_Int24In32_Clip;
+    PaUtilConverter *Float32_To_Int24In32_DitherClip;
+    PaUtilConverter *Int32_To_Int24In32;
+    PaUtilConverter *Int24_To_Int24In32;
+    PaUtilConverter *Int16_To_Int24In32;
+
+    PaUtilConverter *Int24In32_To_Float32;
+    PaUtilConverter *Int24In32_To_Int32;
+    PaUtilConverter *Int24In32_To_Int24;
+    PaUtilConverter *Int24In32_To_Int16;
+
+    PaUtilConverter *Float32_To_Int32Swapped;       /* always clips */
+    PaUtilConverter *Float32_To_Int24In32Swapped;   /* always clips */
+    PaUtilConverter *Float32_To_Int16Swapped;       /* always clips */
+    PaUtilConverter *Int32Swapped_To_Float32;
+    PaUtilConverter *Int24In32Swapped_To_Float32;
+    PaUtilConverter *Int16Swapped_To_Float32;
+
+    PaUtilConverter *Swap_16_To_16;     /* copy reversing the byte order */
+    PaUtilConverter *Swap_24_To_24;     /* copy reversing the byte order */
+    PaUtilConverter *Swap_32_To_32;     /* copy reversing the byte order */
 } PaUtilConverterTable;
 
 
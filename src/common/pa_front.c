@@ -454,6 +454,7 @@ const char *Pa_GetErrorText( PaError errorCode )
     case paCanNotWriteToAnInputOnlyStream:      result = "Can't write to an input only stream"; break;
     case paIncompatibleStreamHostApi: result = "Incompatible stream host API"; break;
     case paBadBufferPtr:             result = "Bad buffer pointer"; break;
+    case paWriteBufferNotCommitted:  result = "Write buffer not committed"; break;
     default:                         
 		if( errorCode > 0 )
 			result = "Invalid error code (value greater than zero)"; 
@@ -764,7 +765,13 @@ const PaDeviceInfo* Pa_GetDeviceInfo( PaDeviceIndex device )
     }
     else
     {
-        result = hostApis_[hostApiIndex]->deviceInfos[ hostSpecificDeviceIndex ];
+        PaUtilHostApiRepresentation *hostApi = hostApis_[hostApiIndex];
+
+        /* Give the host api a chance to determine capabilities it deferred at initialization */
+        if( hostApi->UpdateDeviceInfo )
+            hostApi->UpdateDeviceInfo( hostApi, hostSpecificDeviceIndex );
+
+        result = hostApi->deviceInfos[ hostSpecificDeviceIndex ];
 
         PA_LOGAPI(("Pa_GetDeviceInfo returned:\n" ));
         PA_LOGAPI(("\tPaDeviceInfo*: 0x%p:\n", result ));
@@ -1256,8 +1263,17 @@ PaError Pa_OpenStream( PaStream** stream,
                                   sampleRate, framesPerBuffer, streamFlags, streamCallback, userData );
 
     if( result == paNoError )
+    {
         AddOpenStream( *stream );
 
+        if( outputParameters )
+        {
+            /* Needed by PaUtil_DefaultGetWriteBuffer */
+            PA_STREAM_REP( *stream )->outputChannelCount = outputParameters->channelCount;
+            PA_STREAM_REP( *stream )->outputSampleFormat = outputParameters->sampleFormat;
+        }
+    }
+
 
     PA_LOGAPI(("Pa_OpenStream returned:\n" ));
     PA_LOGAPI(("\t*(PaStream** stream): 0x%p\n", *stream ));
@@ -1452,6 +1468,124 @@ PaError Pa_StartStream( PaStream *stream )
 }
 
 
+PaError Pa_PrepareStream( PaStream *stream )
+{
+    PaError result = PaUtil_ValidateStreamPointer( stream );
+
+    PA_LOGAPI_ENTER_PARAMS( "Pa_PrepareStream" );
+    PA_LOGAPI(("\tPaStream* stream: 0x%p\n", stream ));
+
+    if( result == paNoError )
+    {
+        result = PA_STREAM_INTERFACE(stream)->IsStopped( stream );
+        if( result == 0 )
+        {
+            result = paStreamIsNotStopped ;
+        }
+        else if( result == 1 )
+        {
+            result = PA_STREAM_INTERFACE(stream)->Prepare( stream );
+        }
+    }
+
+    PA_LOGAPI_EXIT_PAERROR( "Pa_PrepareStream", result );
+
+    return result;
+}
+
+
+PaError Pa_StartStreamAt( PaStream *stream, PaTime when )
+{
+    PaError result = PaUtil_ValidateStreamPointer( stream );
+
+    PA_LOGAPI_ENTER_PARAMS( "Pa_StartStreamAt" );
+    PA_LOGAPI(("\tPaStream* stream: 0x%p\n", stream ));
+    PA_LOGAPI(("\tPaTime when: %f\n", when ));
+
+    if( result == paNoError )
+    {
+        result = PA_STREAM_INTERFACE(stream)->IsStopped( stream );
+        if( result == 0 )
+        {
+            result = paStreamIsNotStopped ;
+        }
+        else if( result == 1 )
+        {
+            /* Host APIs take a start time of 0 for none */
+            if( when <= 0. )
+                result = PA_STREAM_INTERFACE(stream)->Start( stream );
+            else
+                result = PA_STREAM_INTERFACE(stream)->StartAt( stream, when );
+        }
+    }
+
+    PA_LOGAPI_EXIT_PAERROR( "Pa_StartStreamAt", result );
+
+    return result;
+}
+
+
+/* Check that streams holds count distinct valid streams, which are stopped if stopped is nonzero and running
+ * otherwise. Returns the StartGroup or StopGroup function shared by all of the streams, or the default one */
+static PaError ValidateStreamGroup( PaStream **streams, int count, int stopped,
+        PaError (**groupFunction)( PaStream**, int ) )
+{
+    PaError result;
+    PaError (*streamGroupFunction)( PaStream**, int );
+    int i, j;
+
+    if( streams == NULL || count < 1 )
+        return paBadStreamPtr;
+
+    for( i = 0; i < count; ++i )
+    {
+        result = PaUtil_ValidateStreamPointer( streams[i] );
+        if( result != paNoError )
+            return result;
+
+        for( j = 0; j < i; ++j )
+        {
+            if( streams[j] == streams[i] )
+                return paBadStreamPtr;
+        }
+
+        result = PA_STREAM_INTERFACE(streams[i])->IsStopped( streams[i] );
+        if( result < 0 )
+            return result;
+        if( result != stopped )
+            return stopped ? paStreamIsNotStopped : paStreamIsStopped;
+
+        streamGroupFunction = stopped ? PA_STREAM_INTERFACE(streams[i])->StartGroup
+                : PA_STREAM_INTERFACE(streams[i])->StopGroup;
+        if( i == 0 )
+            *groupFunction = streamGroupFunction;
+        else if( streamGroupFunction != *groupFunction )
+            *groupFunction = stopped ? PaUtil_DefaultStartStreams : PaUtil_DefaultStopStreams;
+    }
+
+    return paNoError;
+}
+
+
+PaError Pa_StartStreams( PaStream **streams, int count )
+{
+    PaError (*startGroup)( PaStream**, int );
+    PaError result;
+
+    PA_LOGAPI_ENTER_PARAMS( "Pa_StartStreams" );
+    PA_LOGAPI(("\tPaStream** streams: 0x%p\n", streams ));
+    PA_LOGAPI(("\tint count: %d\n", count ));
+
+    result = ValidateStreamGroup( streams, count, 1, &startGroup );
+    if( result == paNoError )
+        result = startGroup( streams, count );
+
+    PA_LOGAPI_EXIT_PAERROR( "Pa_StartStreams", result );
+
+    return result;
+}
+
+
 PaError Pa_StopStream( PaStream *stream )
 {
     PaError result = PaUtil_ValidateStreamPointer( stream );
@@ -1465,6 +1599,8 @@ PaError Pa_StopStream( PaStream *stream )
         if( result == 0 )
         {
             result = PA_STREAM_INTERFACE(stream)->Stop( stream );
+            /* Stopping releases a write buffer that hasn't been committed */
+            PA_STREAM_REP(stream)->writeBufferFrames = 0;
         }
         else if( result == 1 )
         {
@@ -1478,6 +1614,30 @@ PaError Pa_StopStream( PaStream *stream )
 }
 
 
+PaError Pa_StopStreams( PaStream **streams, int count )
+{
+    PaError (*stopGroup)( PaStream**, int );
+    PaError result;
+    int i;
+
+    PA_LOGAPI_ENTER_PARAMS( "Pa_StopStreams" );
+    PA_LOGAPI(("\tPaStream** streams: 0x%p\n", streams ));
+    PA_LOGAPI(("\tint count: %d\n", count ));
+
+    result = ValidateStreamGroup( streams, count, 0, &stopGroup );
+    if( result == paNoError )
+    {
+        result = stopGroup( streams, count );
+        for( i = 0; i < count; ++i )
+            PA_STREAM_REP(streams[i])->writeBufferFrames = 0;
+    }
+
+    PA_LOGAPI_EXIT_PAERROR( "Pa_StopStreams", result );
+
+    return result;
+}
+
+
 PaError Pa_AbortStream( PaStream *stream )
 {
     PaError result = PaUtil_ValidateStreamPointer( stream );
@@ -1491,6 +1651,7 @@ PaError Pa_AbortStream( PaStream *stream )
         if( result == 0 )
         {
             result = PA_STREAM_INTERFACE(stream)->Abort( stream );
+            PA_STREAM_REP(stream)->writeBufferFrames = 0;
         }
         else if( result == 1 )
         {
@@ -1711,6 +1872,204 @@ PaError Pa_WriteStream( PaStream* stream,
     return result;
 }
 
+PaError Pa_ReadStreamTimeout( PaStream* stream,
+                               void *buffer,
+                               unsigned long *frames,
+                               PaTime timeout )
+{
+    PaError result = PaUtil_ValidateStreamPointer( stream );
+
+    PA_LOGAPI_ENTER_PARAMS( "Pa_ReadStreamTimeout" );
+    PA_LOGAPI(("\tPaStream* stream: 0x%p\n", stream ));
+    PA_LOGAPI(("\tPaTime timeout: %g\n", timeout ));
+
+    if( result == paNoError )
+    {
+        if( frames == 0 )
+        {
+            result = paBadBufferPtr;
+        }
+        else if( *frames == 0 )
+        {
+            result = paNoError;
+        }
+        else if( buffer == 0 )
+        {
+            result = paBadBufferPtr;
+        }
+        else
+        {
+            result = PA_STREAM_INTERFACE(stream)->IsStopped( stream );
+            if( result == 0 )
+            {
+                result = PA_STREAM_INTERFACE(stream)->ReadTimeout( stream, buffer, frames,
+                        timeout > 0. ? timeout : 0. );
+            }
+            else
+            {
+                *frames = 0;
+                if( result == 1 )
+                    result = paStreamIsStopped;
+            }
+        }
+    }
+
+    PA_LOGAPI_EXIT_PAERROR( "Pa_ReadStreamTimeout", result );
+
+    return result;
+}
+
+
+PaError Pa_WriteStreamTimeout( PaStream* stream,
+                               const void *buffer,
+                               unsigned long *frames,
+                               PaTime timeout )
+{
+    PaError result = PaUtil_ValidateStreamPointer( stream );
+
+    PA_LOGAPI_ENTER_PARAMS( "Pa_WriteStreamTimeout" );
+    PA_LOGAPI(("\tPaStream* stream: 0x%p\n", stream ));
+    PA_LOGAPI(("\tPaTime timeout: %g\n", timeout ));
+
+    if( result == paNoError )
+    {
+        if( frames == 0 )
+        {
+            result = paBadBufferPtr;
+        }
+        else if( *frames == 0 )
+        {
+            result = paNoError;
+        }
+        else if( buffer == 0 )
+        {
+            result = paBadBufferPtr;
+        }
+        else
+        {
+            result = PA_STREAM_INTERFACE(stream)->IsStopped( stream );
+            if( result == 0 )
+            {
+                result = PA_STREAM_INTERFACE(stream)->WriteTimeout( stream, buffer, frames,
+                        timeout > 0. ? timeout : 0. );
+            }
+            else
+            {
+                *frames = 0;
+                if( result == 1 )
+                    result = paStreamIsStopped;
+            }
+        }
+    }
+
+    PA_LOGAPI_EXIT_PAERROR( "Pa_WriteStreamTimeout", result );
+
+    return result;
+}
+
+
+PaError Pa_GetStreamPollDescriptor( PaStream* stream, int *fd )
+{
+    PaError result = PaUtil_ValidateStreamPointer( stream );
+
+    PA_LOGAPI_ENTER_PARAMS( "Pa_GetStreamPollDescriptor" );
+    PA_LOGAPI(("\tPaStream* stream: 0x%p\n", stream ));
+
+    if( result == paNoError )
+    {
+        if( fd == 0 )
+            result = paBadBufferPtr;
+        else if( PA_STREAM_REP(stream)->streamCallback )
+            result = PA_STREAM_REP(stream)->outputChannelCount > 0 ?
+                    paCanNotWriteToACallbackStream : paCanNotReadFromACallbackStream;
+        else
+            result = PA_STREAM_INTERFACE(stream)->GetPollDescriptor( stream, fd );
+    }
+
+    PA_LOGAPI_EXIT_PAERROR( "Pa_GetStreamPollDescriptor", result );
+
+    return result;
+}
+
+
+PaError Pa_GetStreamWriteBuffer( PaStream* stream,
+                                 void **buffer,
+                                 unsigned long *frames )
+{
+    PaError result = PaUtil_ValidateStreamPointer( stream );
+
+    PA_LOGAPI_ENTER_PARAMS( "Pa_GetStreamWriteBuffer" );
+    PA_LOGAPI(("\tPaStream* stream: 0x%p\n", stream ));
+
+    if( result == paNoError )
+    {
+        if( buffer == 0 || frames == 0 )
+        {
+            result = paBadBufferPtr;
+        }
+        else if( *frames == 0 )
+        {
+            *buffer = 0;
+            result = paNoError;
+        }
+        else if( PA_STREAM_REP(stream)->writeBufferFrames != 0 )
+        {
+            result = paWriteBufferNotCommitted;
+        }
+        else
+        {
+            result = PA_STREAM_INTERFACE(stream)->IsStopped( stream );
+            if( result == 0 )
+            {
+                result = PA_STREAM_INTERFACE(stream)->GetWriteBuffer( stream, buffer, frames );
+                if( result == paNoError )
+                    PA_STREAM_REP(stream)->writeBufferFrames = *frames;
+            }
+            else if( result == 1 )
+            {
+                result = paStreamIsStopped;
+            }
+        }
+    }
+
+    PA_LOGAPI_EXIT_PAERROR( "Pa_GetStreamWriteBuffer", result );
+
+    return result;
+}
+
+
+PaError Pa_CommitStreamWriteBuffer( PaStream* stream,
+                                    unsigned long frames )
+{
+    PaError result = PaUtil_ValidateStreamPointer( stream );
+
+    PA_LOGAPI_ENTER_PARAMS( "Pa_CommitStreamWriteBuffer" );
+    PA_LOGAPI(("\tPaStream* stream: 0x%p\n", stream ));
+
+    if( result == paNoError )
+    {
+        if( PA_STREAM_REP(stream)->writeBufferFrames == 0 )
+        {
+            result = frames == 0 ? paNoError : paBadBufferPtr;
+        }
+        else if( frames > PA_STREAM_REP(stream)->writeBufferFrames )
+        {
+            result = paBadBufferPtr;
+        }
+        else
+        {
+            /* The buffer is released whatever the outcome */
+            PA_STREAM_REP(stream)->writeBufferFrames = 0;
+            result = PA_STREAM_INTERFACE(stream)->CommitWriteBuffer( stream, frames );
+        }
+    }
+
+    PA_LOGAPI_EXIT_PAERROR( "Pa_CommitStreamWriteBuffer", result );
+
+    return result;
+}
+
+
 signed long Pa_GetStreamReadAvailable( PaStream* stream )
 {
     PaError error = PaUtil_ValidateStreamPointer( stream );
@@ -322,6 +322,17 @@ typedef struct PaUtilHostApiRepresentation {
                                   const PaStreamParameters *inputParameters,
                                   const PaStreamParameters *outputParameters,
                                   double sampleRate );
+
+    /**
+        (*UpdateDeviceInfo)() is optional and may be NULL. If supplied it is
+        called by pa_front before the PaDeviceInfo at <hostApiDeviceIndex>
+        (a 0 based index within the host api's own device range) is returned
+        to the client. This allows a host api to enumerate devices by name at
+        initialization time and defer determining their capabilities until
+        they are first needed.
+    */
+    PaError (*UpdateDeviceInfo)( struct PaUtilHostApiRepresentation *hostApi,
+                                 int hostApiDeviceIndex );
 } PaUtilHostApiRepresentation;
 
 
@@ -128,6 +128,8 @@ PaError PaUtil_InitializeBufferProcessor( PaUtilBufferProcessor* bp,
 
     bp->hostInputChannels[0] = bp->hostInputChannels[1] = 0;
     bp->hostOutputChannels[0] = bp->hostOutputChannels[1] = 0;
+    bp->hostInputChannelsPacked[0] = bp->hostInputChannelsPacked[1] = 0;
+    bp->hostOutputChannelsPacked[0] = bp->hostOutputChannelsPacked[1] = 0;
 
     if( framesPerUserBuffer == 0 ) /* streamCallback will accept any buffer size */
     {
@@ -201,7 +203,7 @@ PaError PaUtil_InitializeBufferProcessor( PaUtilBufferProcessor* bp,
     
     if( inputChannelCount > 0 )
     {
-        bytesPerSample = Pa_GetSampleSize( hostInputSampleFormat );
+        bytesPerSample = PaUtil_GetHostSampleSize( hostInputSampleFormat );
         if( bytesPerSample > 0 )
         {
             bp->bytesPerHostInputSample = bytesPerSample;
@@ -283,7 +285,7 @@ PaError PaUtil_InitializeBufferProcessor( PaUtilBufferProcessor* bp,
 
     if( outputChannelCount > 0 )
     {
-        bytesPerSample = Pa_GetSampleSize( hostOutputSampleFormat );
+        bytesPerSample = PaUtil_GetHostSampleSize( hostOutputSampleFormat );
         if( bytesPerSample > 0 )
         {
             bp->bytesPerHostOutputSample = bytesPerSample;
@@ -355,6 +357,9 @@ PaError PaUtil_InitializeBufferProcessor( PaUtilBufferProcessor* bp,
 
     bp->samplePeriod = 1. / sampleRate;
 
+    bp->startTime = 0.;
+    bp->startDelayFrames = 0;
+
     bp->streamCallback = streamCallback;
     bp->userData = userData;
 
@@ -425,6 +430,16 @@ void PaUtil_ResetBufferProcessor( PaUtilBufferProcessor* bp )
             bp->framesPerTempBuffer * bp->bytesPerUserOutputSample * bp->outputChannelCount;
         memset( bp->tempOutputBuffer, 0, tempOutputBufferSize );
     }
+
+    bp->startTime = 0.;
+    bp->startDelayFrames = 0;
+}
+
+
+void PaUtil_SetBufferProcessorStartTime( PaUtilBufferProcessor* bp, PaTime startTime )
+{
+    bp->startTime = startTime;
+    bp->startDelayFrames = 0;
 }
 
 
@@ -465,6 +480,7 @@ void PaUtil_SetInputChannel( PaUtilBufferProcessor* bp,
     
     bp->hostInputChannels[0][channel].data = data;
     bp->hostInputChannels[0][channel].stride = stride;
+    bp->hostInputChannelsPacked[0] = 0;
 }
 
 
@@ -488,6 +504,30 @@ void PaUtil_SetInterleavedInputChannels( PaUtilBufferProcessor* bp,
         p += bp->bytesPerHostInputSample;
         bp->hostInputChannels[0][channel+i].stride = channelCount;
     }
+
+    bp->hostInputChannelsPacked[0] = ( firstChannel == 0 && channelCount == bp->inputChannelCount );
+}
+
+
+void PaUtil_SetInputChannels( PaUtilBufferProcessor* bp,
+        unsigned int firstChannel, void *data, unsigned int channelCount,
+        unsigned int channelSpacing, unsigned int stride )
+{
+    unsigned int i;
+    unsigned char *p = (unsigned char*)data;
+    PaUtilChannelDescriptor *channels = &bp->hostInputChannels[0][firstChannel];
+
+    assert( firstChannel + channelCount <= bp->inputChannelCount );
+
+    for( i=0; i<channelCount; ++i )
+    {
+        channels[i].data = p;
+        channels[i].stride = stride;
+        p += channelSpacing;
+    }
+
+    bp->hostInputChannelsPacked[0] = ( firstChannel == 0 && channelCount == bp->inputChannelCount
+            && stride == channelCount && channelSpacing == bp->bytesPerHostInputSample );
 }
 
 
@@ -499,6 +539,7 @@ void PaUtil_SetNonInterleavedInputChannel( PaUtilBufferProcessor* bp,
     
     bp->hostInputChannels[0][channel].data = data;
     bp->hostInputChannels[0][channel].stride = 1;
+    bp->hostInputChannelsPacked[0] = 0;
 }
 
 
@@ -516,6 +557,7 @@ void PaUtil_Set2ndInputChannel( PaUtilBufferProcessor* bp,
 
     bp->hostInputChannels[1][channel].data = data;
     bp->hostInputChannels[1][channel].stride = stride;
+    bp->hostInputChannelsPacked[1] = 0;
 }
 
 
@@ -539,6 +581,8 @@ void PaUtil_Set2ndInterleavedInputChannels( PaUtilBufferProcessor* bp,
         p += bp->bytesPerHostInputSample;
         bp->hostInputChannels[1][channel+i].stride = channelCount;
     }
+
+    bp->hostInputChannelsPacked[1] = ( firstChannel == 0 && channelCount == bp->inputChannelCount );
 }
 
         
@@ -550,6 +594,7 @@ void PaUtil_Set2ndNonInterleavedInputChannel( PaUtilBufferProcessor* bp,
     
     bp->hostInputChannels[1][channel].data = data;
     bp->hostInputChannels[1][channel].stride = 1;
+    bp->hostInputChannelsPacked[1] = 0;
 }
 
 
@@ -581,6 +626,7 @@ void PaUtil_SetOutputChannel( PaUtilBufferProcessor* bp,
 
     bp->hostOutputChannels[0][channel].data = data;
     bp->hostOutputChannels[0][channel].stride = stride;
+    bp->hostOutputChannelsPacked[0] = 0;
 }
 
 
@@ -603,6 +649,30 @@ void PaUtil_SetInterleavedOutputChannels( PaUtilBufferProcessor* bp,
         PaUtil_SetOutputChannel( bp, channel + i, p, channelCount );
         p += bp->bytesPerHostOutputSample;
     }
+
+    bp->hostOutputChannelsPacked[0] = ( firstChannel == 0 && channelCount == bp->outputChannelCount );
+}
+
+
+void PaUtil_SetOutputChannels( PaUtilBufferProcessor* bp,
+        unsigned int firstChannel, void *data, unsigned int channelCount,
+        unsigned int channelSpacing, unsigned int stride )
+{
+    unsigned int i;
+    unsigned char *p = (unsigned char*)data;
+    PaUtilChannelDescriptor *channels = &bp->hostOutputChannels[0][firstChannel];
+
+    assert( firstChannel + channelCount <= bp->outputChannelCount );
+
+    for( i=0; i<channelCount; ++i )
+    {
+        channels[i].data = p;
+        channels[i].stride = stride;
+        p += channelSpacing;
+    }
+
+    bp->hostOutputChannelsPacked[0] = ( firstChannel == 0 && channelCount == bp->outputChannelCount
+            && stride == channelCount && channelSpacing == bp->bytesPerHostOutputSample );
 }
 
 
@@ -631,6 +701,7 @@ void PaUtil_Set2ndOutputChannel( PaUtilBufferProcessor* bp,
 
     bp->hostOutputChannels[1][channel].data = data;
     bp->hostOutputChannels[1][channel].stride = stride;
+    bp->hostOutputChannelsPacked[1] = 0;
 }
 
 
@@ -653,6 +724,8 @@ void PaUtil_Set2ndInterleavedOutputChannels( PaUtilBufferProcessor* bp,
         PaUtil_Set2ndOutputChannel( bp, channel + i, p, channelCount );
         p += bp->bytesPerHostOutputSample;
     }
+
+    bp->hostOutputChannelsPacked[1] = ( firstChannel == 0 && channelCount == bp->outputChannelCount );
 }
 
         
@@ -689,6 +762,103 @@ void PaUtil_BeginBufferProcessing( PaUtilBufferProcessor* bp,
 
     bp->hostInputFrameCount[1] = 0;
     bp->hostOutputFrameCount[1] = 0;
+
+    /* The first buffer after a scheduled start tells how far ahead the start
+        lies. Counting in frames from here on keeps the start sample accurate */
+    if( bp->startTime > 0. )
+    {
+        PaTime bufferTime = bp->outputChannelCount > 0 ? timeInfo->outputBufferDacTime
+                : timeInfo->inputBufferAdcTime;
+        double delay = (bp->startTime - bufferTime) / bp->samplePeriod;
+
+        bp->startDelayFrames = delay > 0. ? (unsigned long)(delay + .5) : 0;
+        bp->startTime = 0.;
+    }
+}
+
+
+/*
+    ConvertHostInput() converts frameCount frames of every host input channel
+    into the user buffer at destBytePtr, and advances the host channel pointers.
+    When the host channels are packed (see hostInputChannelsPacked) and the
+    user buffer is interleaved, the frames form one run of samples on both
+    sides and are converted with a single converter call, regardless of the
+    number of channels.
+*/
+static void ConvertHostInput( PaUtilBufferProcessor *bp,
+        PaUtilChannelDescriptor *hostInputChannels,
+        unsigned char *destBytePtr, unsigned int destSampleStrideSamples,
+        unsigned int destChannelStrideBytes, unsigned long frameCount )
+{
+    unsigned int i;
+
+    if( bp->hostInputChannelsPacked[ hostInputChannels == bp->hostInputChannels[1] ]
+            && destSampleStrideSamples == bp->inputChannelCount
+            && destChannelStrideBytes == bp->bytesPerUserInputSample )
+    {
+        bp->inputConverter( destBytePtr, 1, hostInputChannels[0].data, 1,
+                frameCount * bp->inputChannelCount, &bp->ditherGenerator );
+    }
+    else
+    {
+        for( i=0; i<bp->inputChannelCount; ++i )
+        {
+            bp->inputConverter( destBytePtr, destSampleStrideSamples,
+                                    hostInputChannels[i].data,
+                                    hostInputChannels[i].stride,
+                                    frameCount, &bp->ditherGenerator );
+
+            destBytePtr += destChannelStrideBytes;  /* skip to next destination channel */
+        }
+    }
+
+    for( i=0; i<bp->inputChannelCount; ++i )
+    {
+        /* advance src ptr for next iteration */
+        hostInputChannels[i].data = ((unsigned char*)hostInputChannels[i].data) +
+                frameCount * hostInputChannels[i].stride * bp->bytesPerHostInputSample;
+    }
+}
+
+
+/*
+    ConvertHostOutput() is the output counterpart of ConvertHostInput(), it
+    converts frameCount frames from the user buffer at srcBytePtr into every
+    host output channel.
+*/
+static void ConvertHostOutput( PaUtilBufferProcessor *bp,
+        PaUtilChannelDescriptor *hostOutputChannels,
+        unsigned char *srcBytePtr, unsigned int srcSampleStrideSamples,
+        unsigned int srcChannelStrideBytes, unsigned long frameCount )
+{
+    unsigned int i;
+
+    if( bp->hostOutputChannelsPacked[ hostOutputChannels == bp->hostOutputChannels[1] ]
+            && srcSampleStrideSamples == bp->outputChannelCount
+            && srcChannelStrideBytes == bp->bytesPerUserOutputSample )
+    {
+        bp->outputConverter( hostOutputChannels[0].data, 1, srcBytePtr, 1,
+                frameCount * bp->outputChannelCount, &bp->ditherGenerator );
+    }
+    else
+    {
+        for( i=0; i<bp->outputChannelCount; ++i )
+        {
+            bp->outputConverter(    hostOutputChannels[i].data,
+                                    hostOutputChannels[i].stride,
+                                    srcBytePtr, srcSampleStrideSamples,
+                                    frameCount, &bp->ditherGenerator );
+
+            srcBytePtr += srcChannelStrideBytes;  /* skip to next source channel */
+        }
+    }
+
+    for( i=0; i<bp->outputChannelCount; ++i )
+    {
+        /* advance dest ptr for next iteration */
+        hostOutputChannels[i].data = ((unsigned char*)hostOutputChannels[i].data) +
+                frameCount * hostOutputChannels[i].stride * bp->bytesPerHostOutputSample;
+    }
 }
 
 
@@ -807,19 +977,8 @@ static unsigned long NonAdaptingProcess( PaUtilBufferProcessor *bp,
                     }
                     else
                     {
-                        for( i=0; i<bp->inputChannelCount; ++i )
-                        {
-                            bp->inputConverter( destBytePtr, destSampleStrideSamples,
-                                                    hostInputChannels[i].data,
-                                                    hostInputChannels[i].stride,
-                                                    frameCount, &bp->ditherGenerator );
-
-                            destBytePtr += destChannelStrideBytes;  /* skip to next destination channel */
-
-                            /* advance src ptr for next iteration */
-                            hostInputChannels[i].data = ((unsigned char*)hostInputChannels[i].data) +
-                                    frameCount * hostInputChannels[i].stride * bp->bytesPerHostInputSample;
-                        }
+                        ConvertHostInput( bp, hostInputChannels, destBytePtr, destSampleStrideSamples,
+                                destChannelStrideBytes, frameCount );
                     }
                 }
             }
@@ -912,19 +1071,8 @@ static unsigned long NonAdaptingProcess( PaUtilBufferProcessor *bp,
                         	srcChannelStrideBytes = frameCount * bp->bytesPerUserOutputSample;
                     	}
 
-                    	for( i=0; i<bp->outputChannelCount; ++i )
-                    	{
-                        	bp->outputConverter(    hostOutputChannels[i].data,
-                                                	hostOutputChannels[i].stride,
-                                                	srcBytePtr, srcSampleStrideSamples,
-                                                	frameCount, &bp->ditherGenerator );
-
-                        	srcBytePtr += srcChannelStrideBytes;  /* skip to next source channel */
-
-                        	/* advance dest ptr for next iteration */
-                        	hostOutputChannels[i].data = ((unsigned char*)hostOutputChannels[i].data) +
-                                		frameCount * hostOutputChannels[i].stride * bp->bytesPerHostOutputSample;
-                    	}
+                    	ConvertHostOutput( bp, hostOutputChannels, srcBytePtr, srcSampleStrideSamples,
+                    	        srcChannelStrideBytes, frameCount );
 					}
                 }
              
@@ -1022,19 +1170,8 @@ static unsigned long AdaptingInputOnlyProcess( PaUtilBufferProcessor *bp,
             userInput = bp->tempInputBufferPtrs;
         }
 
-        for( i=0; i<bp->inputChannelCount; ++i )
-        {
-            bp->inputConverter( destBytePtr, destSampleStrideSamples,
-                                    hostInputChannels[i].data,
-                                    hostInputChannels[i].stride,
-                                    frameCount, &bp->ditherGenerator );
-
-            destBytePtr += destChannelStrideBytes;  /* skip to next destination channel */
-
-            /* advance src ptr for next iteration */
-            hostInputChannels[i].data = ((unsigned char*)hostInputChannels[i].data) +
-                    frameCount * hostInputChannels[i].stride * bp->bytesPerHostInputSample;
-        }
+        ConvertHostInput( bp, hostInputChannels, destBytePtr, destSampleStrideSamples,
+                destChannelStrideBytes, frameCount );
 
         bp->framesInTempInputBuffer += frameCount;
 
@@ -1155,19 +1292,8 @@ static unsigned long AdaptingOutputOnlyProcess( PaUtilBufferProcessor *bp,
                 srcChannelStrideBytes = bp->framesPerUserBuffer * bp->bytesPerUserOutputSample;
             }
 
-            for( i=0; i<bp->outputChannelCount; ++i )
-            {
-                bp->outputConverter(    hostOutputChannels[i].data,
-                                        hostOutputChannels[i].stride,
-                                        srcBytePtr, srcSampleStrideSamples,
-                                        frameCount, &bp->ditherGenerator );
-
-                srcBytePtr += srcChannelStrideBytes;  /* skip to next source channel */
-
-                /* advance dest ptr for next iteration */
-                hostOutputChannels[i].data = ((unsigned char*)hostOutputChannels[i].data) +
-                        frameCount * hostOutputChannels[i].stride * bp->bytesPerHostOutputSample;
-            }
+            ConvertHostOutput( bp, hostOutputChannels, srcBytePtr, srcSampleStrideSamples,
+                    srcChannelStrideBytes, frameCount );
 
             bp->framesInTempOutputBuffer -= frameCount;
         }
@@ -1213,7 +1339,6 @@ static void CopyTempOutputBuffersToHostOutputBuffers( PaUtilBufferProcessor *bp)
     unsigned char *srcBytePtr;
     unsigned int srcSampleStrideSamples; /* stride from one sample to the next within a channel, in samples */
     unsigned int srcChannelStrideBytes; /* stride from one channel to the next, in bytes */
-    unsigned int i;
 
      /* copy frames from user to host output buffers */
      while( bp->framesInTempOutputBuffer > 0 &&
@@ -1252,20 +1377,8 @@ static void CopyTempOutputBuffersToHostOutputBuffers( PaUtilBufferProcessor *bp)
              srcChannelStrideBytes = bp->framesPerUserBuffer * bp->bytesPerUserOutputSample;
          }
 
-         for( i=0; i<bp->outputChannelCount; ++i )
-         {
-             assert( hostOutputChannels[i].data != NULL );
-             bp->outputConverter(    hostOutputChannels[i].data,
-                                     hostOutputChannels[i].stride,
-                                     srcBytePtr, srcSampleStrideSamples,
-                                     frameCount, &bp->ditherGenerator );
-
-             srcBytePtr += srcChannelStrideBytes;  /* skip to next source channel */
-
-             /* advance dest ptr for next iteration */
-             hostOutputChannels[i].data = ((unsigned char*)hostOutputChannels[i].data) +
-                     frameCount * hostOutputChannels[i].stride * bp->bytesPerHostOutputSample;
-         }
+         ConvertHostOutput( bp, hostOutputChannels, srcBytePtr, srcSampleStrideSamples,
+                 srcChannelStrideBytes, frameCount );
 
          if( bp->hostOutputFrameCount[0] > 0 )
              bp->hostOutputFrameCount[0] -= frameCount;
@@ -1380,19 +1493,8 @@ static unsigned long AdaptingProcess( PaUtilBufferProcessor *bp,
                 destChannelStrideBytes = bp->framesPerUserBuffer * bp->bytesPerUserInputSample;
             }
 
-            for( i=0; i<bp->inputChannelCount; ++i )
-            {
-                bp->inputConverter( destBytePtr, destSampleStrideSamples,
-                                        hostInputChannels[i].data,
-                                        hostInputChannels[i].stride,
-                                        frameCount, &bp->ditherGenerator );
-
-                destBytePtr += destChannelStrideBytes;  /* skip to next destination channel */
-
-                /* advance src ptr for next iteration */
-                hostInputChannels[i].data = ((unsigned char*)hostInputChannels[i].data) +
-                        frameCount * hostInputChannels[i].stride * bp->bytesPerHostInputSample;
-            }
+            ConvertHostInput( bp, hostInputChannels, destBytePtr, destSampleStrideSamples,
+                    destChannelStrideBytes, frameCount );
 
             if( bp->hostInputFrameCount[0] > 0 )
                 bp->hostInputFrameCount[0] -= frameCount;
@@ -1481,10 +1583,99 @@ static unsigned long AdaptingProcess( PaUtilBufferProcessor *bp,
 }
 
 
+/*
+    SkipHostFrames() passes over up to frameCount frames at the start of the
+    host buffers of one direction, zeroing them if zeroer is non-zero, and
+    advances the host channel pointers and frame counts. A second buffer which
+    is left over is moved into the place of the first, so that processing
+    can proceed as usual. Returns the number of frames passed over.
+*/
+static unsigned long SkipHostFrames( PaUtilChannelDescriptor **hostChannels,
+        unsigned long *hostFrameCount, unsigned int channelCount,
+        unsigned int bytesPerSample, PaUtilZeroer *zeroer, unsigned long frameCount )
+{
+    unsigned long framesSkipped = 0;
+    unsigned long framesToSkip;
+    unsigned int i, j;
+
+    for( j=0; j<2 && framesSkipped < frameCount; ++j )
+    {
+        framesToSkip = PA_MIN_( frameCount - framesSkipped, hostFrameCount[j] );
+
+        for( i=0; i<channelCount; ++i )
+        {
+            if( zeroer )
+                zeroer( hostChannels[j][i].data, hostChannels[j][i].stride, framesToSkip );
+
+            hostChannels[j][i].data = ((unsigned char*)hostChannels[j][i].data) +
+                    framesToSkip * hostChannels[j][i].stride * bytesPerSample;
+        }
+
+        hostFrameCount[j] -= framesToSkip;
+        framesSkipped += framesToSkip;
+    }
+
+    if( hostFrameCount[0] == 0 && hostFrameCount[1] != 0 )
+    {
+        memcpy( hostChannels[0], hostChannels[1], sizeof(PaUtilChannelDescriptor) * channelCount );
+        hostFrameCount[0] = hostFrameCount[1];
+        hostFrameCount[1] = 0;
+    }
+
+    return framesSkipped;
+}
+
+
+/*
+    SkipStartDelay() outputs silence and discards input until the start
+    scheduled with PaUtil_SetBufferProcessorStartTime, and moves the time info
+    on accordingly. Returns the number of frames passed over.
+*/
+static unsigned long SkipStartDelay( PaUtilBufferProcessor *bp )
+{
+    unsigned long inputFramesSkipped = 0, outputFramesSkipped = 0;
+    unsigned long framesSkipped;
+
+    /* Only the frame counts are advanced when no buffers were supplied (see
+        PaUtil_SetNoInput and PaUtil_SetNoOutput) */
+    if( bp->inputChannelCount != 0 )
+    {
+        inputFramesSkipped = SkipHostFrames( bp->hostInputChannels, bp->hostInputFrameCount,
+                bp->hostInputChannels[0][0].data ? bp->inputChannelCount : 0,
+                bp->bytesPerHostInputSample, 0, bp->startDelayFrames );
+    }
+
+    if( bp->outputChannelCount != 0 )
+    {
+        outputFramesSkipped = SkipHostFrames( bp->hostOutputChannels, bp->hostOutputFrameCount,
+                bp->hostOutputChannels[0][0].data ? bp->outputChannelCount : 0,
+                bp->bytesPerHostOutputSample, bp->outputZeroer, bp->startDelayFrames );
+    }
+
+    framesSkipped = PA_MAX_( inputFramesSkipped, outputFramesSkipped );
+    bp->startDelayFrames -= framesSkipped;
+
+    bp->timeInfo->inputBufferAdcTime += framesSkipped * bp->samplePeriod;
+    bp->timeInfo->outputBufferDacTime += framesSkipped * bp->samplePeriod;
+
+    return framesSkipped;
+}
+
+
 unsigned long PaUtil_EndBufferProcessing( PaUtilBufferProcessor* bp, int *streamCallbackResult )
 {
     unsigned long framesToProcess, framesToGo;
-    unsigned long framesProcessed = 0;
+    unsigned long framesProcessed = 0, framesSkipped = 0;
+    
+    if( bp->startDelayFrames > 0 )
+    {
+        framesSkipped = SkipStartDelay( bp );
+
+        /* Nothing left for the callback yet */
+        if( (bp->inputChannelCount == 0 || bp->hostInputFrameCount[0] == 0)
+                && (bp->outputChannelCount == 0 || bp->hostOutputFrameCount[0] == 0) )
+            return framesSkipped;
+    }
     
     if( bp->inputChannelCount != 0 && bp->outputChannelCount != 0
             && bp->hostInputChannels[0][0].data /* input was supplied (see PaUtil_SetNoInput) */
@@ -1649,7 +1840,7 @@ unsigned long PaUtil_EndBufferProcessing( PaUtilBufferProcessor* bp, int *stream
         }
     }
 
-    return framesProcessed;
+    return framesProcessed + framesSkipped;
 }
 
 
@@ -1680,19 +1871,8 @@ unsigned long PaUtil_CopyInput( PaUtilBufferProcessor* bp,
         destSampleStrideSamples = bp->inputChannelCount;
         destChannelStrideBytes = bp->bytesPerUserInputSample;
 
-        for( i=0; i<bp->inputChannelCount; ++i )
-        {
-            bp->inputConverter( destBytePtr, destSampleStrideSamples,
-                                hostInputChannels[i].data,
-                                hostInputChannels[i].stride,
-                                framesToCopy, &bp->ditherGenerator );
-
-            destBytePtr += destChannelStrideBytes;  /* skip to next dest channel */
-
-            /* advance source ptr for next iteration */
-            hostInputChannels[i].data = ((unsigned char*)hostInputChannels[i].data) +
-                    framesToCopy * hostInputChannels[i].stride * bp->bytesPerHostInputSample;
-        }
+        ConvertHostInput( bp, hostInputChannels, destBytePtr, destSampleStrideSamples,
+                destChannelStrideBytes, framesToCopy );
 
         /* advance callers dest pointer (buffer) */
         *buffer = ((unsigned char *)*buffer) +
@@ -1751,19 +1931,8 @@ unsigned long PaUtil_CopyOutput( PaUtilBufferProcessor* bp,
         srcSampleStrideSamples = bp->outputChannelCount;
         srcChannelStrideBytes = bp->bytesPerUserOutputSample;
 
-        for( i=0; i<bp->outputChannelCount; ++i )
-        {
-            bp->outputConverter(    hostOutputChannels[i].data,
-                                    hostOutputChannels[i].stride,
-                                    srcBytePtr, srcSampleStrideSamples,
-                                    framesToCopy, &bp->ditherGenerator );
-
-            srcBytePtr += srcChannelStrideBytes;  /* skip to next source channel */
-
-            /* advance dest ptr for next iteration */
-            hostOutputChannels[i].data = ((unsigned char*)hostOutputChannels[i].data) +
-                    framesToCopy * hostOutputChannels[i].stride * bp->bytesPerHostOutputSample;
-        }
+        ConvertHostOutput( bp, hostOutputChannels, srcBytePtr, srcSampleStrideSamples,
+                srcChannelStrideBytes, framesToCopy );
 
         /* advance callers source pointer (buffer) */
         *buffer = ((unsigned char *)*buffer) +
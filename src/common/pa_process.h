@@ -296,6 +296,8 @@ typedef struct {
                                                         hostInputChannels[i].data is NULL when the caller
                                                         calls PaUtil_SetNoInput()
                                                         */
+    int hostInputChannelsPacked[2]; /**< all channels are interleaved in order in a single buffer, so a block of
+                                         frames is one run of samples */
     int hostOutputIsInterleaved;
     unsigned long hostOutputFrameCount[2];
     PaUtilChannelDescriptor *hostOutputChannels[2]; /**< pointers to arrays of channel descriptors.
@@ -303,11 +305,15 @@ typedef struct {
                                                          hostOutputChannels[i].data is NULL when the caller
                                                          calls PaUtil_SetNoOutput()
                                                          */
+    int hostOutputChannelsPacked[2]; /**< see hostInputChannelsPacked */
 
     PaUtilTriangularDitherGenerator ditherGenerator;
 
     double samplePeriod;
 
+    PaTime startTime;               /**< time at which the first callback frame should pass the DAC/ADC, 0 for none */
+    unsigned long startDelayFrames; /**< host frames still to be skipped before the first callback frame */
+
     PaStreamCallback *streamCallback;
     void *userData;
 } PaUtilBufferProcessor;
@@ -406,6 +412,25 @@ void PaUtil_TerminateBufferProcessor( PaUtilBufferProcessor* bufferProcessor );
 void PaUtil_ResetBufferProcessor( PaUtilBufferProcessor* bufferProcessor );
 
 
+/** Delay the first stream callback until a given time, with sample accuracy.
+ Call this after PaUtil_ResetBufferProcessor in your StartStream call.
+
+ The delay is worked out from the timeInfo passed to the first
+ PaUtil_BeginBufferProcessing call: outputBufferDacTime, or inputBufferAdcTime
+ for input-only streams. Until startTime the buffer processor fills host output
+ buffers with silence and discards host input, and the stream callback is first
+ called for the frame which passes the DAC (or ADC) at startTime. A startTime
+ which has already passed when the first host buffer is processed starts the
+ callbacks at once.
+
+ @param bufferProcessor The buffer processor.
+
+ @param startTime The time in the time base of the host's timeInfo, or 0 to
+ start at once.
+*/
+void PaUtil_SetBufferProcessorStartTime( PaUtilBufferProcessor* bufferProcessor, PaTime startTime );
+
+
 /** Retrieve the input latency of a buffer processor, in frames.
 
  @param bufferProcessor The buffer processor examine.
@@ -489,6 +514,25 @@ void PaUtil_SetInterleavedInputChannels( PaUtilBufferProcessor* bufferProcessor,
         unsigned int firstChannel, void *data, unsigned int channelCount );
 
 
+/** Provide the buffer processor with pointers to a number of host input
+ channels that lie at a fixed distance from each other. This replaces a
+ PaUtil_SetInputChannel call per channel, which matters for devices with many
+ channels.
+
+ @param bufferProcessor The buffer processor.
+ @param firstChannel The first channel number.
+ @param data The buffer of the first channel.
+ @param channelCount The number of channels.
+ @param channelSpacing The distance from one channel to the next, in bytes.
+ For an interleaved host buffer this is the size of a host sample, for
+ non-interleaved channels in one block the size of a channel.
+ @param stride The stride from one sample to the next, in samples.
+*/
+void PaUtil_SetInputChannels( PaUtilBufferProcessor* bufferProcessor,
+        unsigned int firstChannel, void *data, unsigned int channelCount,
+        unsigned int channelSpacing, unsigned int stride );
+
+
 /** Provide the buffer processor with a pointer to one non-interleaved host
  output channel.
 
@@ -574,6 +618,16 @@ void PaUtil_SetOutputChannel( PaUtilBufferProcessor* bufferProcessor,
 void PaUtil_SetInterleavedOutputChannels( PaUtilBufferProcessor* bufferProcessor,
         unsigned int firstChannel, void *data, unsigned int channelCount );
 
+
+/** Provide the buffer processor with pointers to a number of host output
+ channels that lie at a fixed distance from each other.
+
+ @see PaUtil_SetInputChannels
+*/
+void PaUtil_SetOutputChannels( PaUtilBufferProcessor* bufferProcessor,
+        unsigned int firstChannel, void *data, unsigned int channelCount,
+        unsigned int channelSpacing, unsigned int stride );
+
         
 /** Provide the buffer processor with a pointer to one non-interleaved host
  output channel.
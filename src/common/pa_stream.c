@@ -46,6 +46,7 @@
 
 
 #include "pa_stream.h"
+#include "pa_util.h"
 
 
 void PaUtil_InitializeStreamInterface( PaUtilStreamInterface *streamInterface,
@@ -74,6 +75,15 @@ void PaUtil_InitializeStreamInterface( PaUtilStreamInterface *streamInterface,
     streamInterface->Write = Write;
     streamInterface->GetReadAvailable = GetReadAvailable;
     streamInterface->GetWriteAvailable = GetWriteAvailable;
+    streamInterface->GetWriteBuffer = PaUtil_DefaultGetWriteBuffer;
+    streamInterface->CommitWriteBuffer = PaUtil_DefaultCommitWriteBuffer;
+    streamInterface->ReadTimeout = PaUtil_DefaultReadTimeout;
+    streamInterface->WriteTimeout = PaUtil_DefaultWriteTimeout;
+    streamInterface->GetPollDescriptor = PaUtil_DefaultGetPollDescriptor;
+    streamInterface->StartAt = PaUtil_DefaultStartStreamAt;
+    streamInterface->StartGroup = PaUtil_DefaultStartStreams;
+    streamInterface->StopGroup = PaUtil_DefaultStopStreams;
+    streamInterface->Prepare = PaUtil_DefaultPrepareStream;
 }
 
 
@@ -93,11 +103,20 @@ void PaUtil_InitializeStreamRepresentation( PaUtilStreamRepresentation *streamRe
     streamRepresentation->streamInfo.inputLatency = 0.;
     streamRepresentation->streamInfo.outputLatency = 0.;
     streamRepresentation->streamInfo.sampleRate = 0.;
+
+    streamRepresentation->outputChannelCount = 0;
+    streamRepresentation->outputSampleFormat = 0;
+    streamRepresentation->writeBufferFrames = 0;
+    streamRepresentation->stagingBuffer = 0;
+    streamRepresentation->stagingBufferFrames = 0;
 }
 
 
 void PaUtil_TerminateStreamRepresentation( PaUtilStreamRepresentation *streamRepresentation )
 {
+    if( streamRepresentation->stagingBuffer )
+        PaUtil_FreeMemory( streamRepresentation->stagingBuffer );
+    streamRepresentation->stagingBuffer = 0;
     streamRepresentation->magic = 0;
 }
 
@@ -142,6 +161,227 @@ signed long PaUtil_DummyGetWriteAvailable( PaStream* stream )
 }
 
 
+PaError PaUtil_DefaultGetWriteBuffer( PaStream* stream,
+                               void **buffer,
+                               unsigned long *frames )
+{
+    PaUtilStreamRepresentation *rep = PA_STREAM_REP( stream );
+    int channelCount = rep->outputChannelCount;
+    PaError sampleSize;
+    unsigned long i;
+    void **channels;
+
+    if( rep->streamCallback )
+        return paCanNotWriteToACallbackStream;
+    if( channelCount == 0 )
+        return paCanNotWriteToAnInputOnlyStream;
+
+    sampleSize = Pa_GetSampleSize( rep->outputSampleFormat );
+    if( sampleSize < 0 )
+        return sampleSize;
+
+    if( *frames > rep->stagingBufferFrames )
+    {
+        /* Non-interleaved buffers are preceded by the array of channel pointers handed out */
+        void *staging = PaUtil_AllocateMemory( sizeof (void*) * channelCount + *frames * sampleSize * channelCount );
+        if( !staging )
+            return paInsufficientMemory;
+
+        if( rep->stagingBuffer )
+            PaUtil_FreeMemory( rep->stagingBuffer );
+        rep->stagingBuffer = staging;
+        rep->stagingBufferFrames = *frames;
+    }
+
+    channels = (void**)rep->stagingBuffer;
+    if( rep->outputSampleFormat & paNonInterleaved )
+    {
+        for( i = 0; i < (unsigned long)channelCount; ++i )
+            channels[i] = (unsigned char*)(channels + channelCount) + i * rep->stagingBufferFrames * sampleSize;
+        *buffer = channels;
+    }
+    else
+    {
+        *buffer = channels + channelCount;
+    }
+
+    return paNoError;
+}
+
+
+PaError PaUtil_DefaultCommitWriteBuffer( PaStream* stream,
+                               unsigned long frames )
+{
+    PaUtilStreamRepresentation *rep = PA_STREAM_REP( stream );
+    void **channels = (void**)rep->stagingBuffer;
+
+    if( frames == 0 )
+        return paNoError;
+
+    if( rep->outputSampleFormat & paNonInterleaved )
+        return rep->streamInterface->Write( stream, channels, frames );
+    else
+        return rep->streamInterface->Write( stream, channels + rep->outputChannelCount, frames );
+}
+
+
+PaError PaUtil_DefaultReadTimeout( PaStream* stream,
+                               void *buffer,
+                               unsigned long *frames,
+                               PaTime timeout )
+{
+    PaUtilStreamInterface *streamInterface = PA_STREAM_INTERFACE( stream );
+    PaTime deadline = PaUtil_GetTime() + timeout;
+    signed long available;
+
+    /* Without a way to wait on the host, poll until the frames are there. Reading no more than is available
+       won't block */
+    while( (available = streamInterface->GetReadAvailable( stream )) >= 0
+            && (unsigned long)available < *frames && PaUtil_GetTime() < deadline )
+        Pa_Sleep( 1 );
+
+    if( available < 0 )
+        return available;
+    if( (unsigned long)available < *frames )
+        *frames = available;
+    if( *frames == 0 )
+        return paNoError;
+
+    return streamInterface->Read( stream, buffer, *frames );
+}
+
+
+PaError PaUtil_DefaultWriteTimeout( PaStream* stream,
+                               const void *buffer,
+                               unsigned long *frames,
+                               PaTime timeout )
+{
+    PaUtilStreamInterface *streamInterface = PA_STREAM_INTERFACE( stream );
+    PaTime deadline = PaUtil_GetTime() + timeout;
+    signed long available;
+
+    while( (available = streamInterface->GetWriteAvailable( stream )) >= 0
+            && (unsigned long)available < *frames && PaUtil_GetTime() < deadline )
+        Pa_Sleep( 1 );
+
+    if( available < 0 )
+        return available;
+    if( (unsigned long)available < *frames )
+        *frames = available;
+    if( *frames == 0 )
+        return paNoError;
+
+    return streamInterface->Write( stream, buffer, *frames );
+}
+
+
+PaError PaUtil_DefaultGetPollDescriptor( PaStream* stream, int *fd )
+{
+    (void)stream; /* unused parameter */
+    (void)fd; /* unused parameter */
+
+    return paIncompatibleStreamHostApi;
+}
+
+
+PaError PaUtil_DefaultStartStreamAt( PaStream* stream, PaTime when )
+{
+    PaUtilStreamInterface *streamInterface = PA_STREAM_INTERFACE( stream );
+    PaTime remaining;
+
+    while( (remaining = when - streamInterface->GetTime( stream )) > 0. )
+        Pa_Sleep( remaining > 1. ? 1000 : (long)(remaining * 1000.) + 1 );
+
+    return streamInterface->Start( stream );
+}
+
+
+/* Time allowed for starting each stream of a group, on top of the latency of the streams */
+#define PA_GROUP_START_MARGIN_  (.01)
+
+PaError PaUtil_DefaultStartStreams( PaStream **streams, int count )
+{
+    PaError result = paNoError;
+    PaTime when, latency = 0.;
+    int i, numScheduled = 0, pass;
+
+    /* Only streams with a StartAt of their own are started at the common time, waiting for it in
+       PaUtil_DefaultStartStreamAt would just delay the rest of the group */
+    for( i = 0; i < count; ++i )
+    {
+        const PaStreamInfo *streamInfo = &PA_STREAM_REP( streams[i] )->streamInfo;
+
+        if( PA_STREAM_INTERFACE( streams[i] )->StartAt == PaUtil_DefaultStartStreamAt )
+            continue;
+
+        ++numScheduled;
+        if( streamInfo->inputLatency > latency )
+            latency = streamInfo->inputLatency;
+        if( streamInfo->outputLatency > latency )
+            latency = streamInfo->outputLatency;
+    }
+    when = PaUtil_GetTime() + latency + numScheduled * PA_GROUP_START_MARGIN_;
+
+    /* The scheduled streams first, then the others back to back */
+    for( pass = 0; pass < 2 && result == paNoError; ++pass )
+    {
+        for( i = 0; i < count; ++i )
+        {
+            PaUtilStreamInterface *streamInterface = PA_STREAM_INTERFACE( streams[i] );
+            int scheduled = streamInterface->StartAt != PaUtil_DefaultStartStreamAt;
+
+            if( scheduled != (pass == 0) )
+                continue;
+
+            if( scheduled )
+            {
+                PaTime offset = streamInterface->GetTime( streams[i] ) - PaUtil_GetTime();
+                result = streamInterface->StartAt( streams[i], when + offset );
+            }
+            else
+            {
+                result = streamInterface->Start( streams[i] );
+            }
+            if( result != paNoError )
+                break;
+        }
+    }
+
+    /* The streams were all stopped to begin with */
+    for( i = 0; result != paNoError && i < count; ++i )
+    {
+        if( PA_STREAM_INTERFACE( streams[i] )->IsStopped( streams[i] ) == 0 )
+            PA_STREAM_INTERFACE( streams[i] )->Abort( streams[i] );
+    }
+
+    return result;
+}
+
+
+PaError PaUtil_DefaultStopStreams( PaStream **streams, int count )
+{
+    PaError result = paNoError, error;
+    int i;
+
+    for( i = 0; i < count; ++i )
+    {
+        error = PA_STREAM_INTERFACE( streams[i] )->Stop( streams[i] );
+        if( result == paNoError )
+            result = error;
+    }
+
+    return result;
+}
+
+
+PaError PaUtil_DefaultPrepareStream( PaStream *stream )
+{
+    (void)stream; /* unused parameter */
+
+    return paNoError;
+}
+
+
 double PaUtil_DummyGetCpuLoad( PaStream* stream )
 {
     (void)stream; /* unused parameter */
@@ -77,10 +77,28 @@ typedef struct {
     PaError (*Write)( PaStream* stream, const void *buffer, unsigned long frames );
     signed long (*GetReadAvailable)( PaStream* stream );
     signed long (*GetWriteAvailable)( PaStream* stream );
+    PaError (*GetWriteBuffer)( PaStream* stream, void **buffer, unsigned long *frames );
+    PaError (*CommitWriteBuffer)( PaStream* stream, unsigned long frames );
+    PaError (*ReadTimeout)( PaStream* stream, void *buffer, unsigned long *frames, PaTime timeout );
+    PaError (*WriteTimeout)( PaStream* stream, const void *buffer, unsigned long *frames, PaTime timeout );
+    PaError (*GetPollDescriptor)( PaStream* stream, int *fd );
+    PaError (*StartAt)( PaStream *stream, PaTime when );
+    PaError (*StartGroup)( PaStream **streams, int count );
+    PaError (*StopGroup)( PaStream **streams, int count );
+    PaError (*Prepare)( PaStream *stream );
 } PaUtilStreamInterface;
 
 
 /** Initialize the fields of a PaUtilStreamInterface structure.
+
+ GetWriteBuffer and CommitWriteBuffer are set to PaUtil_DefaultGetWriteBuffer and
+ PaUtil_DefaultCommitWriteBuffer, implementations which can hand out their own
+ buffers may assign theirs afterwards. Likewise ReadTimeout, WriteTimeout,
+ GetPollDescriptor, StartAt, StartGroup, StopGroup and Prepare are set to the
+ PaUtil_Default* functions below.
+
+ StartGroup and StopGroup are passed streams which all share the same StartGroup
+ or StopGroup function respectively, so a host API can assume they are its own.
 */
 void PaUtil_InitializeStreamInterface( PaUtilStreamInterface *streamInterface,
     PaError (*Close)( PaStream* ),
@@ -134,6 +152,85 @@ signed long PaUtil_DummyGetWriteAvailable( PaStream* stream );
 
 
 
+/** Default GetWriteBuffer function, hands out a staging buffer in the user's
+ sample format which is passed to the stream's Write function when committed.
+ It doesn't wait, the buffer has room for all frames asked for and the wait is
+ left to Write.
+ @return paCanNotWriteToACallbackStream for callback streams and
+ paCanNotWriteToAnInputOnlyStream for input only streams.
+*/
+PaError PaUtil_DefaultGetWriteBuffer( PaStream* stream,
+                       void **buffer,
+                       unsigned long *frames );
+
+
+/** Default CommitWriteBuffer function, writes the first frames of the staging
+ buffer handed out by PaUtil_DefaultGetWriteBuffer.
+*/
+PaError PaUtil_DefaultCommitWriteBuffer( PaStream* stream,
+                       unsigned long frames );
+
+
+/** Default ReadTimeout function, polls GetReadAvailable until the frames are
+ available or the timeout expires, then reads what is available with Read.
+*/
+PaError PaUtil_DefaultReadTimeout( PaStream* stream,
+                       void *buffer,
+                       unsigned long *frames,
+                       PaTime timeout );
+
+
+/** Default WriteTimeout function, polls GetWriteAvailable until there is room
+ for the frames or the timeout expires, then writes what fits with Write.
+*/
+PaError PaUtil_DefaultWriteTimeout( PaStream* stream,
+                       const void *buffer,
+                       unsigned long *frames,
+                       PaTime timeout );
+
+
+/** Default GetPollDescriptor function.
+ @return paIncompatibleStreamHostApi, the host API provides no descriptor.
+*/
+PaError PaUtil_DefaultGetPollDescriptor( PaStream* stream, int *fd );
+
+
+/** Default StartAt function, sleeps until when according to the stream's
+ GetTime function and then calls Start. The start is only as accurate as
+ Pa_Sleep and the host API's start up time allow.
+*/
+PaError PaUtil_DefaultStartStreamAt( PaStream* stream, PaTime when );
+
+
+/** Default StartGroup function, starts the streams whose host API has a
+ StartAt function of its own at a common time. The time is far enough ahead
+ for all of these streams to be started and their latency to pass, and is
+ translated from PaUtil_GetTime() into the time base of each stream.
+
+ Streams left with PaUtil_DefaultStartStreamAt are then started back to back
+ with their Start functions. There is no bound on their skew, against each
+ other or against the scheduled streams.
+
+ This is also the StartGroup function for streams of different host APIs.
+ Should a stream fail to start, the streams already started are aborted.
+*/
+PaError PaUtil_DefaultStartStreams( PaStream **streams, int count );
+
+
+/** Default StopGroup function, stops the streams one after another with their
+ Stop functions.
+ @return The first error encountered, all streams are stopped regardless.
+*/
+PaError PaUtil_DefaultStopStreams( PaStream **streams, int count );
+
+
+/** Default Prepare function, for host APIs which have nothing to do ahead of
+ Start.
+ @return paNoError.
+*/
+PaError PaUtil_DefaultPrepareStream( PaStream *stream );
+
+
 /** Dummy GetCpuLoad function for use in an interface to a read/write stream.
  Pass to the GetCpuLoad parameter of PaUtil_InitializeStreamInterface.
  @return Returns 0.
@@ -152,6 +249,11 @@ typedef struct PaUtilStreamRepresentation {
     PaStreamFinishedCallback *streamFinishedCallback;
     void *userData;
     PaStreamInfo streamInfo;
+    int outputChannelCount; /**< as passed to Pa_OpenStream, set by pa_front */
+    PaSampleFormat outputSampleFormat; /**< as passed to Pa_OpenStream, set by pa_front */
+    unsigned long writeBufferFrames; /**< frames handed out by Pa_GetStreamWriteBuffer, not yet committed */
+    void *stagingBuffer; /**< used by PaUtil_DefaultGetWriteBuffer */
+    unsigned long stagingBufferFrames;
 } PaUtilStreamRepresentation;
 
 
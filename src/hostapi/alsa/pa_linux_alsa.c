@@ -57,10 +57,16 @@
 #include <string.h> /* strlen() */
 #include <limits.h>
 #include <math.h>
+#include <stdarg.h>
 #include <pthread.h>
+#include <semaphore.h>
 #include <signal.h>
 #include <time.h>
 #include <sys/mman.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <signal.h> /* For sig_atomic_t */
 #ifdef PA_ALSA_DYNAMIC
     #include <dlfcn.h> /* For dlXXX functions */
@@ -87,6 +93,11 @@
 /* Combine version elements into a single (unsigned) integer */
 #define ALSA_VERSION_INT(major, minor, subminor)  ((major << 16) | (minor << 8) | subminor)
 
+/* Selecting the clock used for PCM timestamps is possible from ALSA 1.0.29 on */
+#if SND_LIB_VERSION >= ALSA_VERSION_INT(1, 0, 29)
+    #define PA_ALSA_HAVE_TSTAMP_TYPE
+#endif
+
 /* The acceptable tolerance of sample rate set, to that requested (as a ratio, eg 50 is 2%, 100 is 1%) */
 #define RATE_MAX_DEVIATE_RATIO 100
 
@@ -106,6 +117,7 @@ _PA_DEFINE_FUNC(snd_pcm_resume);
 _PA_DEFINE_FUNC(snd_pcm_wait);
 _PA_DEFINE_FUNC(snd_pcm_state);
 _PA_DEFINE_FUNC(snd_pcm_avail_update);
+_PA_DEFINE_FUNC(snd_pcm_forward);
 _PA_DEFINE_FUNC(snd_pcm_areas_silence);
 _PA_DEFINE_FUNC(snd_pcm_mmap_begin);
 _PA_DEFINE_FUNC(snd_pcm_mmap_commit);
@@ -122,7 +134,9 @@ _PA_DEFINE_FUNC(snd_pcm_poll_descriptors_count);
 _PA_DEFINE_FUNC(snd_pcm_poll_descriptors_revents);
 _PA_DEFINE_FUNC(snd_pcm_format_size);
 _PA_DEFINE_FUNC(snd_pcm_link);
+_PA_DEFINE_FUNC(snd_pcm_unlink);
 _PA_DEFINE_FUNC(snd_pcm_delay);
+_PA_DEFINE_FUNC(snd_pcm_htimestamp);
 
 _PA_DEFINE_FUNC(snd_pcm_hw_params_sizeof);
 _PA_DEFINE_FUNC(snd_pcm_hw_params_malloc);
@@ -182,6 +196,9 @@ _PA_DEFINE_FUNC(snd_pcm_sw_params_set_silence_threshold);
 _PA_DEFINE_FUNC(snd_pcm_sw_params_set_silence_size);
 _PA_DEFINE_FUNC(snd_pcm_sw_params_set_xfer_align);
 _PA_DEFINE_FUNC(snd_pcm_sw_params_set_tstamp_mode);
+#ifdef PA_ALSA_HAVE_TSTAMP_TYPE
+_PA_DEFINE_FUNC(snd_pcm_sw_params_set_tstamp_type);
+#endif
 #define alsa_snd_pcm_sw_params_alloca(ptr) __alsa_snd_alloca(ptr, snd_pcm_sw_params)
 
 _PA_DEFINE_FUNC(snd_pcm_info);
@@ -204,6 +221,8 @@ _PA_DEFINE_FUNC(snd_ctl_card_info_free);
 _PA_DEFINE_FUNC(snd_ctl_card_info);
 _PA_DEFINE_FUNC(snd_ctl_card_info_sizeof);
 _PA_DEFINE_FUNC(snd_ctl_card_info_get_name);
+_PA_DEFINE_FUNC(snd_ctl_card_info_get_id);
+_PA_DEFINE_FUNC(snd_ctl_card_info_get_driver);
 #define alsa_snd_ctl_card_info_alloca(ptr) __alsa_snd_alloca(ptr, snd_ctl_card_info)
 
 _PA_DEFINE_FUNC(snd_config);
@@ -216,6 +235,12 @@ _PA_DEFINE_FUNC(snd_config_iterator_next);
 _PA_DEFINE_FUNC(snd_config_get_string);
 _PA_DEFINE_FUNC(snd_config_get_id);
 _PA_DEFINE_FUNC(snd_config_update_free_global);
+_PA_DEFINE_FUNC(snd_config_top);
+_PA_DEFINE_FUNC(snd_config_load);
+_PA_DEFINE_FUNC(snd_config_delete);
+_PA_DEFINE_FUNC(snd_input_buffer_open);
+_PA_DEFINE_FUNC(snd_input_close);
+_PA_DEFINE_FUNC(snd_pcm_open_lconf);
 
 _PA_DEFINE_FUNC(snd_pcm_status);
 _PA_DEFINE_FUNC(snd_pcm_status_sizeof);
@@ -387,6 +412,7 @@ static int PaAlsa_LoadLibrary()
     _PA_LOAD_FUNC(snd_pcm_wait);
     _PA_LOAD_FUNC(snd_pcm_state);
     _PA_LOAD_FUNC(snd_pcm_avail_update);
+    _PA_LOAD_FUNC(snd_pcm_forward);
     _PA_LOAD_FUNC(snd_pcm_areas_silence);
     _PA_LOAD_FUNC(snd_pcm_mmap_begin);
     _PA_LOAD_FUNC(snd_pcm_mmap_commit);
@@ -403,7 +429,9 @@ static int PaAlsa_LoadLibrary()
     _PA_LOAD_FUNC(snd_pcm_poll_descriptors_revents);
     _PA_LOAD_FUNC(snd_pcm_format_size);
     _PA_LOAD_FUNC(snd_pcm_link);
+    _PA_LOAD_FUNC(snd_pcm_unlink);
     _PA_LOAD_FUNC(snd_pcm_delay);
+    _PA_LOAD_FUNC(snd_pcm_htimestamp);
 
     _PA_LOAD_FUNC(snd_pcm_hw_params_sizeof);
     _PA_LOAD_FUNC(snd_pcm_hw_params_malloc);
@@ -462,6 +490,9 @@ static int PaAlsa_LoadLibrary()
     _PA_LOAD_FUNC(snd_pcm_sw_params_set_silence_size);
     _PA_LOAD_FUNC(snd_pcm_sw_params_set_xfer_align);
     _PA_LOAD_FUNC(snd_pcm_sw_params_set_tstamp_mode);
+#ifdef PA_ALSA_HAVE_TSTAMP_TYPE
+    _PA_LOAD_FUNC(snd_pcm_sw_params_set_tstamp_type);
+#endif
 
     _PA_LOAD_FUNC(snd_pcm_info);
     _PA_LOAD_FUNC(snd_pcm_info_sizeof);
@@ -482,6 +513,8 @@ static int PaAlsa_LoadLibrary()
     _PA_LOAD_FUNC(snd_ctl_card_info);
     _PA_LOAD_FUNC(snd_ctl_card_info_sizeof);
     _PA_LOAD_FUNC(snd_ctl_card_info_get_name);
+    _PA_LOAD_FUNC(snd_ctl_card_info_get_id);
+    _PA_LOAD_FUNC(snd_ctl_card_info_get_driver);
 
     _PA_LOAD_FUNC(snd_config);
     _PA_LOAD_FUNC(snd_config_update);
@@ -493,6 +526,12 @@ static int PaAlsa_LoadLibrary()
     _PA_LOAD_FUNC(snd_config_get_string);
     _PA_LOAD_FUNC(snd_config_get_id);
     _PA_LOAD_FUNC(snd_config_update_free_global);
+    _PA_LOAD_FUNC(snd_config_top);
+    _PA_LOAD_FUNC(snd_config_load);
+    _PA_LOAD_FUNC(snd_config_delete);
+    _PA_LOAD_FUNC(snd_input_buffer_open);
+    _PA_LOAD_FUNC(snd_input_close);
+    _PA_LOAD_FUNC(snd_pcm_open_lconf);
 
     _PA_LOAD_FUNC(snd_pcm_status);
     _PA_LOAD_FUNC(snd_pcm_status_sizeof);
@@ -587,6 +626,10 @@ static void PaAlsa_CloseLibrary()
 static int numPeriods_ = 4;
 static int busyRetries_ = 100;
 
+/* Aggregate device, combining the channels of several hw devices (see PA_ALSA_AGGREGATE) */
+#define PA_ALSA_AGGREGATE_NAME_ "pa_aggregate"
+#define PA_ALSA_MAX_AGGREGATE_MEMBERS_ 16
+
 int PaAlsa_SetNumPeriods( int numPeriods )
 {
     numPeriods_ = numPeriods;
@@ -599,12 +642,29 @@ typedef enum
     StreamDirection_Out
 } StreamDirection;
 
+/* Delay-locked loop mapping hardware frame positions to time
+ *
+ * The hardware timestamps delivered by ALSA are precise, but are taken at interrupt time and jitter with the
+ * scheduling of the interrupt handler. The loop filters these into a smooth estimate of the time at which a
+ * given frame position is reached by the hardware, the slope of which tracks the actual sample rate.
+ */
+typedef struct
+{
+    int valid;
+    long long position;         /* Frame position of the last update */
+    PaTime time;                /* Filtered time at position */
+    double secondsPerFrame;     /* Filtered duration of a frame */
+    double nominalSecondsPerFrame;
+}
+PaAlsaTimeDll;
+
 typedef struct
 {
     PaSampleFormat hostSampleFormat;
     int numUserChannels, numHostChannels;
     int userInterleaved, hostInterleaved;
     int canMmap;
+    int zeroCopy;   /* Callback operates directly on the mmap areas, formats, channels and interleaving match */
     void *nonMmapBuffer;
     unsigned int nonMmapBufferSize;
     PaDeviceIndex device;     /* Keep the device index */
@@ -616,11 +676,19 @@ typedef struct
     snd_pcm_format_t nativeFormat;
     unsigned int nfds;
     int ready;  /* Marked ready from poll */
+    int availFresh; /* Available frames were queried since the last wait, no need to ask again before mmap_begin */
+    int epollArmed; /* The descriptors are enabled in the stream's epoll set */
     void **userBuffers;
     snd_pcm_uframes_t offset;
     StreamDirection streamDir;
 
     snd_pcm_channel_area_t *channelAreas;  /* Needed for channel adaption */
+    int areasUniform;               /* Non-interleaved mmap channels lie areaSpacing bytes apart in one block */
+    unsigned int areaSpacing;
+
+    long long framesTransferred;    /* Frames committed by/to the application since the PCM was started */
+    int monotonicTstamps;           /* PCM timestamps are taken from CLOCK_MONOTONIC */
+    PaAlsaTimeDll timeDll;
 } PaAlsaStreamComponent;
 
 /* Implementation specific stream structure */
@@ -636,12 +704,20 @@ typedef struct PaAlsaStream
     int primeBuffers;
     int callbackMode;              /* bool: are we running in callback mode? */
     int pcmsSynced;                /* Have we successfully synced pcms */
+    int linkedWait;                /* Synced pcms share a period size, wait on capture alone */
+    int deferTrigger;              /* AlsaStart readies the pcms but leaves starting them to the caller */
+    int isPrepared;                /* PrepareStream has readied the pcms, a callback thread is parked on releaseSem */
+    sem_t releaseSem;              /* Posted to release the parked callback thread once the pcms are started */
+    int unparkToExit;              /* The parked callback thread is released to exit, the stream never ran */
     int rtSched;
 
     /* the callback thread uses these to poll the sound device(s), waiting
      * for data to be ready/available */
     struct pollfd* pfds;
     int pollTimeout;
+    int epollFd;                   /* Persistent epoll set of the PCM descriptors and wakeFd, -1 to use poll() */
+    int wakeFd;                    /* eventfd to wake the callback thread when the stream is stopped */
+    int readyFd;                   /* epoll set of the PCM descriptors handed out by GetStreamPollDescriptor, or -1 */
 
     /* Used in communication between threads */
     volatile sig_atomic_t callback_finished; /* bool: are we in the "callback finished" state? */
@@ -650,14 +726,38 @@ typedef struct PaAlsaStream
     PaUnixMutex stateMtx;                   /* Used to synchronize access to stream state */
 
     int neverDropInput;
+    int directWrite;               /* The buffer handed out by GetStreamWriteBuffer is the playback mmap area */
+    unsigned long captureSkipFrames;    /* Frames captured before the scheduled start, dropped unread */
 
     PaTime underrun;
     PaTime overrun;
+    PaAlsaStreamXrunStats xrunStats;        /* Protected by stateMtx */
 
     PaAlsaStreamComponent capture, playback;
 }
 PaAlsaStream;
 
+/* Device capabilities as stored in the persistent device cache */
+typedef struct
+{
+    char *key;
+    int minInputChannels, maxInputChannels;
+    int minOutputChannels, maxOutputChannels;
+    PaTime defaultLowInputLatency, defaultHighInputLatency;
+    PaTime defaultLowOutputLatency, defaultHighOutputLatency;
+    double defaultSampleRate;
+}
+PaAlsaCachedDevice;
+
+typedef struct
+{
+    const char *path;   /* Cache file, NULL if the persistent cache is not in use */
+    PaAlsaCachedDevice *entries;
+    size_t numEntries, maxEntries;
+    int dirty;          /* Entries were added since the cache file was read */
+}
+PaAlsaDeviceCache;
+
 /* PaAlsaHostApiRepresentation - host api datastructure specific to this implementation */
 
 typedef struct PaAlsaHostApiRepresentation
@@ -670,9 +770,44 @@ typedef struct PaAlsaHostApiRepresentation
 
     PaHostApiIndex hostApiIndex;
     PaUint32 alsaLibVersion; /* Retrieved from the library at run-time */
+
+    int probeMode;           /* Open mode used when probing devices (see PA_ALSA_INITIALIZE_BLOCK) */
+    int lazyProbe;           /* Defer probing device capabilities until first use (see PA_ALSA_LAZY_PROBE) */
+    PaAlsaDeviceCache deviceCache;
+    PaUnixMutex probeMtx;    /* Serializes access to the device cache from concurrent probes */
+    const char *aggregateMembers;   /* hw devices combined as the aggregate device (see PA_ALSA_AGGREGATE), or NULL */
 }
 PaAlsaHostApiRepresentation;
 
+/* Number of tested parameter combinations remembered per device and direction */
+#define PA_ALSA_NUM_VERIFIED_ 16
+
+/* The outcome of testing a combination of parameters on the device itself */
+typedef struct
+{
+    double sampleRate;
+    unsigned int numHostChannels;
+    PaSampleFormat sampleFormat;
+    PaError result;
+}
+PaAlsaVerifiedParameters;
+
+/* What a device supports in one direction, recorded the first time a format is tested so that IsFormatSupported
+ * needn't open the PCM again */
+typedef struct
+{
+    int valid;
+    PaSampleFormat formats;         /* As from GetAvailableFormats */
+    PaSampleFormat swappedFormats;  /* As from GetAvailableSwappedFormats */
+    unsigned int minChannels, maxChannels;
+    unsigned long rates;            /* Bit i is set if standardRates_[i] is supported */
+    ino_t cardNode;                 /* Identity of the card's control device node, recreated on hotplug */
+    time_t cardNodeTime;
+    PaAlsaVerifiedParameters verified[PA_ALSA_NUM_VERIFIED_];  /* The most recent tests, oldest replaced first */
+    unsigned int numVerified, nextVerified;
+}
+PaAlsaDeviceCapabilities;
+
 typedef struct PaAlsaDeviceInfo
 {
     PaDeviceInfo baseDeviceInfo;
@@ -680,6 +815,13 @@ typedef struct PaAlsaDeviceInfo
     int isPlug;
     int minInputChannels;
     int minOutputChannels;
+
+    int hasPlayback;    /* As reported when enumerating, before any probing */
+    int hasCapture;
+    int probed;         /* Have the capabilities in baseDeviceInfo been determined? */
+    char *cacheKey;     /* Identifies the device in the persistent cache, NULL for plugin devices and unsuitable keys */
+    int card;           /* Index of the card the device belongs to, -1 for plugins */
+    PaAlsaDeviceCapabilities capabilities[2];   /* Indexed by StreamDirection */
 }
 PaAlsaDeviceInfo;
 
@@ -701,13 +843,22 @@ static PaError OpenStream( struct PaUtilHostApiRepresentation *hostApi,
                            void *userData );
 static PaError CloseStream( PaStream* stream );
 static PaError StartStream( PaStream *stream );
+static PaError StartStreamAt( PaStream *stream, PaTime when );
+static PaError PrepareStream( PaStream *stream );
 static PaError StopStream( PaStream *stream );
 static PaError AbortStream( PaStream *stream );
+static PaError StartStreams( PaStream **streams, int count );
+static PaError StopStreams( PaStream **streams, int count );
 static PaError IsStreamStopped( PaStream *s );
 static PaError IsStreamActive( PaStream *stream );
 static PaTime GetStreamTime( PaStream *stream );
 static double GetStreamCpuLoad( PaStream* stream );
 static PaError BuildDeviceList( PaAlsaHostApiRepresentation *hostApi );
+static PaError UpdateDeviceInfo( struct PaUtilHostApiRepresentation *hostApi, int device );
+static PaError ProbeDeviceCapabilities( PaAlsaHostApiRepresentation *alsaApi, PaAlsaDeviceInfo *devInfo );
+static void PaAlsaDeviceCache_Load( PaAlsaDeviceCache *self, const char *path );
+static void PaAlsaDeviceCache_Save( PaAlsaDeviceCache *self );
+static void PaAlsaDeviceCache_Free( PaAlsaDeviceCache *self );
 static int SetApproximateSampleRate( snd_pcm_t *pcm, snd_pcm_hw_params_t *hwParams, double sampleRate );
 static int GetExactSampleRate( snd_pcm_hw_params_t *hwParams, double *sampleRate );
 static PaUint32 PaAlsaVersionNum(void);
@@ -720,6 +871,12 @@ static signed long GetStreamReadAvailable( PaStream* s );
 static signed long GetStreamWriteAvailable( PaStream* s );
 static PaError ReadStream( PaStream* stream, void *buffer, unsigned long frames );
 static PaError WriteStream( PaStream* stream, const void *buffer, unsigned long frames );
+static PaError GetStreamWriteBuffer( PaStream* stream, void **buffer, unsigned long *frames );
+static PaError CommitStreamWriteBuffer( PaStream* stream, unsigned long frames );
+static PaError ReadStreamTimeout( PaStream* stream, void *buffer, unsigned long *frames, PaTime timeout );
+static PaError WriteStreamTimeout( PaStream* stream, const void *buffer, unsigned long *frames, PaTime timeout );
+static PaError GetStreamPollDescriptor( PaStream* stream, int *fd );
+static PaError PaAlsaStream_AlignStart( PaAlsaStream *self, PaTime when );
 
 
 static const PaAlsaDeviceInfo *GetDeviceInfo( const PaUtilHostApiRepresentation *hostApi, int device )
@@ -748,6 +905,16 @@ PaError PaAlsa_Initialize( PaUtilHostApiRepresentation **hostApi, PaHostApiIndex
     PA_UNLESS( alsaHostApi->allocations = PaUtil_CreateAllocationGroup(), paInsufficientMemory );
     alsaHostApi->hostApiIndex = hostApiIndex;
     alsaHostApi->alsaLibVersion = PaAlsaVersionNum();
+    alsaHostApi->aggregateMembers = NULL;
+    memset( &alsaHostApi->deviceCache, 0, sizeof (PaAlsaDeviceCache) );
+    PA_ENSURE( PaUnixMutex_Initialize( &alsaHostApi->probeMtx ) );
+
+    /* If PA_ALSA_LAZY_PROBE is 1 (non-zero), devices are only enumerated by name here, their capabilities are
+     * determined when first asked for. PA_ALSA_DEVICE_CACHE names a file in which capabilities of hardware
+     * devices are remembered between runs, so these need not be probed at all. */
+    alsaHostApi->lazyProbe = getenv( "PA_ALSA_LAZY_PROBE" ) && atoi( getenv( "PA_ALSA_LAZY_PROBE" ) );
+    if( getenv( "PA_ALSA_DEVICE_CACHE" ) && *getenv( "PA_ALSA_DEVICE_CACHE" ) )
+        PaAlsaDeviceCache_Load( &alsaHostApi->deviceCache, getenv( "PA_ALSA_DEVICE_CACHE" ) );
 
     *hostApi = (PaUtilHostApiRepresentation*)alsaHostApi;
     (*hostApi)->info.structVersion = 1;
@@ -757,6 +924,7 @@ PaError PaAlsa_Initialize( PaUtilHostApiRepresentation **hostApi, PaHostApiIndex
     (*hostApi)->Terminate = Terminate;
     (*hostApi)->OpenStream = OpenStream;
     (*hostApi)->IsFormatSupported = IsFormatSupported;
+    (*hostApi)->UpdateDeviceInfo = UpdateDeviceInfo;
 
     /** If AlsaErrorHandler is to be used, do not forget to unregister callback pointer in
         Terminate function.
@@ -782,6 +950,19 @@ PaError PaAlsa_Initialize( PaUtilHostApiRepresentation **hostApi, PaHostApiIndex
                                       ReadStream, WriteStream,
                                       GetStreamReadAvailable,
                                       GetStreamWriteAvailable );
+    alsaHostApi->blockingStreamInterface.GetWriteBuffer = GetStreamWriteBuffer;
+    alsaHostApi->blockingStreamInterface.CommitWriteBuffer = CommitStreamWriteBuffer;
+    alsaHostApi->blockingStreamInterface.ReadTimeout = ReadStreamTimeout;
+    alsaHostApi->blockingStreamInterface.WriteTimeout = WriteStreamTimeout;
+    alsaHostApi->blockingStreamInterface.GetPollDescriptor = GetStreamPollDescriptor;
+    alsaHostApi->callbackStreamInterface.StartAt = StartStreamAt;
+    alsaHostApi->blockingStreamInterface.StartAt = StartStreamAt;
+    alsaHostApi->callbackStreamInterface.StartGroup = StartStreams;
+    alsaHostApi->blockingStreamInterface.StartGroup = StartStreams;
+    alsaHostApi->callbackStreamInterface.StopGroup = StopStreams;
+    alsaHostApi->blockingStreamInterface.StopGroup = StopStreams;
+    alsaHostApi->callbackStreamInterface.Prepare = PrepareStream;
+    alsaHostApi->blockingStreamInterface.Prepare = PrepareStream;
 
     PA_ENSURE( PaUnixThreading_Initialize() );
 
@@ -794,6 +975,8 @@ error:
         {
             PaUtil_FreeAllAllocations( alsaHostApi->allocations );
             PaUtil_DestroyAllocationGroup( alsaHostApi->allocations );
+            PaAlsaDeviceCache_Free( &alsaHostApi->deviceCache );
+            PaUnixMutex_Terminate( &alsaHostApi->probeMtx );
         }
 
         PaUtil_FreeMemory( alsaHostApi );
@@ -812,6 +995,11 @@ static void Terminate( struct PaUtilHostApiRepresentation *hostApi )
     */
     /*snd_lib_error_set_handler(NULL);*/
 
+    /* Remember capabilities probed during this session */
+    PaAlsaDeviceCache_Save( &alsaHostApi->deviceCache );
+    PaAlsaDeviceCache_Free( &alsaHostApi->deviceCache );
+    PaUnixMutex_Terminate( &alsaHostApi->probeMtx );
+
     if( alsaHostApi->allocations )
     {
         PaUtil_FreeAllAllocations( alsaHostApi->allocations );
@@ -987,6 +1175,8 @@ typedef struct
     int isPlug;
     int hasPlayback;
     int hasCapture;
+    char *cacheKey;
+    int card;           /* Index of the card the device belongs to, -1 for plugins */
 } HwDevInfo;
 
 
@@ -1110,6 +1300,177 @@ static char *SkipCardDetailsInName( char *infoSkipName, char *cardRefName )
     return lastSpacePosn;
 }
 
+/* Append formatted text to the configuration being built in conf, which is reallocated as needed */
+static int AppendConfig( char **conf, size_t *confLen, const char *format, ... )
+{
+    va_list args;
+    size_t len = *confLen;
+    int n;
+    char *newConf;
+
+    va_start( args, format );
+    n = vsnprintf( NULL, 0, format, args );
+    va_end( args );
+
+    if( !(newConf = (char *)realloc( *conf, len + n + 1 )) )
+        return -ENOMEM;
+    va_start( args, format );
+    vsnprintf( newConf + len, n + 1, format, args );
+    va_end( args );
+
+    *conf = newConf;
+    *confLen = len + n;
+    return 0;
+}
+
+/** Check that the members of the aggregate run on a common clock, and can be linked with snd_pcm_link.
+ *
+ * The aggregate does no drift compensation, members on independent clocks would drift apart and keep running
+ * into xruns. A successful link doesn't tell, it only shares the start and stop trigger, so the members must also
+ * be devices of one card, which are clocked by it. Cards synced by an external clock can't be verified and are
+ * refused as well.
+ *
+ * The kernel only links configured pcms, each member is given the default configuration for the check.
+ */
+static int CheckAggregateMembers( snd_pcm_t **pcms, int numMembers )
+{
+    snd_pcm_hw_params_t *hwParams;
+    snd_pcm_info_t *pcmInfo;
+    int i, card = -1, ret = 0;
+
+    alsa_snd_pcm_info_alloca( &pcmInfo );
+    for( i = 0; i < numMembers && ret >= 0; ++i )
+    {
+        if( (ret = alsa_snd_pcm_info( pcms[i], pcmInfo )) < 0 )
+            break;
+        if( i == 0 )
+            card = alsa_snd_pcm_info_get_card( pcmInfo );
+        else if( alsa_snd_pcm_info_get_card( pcmInfo ) != card )
+        {
+            PA_DEBUG(( "%s: Aggregate members are on different cards, they may not share a clock\n", __FUNCTION__ ));
+            return -EINVAL;
+        }
+    }
+
+    alsa_snd_pcm_hw_params_alloca( &hwParams );
+    for( i = 0; i < numMembers && ret >= 0; ++i )
+    {
+        if( (ret = alsa_snd_pcm_hw_params_any( pcms[i], hwParams )) >= 0 )
+            ret = alsa_snd_pcm_hw_params( pcms[i], hwParams );
+    }
+    for( i = 1; i < numMembers && ret >= 0; ++i )
+        ret = alsa_snd_pcm_link( pcms[0], pcms[i] );
+    if( ret < 0 )
+        PA_DEBUG(( "%s: Aggregate members can't be linked (%s)\n", __FUNCTION__, alsa_snd_strerror( ret ) ));
+
+    for( i = 1; i < numMembers; ++i )
+        alsa_snd_pcm_unlink( pcms[i] );
+    return ret;
+}
+
+/** Open the aggregate device.
+ *
+ * The aggregate is an ALSA multi PCM, which is defined on the fly from the list of members. The multi plugin
+ * links its slaves, so that they are started and stopped in sync. Each member contributes all of its channels,
+ * in the order the members are listed. Members without a common clock fail the open, see CheckAggregateMembers.
+ */
+static int OpenAggregatePcm( const char *aggregateMembers, snd_pcm_t **pcmp, snd_pcm_stream_t stream, int mode )
+{
+    char members[256], *member, *savePtr;
+    char *conf = NULL;
+    size_t confLen = 0;
+    unsigned int channels[PA_ALSA_MAX_AGGREGATE_MEMBERS_];
+    snd_pcm_t *pcms[PA_ALSA_MAX_AGGREGATE_MEMBERS_];
+    int numMembers = 0, numOpen = 0, binding = 0, i, ret;
+    unsigned int c;
+    snd_config_t *lconf = NULL;
+    snd_input_t *input = NULL;
+
+    if( strlen( aggregateMembers ) >= sizeof (members) )
+        return -EINVAL;
+    strcpy( members, aggregateMembers );
+
+    if( (ret = AppendConfig( &conf, &confLen, "pcm." PA_ALSA_AGGREGATE_NAME_ " { type multi slaves { " )) < 0 )
+        goto end;
+    for( member = strtok_r( members, "+", &savePtr ); member; member = strtok_r( NULL, "+", &savePtr ) )
+    {
+        char card[32];
+        int device = 0;
+        snd_pcm_hw_params_t *hwParams;
+
+        if( numMembers == PA_ALSA_MAX_AGGREGATE_MEMBERS_ || sscanf( member, "hw:%31[^,],%d", card, &device ) < 1 )
+        {
+            PA_DEBUG(( "%s: Invalid aggregate member '%s'\n", __FUNCTION__, member ));
+            ret = -EINVAL;
+            goto end;
+        }
+
+        /* The multi plugin needs to be told the number of channels of each slave */
+        if( (ret = alsa_snd_pcm_open( &pcms[numOpen], member, stream, mode )) < 0 )
+            goto end;
+        ++numOpen;
+        alsa_snd_pcm_hw_params_alloca( &hwParams );
+        alsa_snd_pcm_hw_params_any( pcms[numMembers], hwParams );
+        if( (ret = alsa_snd_pcm_hw_params_get_channels_max( hwParams, &channels[numMembers] )) < 0 )
+            goto end;
+
+        if( (ret = AppendConfig( &conf, &confLen, "m%d { pcm { type hw card \"%s\" device %d } channels %u } ",
+                        numMembers, card, device, channels[numMembers] )) < 0 )
+            goto end;
+        ++numMembers;
+    }
+    if( !numMembers )
+    {
+        ret = -EINVAL;
+        goto end;
+    }
+    ret = CheckAggregateMembers( pcms, numMembers );
+
+    /* The multi plugin opens the members itself */
+    for( ; numOpen > 0; --numOpen )
+        alsa_snd_pcm_close( pcms[numOpen - 1] );
+    if( ret < 0 )
+        goto end;
+
+    if( (ret = AppendConfig( &conf, &confLen, "} bindings { " )) < 0 )
+        goto end;
+    for( i = 0; i < numMembers; ++i )
+    {
+        for( c = 0; c < channels[i]; ++c )
+        {
+            if( (ret = AppendConfig( &conf, &confLen, "%d { slave m%d channel %u } ", binding++, i, c )) < 0 )
+                goto end;
+        }
+    }
+    if( (ret = AppendConfig( &conf, &confLen, "} }" )) < 0 )
+        goto end;
+    PA_DEBUG(( "%s: Aggregate definition: %s\n", __FUNCTION__, conf ));
+
+    if( (ret = alsa_snd_config_top( &lconf )) < 0 ||
+            (ret = alsa_snd_input_buffer_open( &input, conf, confLen )) < 0 ||
+            (ret = alsa_snd_config_load( lconf, input )) < 0 )
+        goto end;
+    ret = alsa_snd_pcm_open_lconf( pcmp, PA_ALSA_AGGREGATE_NAME_, stream, mode, lconf );
+
+end:
+    for( i = 0; i < numOpen; ++i )
+        alsa_snd_pcm_close( pcms[i] );
+    if( input )
+        alsa_snd_input_close( input );
+    if( lconf )
+        alsa_snd_config_delete( lconf );
+    free( conf );
+    return ret;
+}
+
+static int OpenPcmByName( const PaAlsaHostApiRepresentation *alsaApi, snd_pcm_t **pcmp, const char *name,
+        snd_pcm_stream_t stream, int mode )
+{
+    if( alsaApi->aggregateMembers && !strcmp( name, PA_ALSA_AGGREGATE_NAME_ ) )
+        return OpenAggregatePcm( alsaApi->aggregateMembers, pcmp, stream, mode );
+    return alsa_snd_pcm_open( pcmp, name, stream, mode );
+}
+
 /** Open PCM device.
  *
  * Wrapper around alsa_snd_pcm_open which may repeatedly retry opening a device if it is busy, for
@@ -1118,16 +1479,17 @@ static char *SkipCardDetailsInName( char *infoSkipName, char *cardRefName )
  * @param mode: Open mode (e.g., SND_PCM_BLOCKING).
  * @param waitOnBusy: Retry opening busy device for up to one second?
  **/
-static int OpenPcm( snd_pcm_t **pcmp, const char *name, snd_pcm_stream_t stream, int mode, int waitOnBusy )
+static int OpenPcm( const PaAlsaHostApiRepresentation *alsaApi, snd_pcm_t **pcmp, const char *name,
+        snd_pcm_stream_t stream, int mode, int waitOnBusy )
 {
     int ret, tries = 0, maxTries = waitOnBusy ? busyRetries_ : 0;
 
-    ret = alsa_snd_pcm_open( pcmp, name, stream, mode );
+    ret = OpenPcmByName( alsaApi, pcmp, name, stream, mode );
 
     for( tries = 0; tries < maxTries && -EBUSY == ret; ++tries )
     {
         Pa_Sleep( 10 );
-        ret = alsa_snd_pcm_open( pcmp, name, stream, mode );
+        ret = OpenPcmByName( alsaApi, pcmp, name, stream, mode );
         if( -EBUSY != ret )
         {
             PA_DEBUG(( "%s: Successfully opened initially busy device after %d tries\n", __FUNCTION__, tries ));
@@ -1146,66 +1508,353 @@ static int OpenPcm( snd_pcm_t **pcmp, const char *name, snd_pcm_stream_t stream,
     return ret;
 }
 
-static PaError FillInDevInfo( PaAlsaHostApiRepresentation *alsaApi, HwDevInfo* deviceHwInfo, int blocking,
-        PaAlsaDeviceInfo* devInfo, int* devIdx )
+/* Persistent device cache
+ *
+ * The cache is a text file with one line per hardware device, holding the key the device is known by (made up of
+ * the card's id and driver, so it survives renumbering of cards) followed by the channel ranges, default latencies
+ * in microseconds and default sample rate in millihertz. Integers are used throughout to avoid depending on the
+ * current locale. Keys are at most PA_ALSA_DEVICE_CACHE_MAX_KEY_ characters long and contain no whitespace, devices
+ * whose key doesn't fit aren't cached. The file is replaced as a whole when saved, so readers never see it half
+ * written.
+ */
+
+#define PA_ALSA_DEVICE_CACHE_HEADER "# PortAudio ALSA device cache v1"
+#define PA_ALSA_DEVICE_CACHE_MAX_KEY_ 127
+#define PA_ALSA_STRINGIFY_( x ) #x
+#define PA_ALSA_TOSTRING_( x ) PA_ALSA_STRINGIFY_( x )
+
+/* Whether a key can be written to the cache file and read back unchanged */
+static int PaAlsaDeviceCache_IsValidKey( const char *key )
 {
-    PaError result = 0;
+    return strlen( key ) <= PA_ALSA_DEVICE_CACHE_MAX_KEY_ && !strpbrk( key, " \t\n\v\f\r" );
+}
+
+static const PaAlsaCachedDevice *PaAlsaDeviceCache_Find( const PaAlsaDeviceCache *self, const char *key )
+{
+    size_t i;
+
+    for( i = 0; i < self->numEntries; ++i )
+    {
+        if( !strcmp( self->entries[i].key, key ) )
+            return &self->entries[i];
+    }
+
+    return NULL;
+}
+
+static PaError PaAlsaDeviceCache_Add( PaAlsaDeviceCache *self, const PaAlsaCachedDevice *entry )
+{
+    PaError result = paNoError;
+    PaAlsaCachedDevice *newEntry;
+
+    if( self->numEntries == self->maxEntries )
+    {
+        size_t maxEntries = self->maxEntries ? self->maxEntries * 2 : 16;
+        PaAlsaCachedDevice *entries;
+        PA_UNLESS( entries = (PaAlsaCachedDevice *) realloc( self->entries, maxEntries * sizeof (PaAlsaCachedDevice) ),
+                paInsufficientMemory );
+        self->entries = entries;
+        self->maxEntries = maxEntries;
+    }
+
+    newEntry = &self->entries[self->numEntries];
+    *newEntry = *entry;
+    PA_UNLESS( newEntry->key = strdup( entry->key ), paInsufficientMemory );
+    ++self->numEntries;
+
+error:
+    return result;
+}
+
+static void PaAlsaDeviceCache_Load( PaAlsaDeviceCache *self, const char *path )
+{
+    FILE *file;
+    /* Room for the key and ten numbers */
+    char line[PA_ALSA_DEVICE_CACHE_MAX_KEY_ + 256];
+
+    self->path = path;
+    if( !(file = fopen( path, "r" )) )
+    {
+        PA_DEBUG(( "%s: No device cache at %s\n", __FUNCTION__, path ));
+        return;
+    }
+
+    /* Disregard caches written by another version of this code */
+    if( !fgets( line, sizeof (line), file ) || strncmp( line, PA_ALSA_DEVICE_CACHE_HEADER,
+                strlen( PA_ALSA_DEVICE_CACHE_HEADER ) ) )
+    {
+        PA_DEBUG(( "%s: Ignoring device cache %s with unknown format\n", __FUNCTION__, path ));
+        fclose( file );
+        return;
+    }
+
+    while( fgets( line, sizeof (line), file ) )
+    {
+        char key[PA_ALSA_DEVICE_CACHE_MAX_KEY_ + 1];
+        int keyEnd = 0;
+        long lowIn, highIn, lowOut, highOut, rate;
+        PaAlsaCachedDevice entry;
+
+        if( !strchr( line, '\n' ) && !feof( file ) )
+        {
+            /* Not written by us, skip the rest of the line */
+            int c;
+            while( (c = fgetc( file )) != EOF && c != '\n' )
+                ;
+            continue;
+        }
+
+        /* A key longer than the field width would leave its tail to be read as the first number */
+        if( sscanf( line, "%" PA_ALSA_TOSTRING_( PA_ALSA_DEVICE_CACHE_MAX_KEY_ ) "s%n %d %d %d %d %ld %ld %ld %ld %ld",
+                    key, &keyEnd, &entry.minInputChannels, &entry.maxInputChannels, &entry.minOutputChannels,
+                    &entry.maxOutputChannels, &lowIn, &highIn, &lowOut, &highOut, &rate ) != 10 ||
+                ( line[keyEnd] != ' ' && line[keyEnd] != '\t' ) )
+            continue;
+
+        entry.key = key;
+        entry.defaultLowInputLatency = lowIn / 1e6;
+        entry.defaultHighInputLatency = highIn / 1e6;
+        entry.defaultLowOutputLatency = lowOut / 1e6;
+        entry.defaultHighOutputLatency = highOut / 1e6;
+        entry.defaultSampleRate = rate / 1e3;
+        if( PaAlsaDeviceCache_Add( self, &entry ) != paNoError )
+            break;
+    }
+    fclose( file );
+
+    PA_DEBUG(( "%s: Read %lu devices from %s\n", __FUNCTION__, (unsigned long)self->numEntries, path ));
+}
+
+/* The cache is written to a temporary file next to it, which then replaces it */
+static void PaAlsaDeviceCache_Save( PaAlsaDeviceCache *self )
+{
+    FILE *file = NULL;
+    char *tmpPath;
+    size_t i;
+    int fd, failed;
+    struct stat st;
+
+    if( !self->path || !self->dirty )
+        return;
+
+    if( !(tmpPath = (char *)malloc( strlen( self->path ) + sizeof (".XXXXXX") )) )
+        return;
+    strcpy( tmpPath, self->path );
+    strcat( tmpPath, ".XXXXXX" );
+    if( (fd = mkstemp( tmpPath )) < 0 || !(file = fdopen( fd, "w" )) )
+    {
+        PA_DEBUG(( "%s: Failed writing device cache to %s\n", __FUNCTION__, tmpPath ));
+        if( fd >= 0 )
+        {
+            close( fd );
+            unlink( tmpPath );
+        }
+        free( tmpPath );
+        return;
+    }
+    /* mkstemp creates the file private to the user, keep the permissions of the cache it replaces */
+    if( stat( self->path, &st ) == 0 )
+        fchmod( fd, st.st_mode & 07777 );
+
+    fprintf( file, "%s\n", PA_ALSA_DEVICE_CACHE_HEADER );
+    for( i = 0; i < self->numEntries; ++i )
+    {
+        const PaAlsaCachedDevice *entry = &self->entries[i];
+        if( !PaAlsaDeviceCache_IsValidKey( entry->key ) )
+            continue;
+        fprintf( file, "%s %d %d %d %d %ld %ld %ld %ld %ld\n", entry->key,
+                entry->minInputChannels, entry->maxInputChannels, entry->minOutputChannels, entry->maxOutputChannels,
+                (long)( entry->defaultLowInputLatency * 1e6 ), (long)( entry->defaultHighInputLatency * 1e6 ),
+                (long)( entry->defaultLowOutputLatency * 1e6 ), (long)( entry->defaultHighOutputLatency * 1e6 ),
+                (long)( entry->defaultSampleRate * 1e3 ) );
+    }
+    failed = ferror( file );
+    failed = fclose( file ) != 0 || failed;
+    if( failed || rename( tmpPath, self->path ) < 0 )
+    {
+        PA_DEBUG(( "%s: Failed writing device cache to %s\n", __FUNCTION__, self->path ));
+        unlink( tmpPath );
+    }
+    else
+        self->dirty = 0;
+    free( tmpPath );
+}
+
+static void PaAlsaDeviceCache_Free( PaAlsaDeviceCache *self )
+{
+    size_t i;
+
+    for( i = 0; i < self->numEntries; ++i )
+        free( self->entries[i].key );
+    free( self->entries );
+    memset( self, 0, sizeof (PaAlsaDeviceCache) );
+}
+
+/** Determine the capabilities of a device.
+ *
+ * The capabilities are taken from the persistent device cache if possible, otherwise the device is opened for
+ * capture and/or playback and groped. Should the device be unavailable its channel counts are left at zero.
+ */
+static PaError ProbeDeviceCapabilities( PaAlsaHostApiRepresentation *alsaApi, PaAlsaDeviceInfo *devInfo )
+{
+    PaError result = paNoError;
     PaDeviceInfo *baseDeviceInfo = &devInfo->baseDeviceInfo;
+    const PaAlsaCachedDevice *cached = NULL;
     snd_pcm_t *pcm = NULL;
-    PaUtilHostApiRepresentation *baseApi = &alsaApi->baseHostApiRep;
-
-    PA_DEBUG(( "%s: Filling device info for: %s\n", __FUNCTION__, deviceHwInfo->name ));
+    int locked = 0;
 
-    /* Zero fields */
-    InitializeDeviceInfo( baseDeviceInfo );
+    if( devInfo->probed )
+        return result;
+    devInfo->probed = 1;
+
+    /* Devices may be probed from several threads at once, cached entries move when the cache grows */
+    PA_ENSURE( PaUnixMutex_Lock( &alsaApi->probeMtx ) );
+    locked = 1;
+    if( devInfo->cacheKey && (cached = PaAlsaDeviceCache_Find( &alsaApi->deviceCache, devInfo->cacheKey )) )
+    {
+        PA_DEBUG(( "%s: Using cached capabilities for %s\n", __FUNCTION__, devInfo->alsaName ));
+        devInfo->minInputChannels = cached->minInputChannels;
+        devInfo->minOutputChannels = cached->minOutputChannels;
+        baseDeviceInfo->maxInputChannels = cached->maxInputChannels;
+        baseDeviceInfo->maxOutputChannels = cached->maxOutputChannels;
+        baseDeviceInfo->defaultLowInputLatency = cached->defaultLowInputLatency;
+        baseDeviceInfo->defaultHighInputLatency = cached->defaultHighInputLatency;
+        baseDeviceInfo->defaultLowOutputLatency = cached->defaultLowOutputLatency;
+        baseDeviceInfo->defaultHighOutputLatency = cached->defaultHighOutputLatency;
+        baseDeviceInfo->defaultSampleRate = cached->defaultSampleRate;
+        goto end;
+    }
+    PA_ENSURE( PaUnixMutex_Unlock( &alsaApi->probeMtx ) );
+    locked = 0;
 
     /* To determine device capabilities, we must open the device and query the
      * hardware parameter configuration space */
 
     /* Query capture */
-    if( deviceHwInfo->hasCapture &&
-        OpenPcm( &pcm, deviceHwInfo->alsaName, SND_PCM_STREAM_CAPTURE, blocking, 0 ) >= 0 )
+    if( devInfo->hasCapture &&
+        OpenPcm( alsaApi, &pcm, devInfo->alsaName, SND_PCM_STREAM_CAPTURE, alsaApi->probeMode, 0 ) >= 0 )
     {
-        if( GropeDevice( pcm, deviceHwInfo->isPlug, StreamDirection_In, blocking, devInfo ) != paNoError )
+        if( GropeDevice( pcm, devInfo->isPlug, StreamDirection_In, alsaApi->probeMode, devInfo ) != paNoError )
         {
             /* Error */
-            PA_DEBUG(( "%s: Failed groping %s for capture\n", __FUNCTION__, deviceHwInfo->alsaName ));
-            goto end;
+            PA_DEBUG(( "%s: Failed groping %s for capture\n", __FUNCTION__, devInfo->alsaName ));
+            goto unusable;
         }
     }
 
     /* Query playback */
-    if( deviceHwInfo->hasPlayback &&
-        OpenPcm( &pcm, deviceHwInfo->alsaName, SND_PCM_STREAM_PLAYBACK, blocking, 0 ) >= 0 )
+    if( devInfo->hasPlayback &&
+        OpenPcm( alsaApi, &pcm, devInfo->alsaName, SND_PCM_STREAM_PLAYBACK, alsaApi->probeMode, 0 ) >= 0 )
     {
-        if( GropeDevice( pcm, deviceHwInfo->isPlug, StreamDirection_Out, blocking, devInfo ) != paNoError )
+        if( GropeDevice( pcm, devInfo->isPlug, StreamDirection_Out, alsaApi->probeMode, devInfo ) != paNoError )
         {
             /* Error */
-            PA_DEBUG(( "%s: Failed groping %s for playback\n", __FUNCTION__, deviceHwInfo->alsaName ));
-            goto end;
+            PA_DEBUG(( "%s: Failed groping %s for playback\n", __FUNCTION__, devInfo->alsaName ));
+            goto unusable;
         }
     }
 
-    baseDeviceInfo->structVersion = 2;
+    /* Only remember devices that were found in working order, a busy device should be probed again next time */
+    if( devInfo->cacheKey && alsaApi->deviceCache.path &&
+            ( baseDeviceInfo->maxInputChannels > 0 || baseDeviceInfo->maxOutputChannels > 0 ) )
+    {
+        PaAlsaCachedDevice entry;
+        entry.key = devInfo->cacheKey;
+        entry.minInputChannels = devInfo->minInputChannels;
+        entry.maxInputChannels = baseDeviceInfo->maxInputChannels;
+        entry.minOutputChannels = devInfo->minOutputChannels;
+        entry.maxOutputChannels = baseDeviceInfo->maxOutputChannels;
+        entry.defaultLowInputLatency = baseDeviceInfo->defaultLowInputLatency;
+        entry.defaultHighInputLatency = baseDeviceInfo->defaultHighInputLatency;
+        entry.defaultLowOutputLatency = baseDeviceInfo->defaultLowOutputLatency;
+        entry.defaultHighOutputLatency = baseDeviceInfo->defaultHighOutputLatency;
+        entry.defaultSampleRate = baseDeviceInfo->defaultSampleRate;
+
+        PA_ENSURE( PaUnixMutex_Lock( &alsaApi->probeMtx ) );
+        locked = 1;
+        PA_ENSURE( PaAlsaDeviceCache_Add( &alsaApi->deviceCache, &entry ) );
+        alsaApi->deviceCache.dirty = 1;
+    }
+
+end:
+    if( locked )
+        PaUnixMutex_Unlock( &alsaApi->probeMtx );
+    return result;
+
+unusable:
+    /* A device that can't be groped in either direction is not offered at all */
+    baseDeviceInfo->maxInputChannels = baseDeviceInfo->maxOutputChannels = 0;
+    goto end;
+
+error:
+    goto end;
+}
+
+/* Called from pa_front before device info is handed to the user, probe lazily enumerated devices */
+static PaError UpdateDeviceInfo( struct PaUtilHostApiRepresentation *hostApi, int device )
+{
+    return ProbeDeviceCapabilities( (PaAlsaHostApiRepresentation *)hostApi,
+            (PaAlsaDeviceInfo *)hostApi->deviceInfos[device] );
+}
+
+static void InitializeAlsaDeviceInfo( PaAlsaHostApiRepresentation *alsaApi, const HwDevInfo* deviceHwInfo,
+        PaAlsaDeviceInfo* devInfo )
+{
+    PaDeviceInfo *baseDeviceInfo = &devInfo->baseDeviceInfo;
+
+    /* Zero fields */
+    InitializeDeviceInfo( baseDeviceInfo );
+
     baseDeviceInfo->hostApi = alsaApi->hostApiIndex;
     baseDeviceInfo->name = deviceHwInfo->name;
     devInfo->alsaName = deviceHwInfo->alsaName;
     devInfo->isPlug = deviceHwInfo->isPlug;
+    devInfo->hasPlayback = deviceHwInfo->hasPlayback;
+    devInfo->hasCapture = deviceHwInfo->hasCapture;
+    devInfo->cacheKey = deviceHwInfo->cacheKey;
+    devInfo->card = deviceHwInfo->card;
+    devInfo->probed = 0;
+    devInfo->capabilities[StreamDirection_In].valid = devInfo->capabilities[StreamDirection_Out].valid = 0;
+}
+
+/* Probe the device unless this was done already and add it to the device list if it is usable */
+static PaError FillInDevInfo( PaAlsaHostApiRepresentation *alsaApi, HwDevInfo* deviceHwInfo,
+        PaAlsaDeviceInfo* devInfo, int* devIdx )
+{
+    PaError result = 0;
+    PaDeviceInfo *baseDeviceInfo = &devInfo->baseDeviceInfo;
+    PaUtilHostApiRepresentation *baseApi = &alsaApi->baseHostApiRep;
+    int hasInput, hasOutput;
+
+    PA_DEBUG(( "%s: Filling device info for: %s\n", __FUNCTION__, deviceHwInfo->name ));
+
+    /* In lazy mode probing is deferred, unless the cache can tell us about the device for free */
+    if( !alsaApi->lazyProbe || ( devInfo->cacheKey &&
+                PaAlsaDeviceCache_Find( &alsaApi->deviceCache, devInfo->cacheKey ) ) )
+    {
+        PA_ENSURE( ProbeDeviceCapabilities( alsaApi, devInfo ) );
+    }
+
+    baseDeviceInfo->structVersion = 2;
+
+    /* A device which is yet to be probed is assumed to work in the directions reported by ALSA */
+    hasInput = devInfo->probed ? baseDeviceInfo->maxInputChannels > 0 : devInfo->hasCapture;
+    hasOutput = devInfo->probed ? baseDeviceInfo->maxOutputChannels > 0 : devInfo->hasPlayback;
 
     /* A: Storing pointer to PaAlsaDeviceInfo object as pointer to PaDeviceInfo object.
      * Should now be safe to add device info, unless the device supports neither capture nor playback
      */
-    if( baseDeviceInfo->maxInputChannels > 0 || baseDeviceInfo->maxOutputChannels > 0 )
+    if( hasInput || hasOutput )
     {
         /* Make device default if there isn't already one or it is the ALSA "default" device */
         if( ( baseApi->info.defaultInputDevice == paNoDevice ||
-            !strcmp( deviceHwInfo->alsaName, "default" ) ) && baseDeviceInfo->maxInputChannels > 0 )
+            !strcmp( deviceHwInfo->alsaName, "default" ) ) && hasInput )
         {
             baseApi->info.defaultInputDevice = *devIdx;
             PA_DEBUG(( "Default input device: %s\n", deviceHwInfo->name ));
         }
         if( ( baseApi->info.defaultOutputDevice == paNoDevice ||
-            !strcmp( deviceHwInfo->alsaName, "default" ) ) && baseDeviceInfo->maxOutputChannels > 0 )
+            !strcmp( deviceHwInfo->alsaName, "default" ) ) && hasOutput )
         {
             baseApi->info.defaultOutputDevice = *devIdx;
             PA_DEBUG(( "Default output device: %s\n", deviceHwInfo->name ));
@@ -1221,6 +1870,132 @@ static PaError FillInDevInfo( PaAlsaHostApiRepresentation *alsaApi, HwDevInfo* d
 
 end:
     return result;
+
+error:
+    goto end;
+}
+
+/* Parallel probing of hardware devices
+ *
+ * Opening and groping a device can take a considerable amount of time, in particular for USB devices, so when
+ * there is more than one card the cards are probed concurrently. Each worker repeatedly claims the next
+ * unprobed card and probes its devices in turn, devices of one card are never probed concurrently. Results are
+ * stored in place, registration of the devices happens afterwards in enumeration order so device indices do not
+ * depend on the order in which probing finishes.
+ */
+
+#define PA_ALSA_MAX_PROBE_THREADS_ 8
+
+typedef struct
+{
+    PaAlsaHostApiRepresentation *alsaApi;
+    const HwDevInfo *hwDevInfos;
+    PaAlsaDeviceInfo *deviceInfos;
+    size_t numDevices;
+    const int *cards;
+    int numCards;
+
+    PaUnixMutex mtx;    /* Protects the members below */
+    int nextCard;
+    PaError result;
+}
+PaAlsaProbeJob;
+
+static void *ProbeThreadFunc( void *userData )
+{
+    PaAlsaProbeJob *job = (PaAlsaProbeJob *)userData;
+
+    for( ;; )
+    {
+        int card;
+        size_t i;
+        PaError err = paNoError;
+
+        PaUnixMutex_Lock( &job->mtx );
+        card = job->nextCard < job->numCards ? job->cards[job->nextCard++] : -1;
+        PaUnixMutex_Unlock( &job->mtx );
+        if( card < 0 )
+            break;
+
+        for( i = 0; i < job->numDevices && err == paNoError; ++i )
+        {
+            if( job->hwDevInfos[i].card == card )
+                err = ProbeDeviceCapabilities( job->alsaApi, &job->deviceInfos[i] );
+        }
+
+        if( err != paNoError )
+        {
+            PaUnixMutex_Lock( &job->mtx );
+            if( job->result == paNoError )
+                job->result = err;
+            PaUnixMutex_Unlock( &job->mtx );
+        }
+    }
+
+    return NULL;
+}
+
+/* Probe all hardware devices, using up to PA_ALSA_PROBE_THREADS (default 4) threads */
+static PaError ProbeHardwareDevices( PaAlsaHostApiRepresentation *alsaApi, const HwDevInfo *hwDevInfos,
+        PaAlsaDeviceInfo *deviceInfos, size_t numDevices )
+{
+    PaError result = paNoError;
+    PaAlsaProbeJob job;
+    pthread_t threads[PA_ALSA_MAX_PROBE_THREADS_];
+    int *cards = NULL;
+    int numCards = 0, numThreads = 4, numStarted = 0, mtxInitialized = 0, i;
+    size_t j;
+
+    if( getenv( "PA_ALSA_PROBE_THREADS" ) && atoi( getenv( "PA_ALSA_PROBE_THREADS" ) ) > 0 )
+        numThreads = PA_MIN( atoi( getenv( "PA_ALSA_PROBE_THREADS" ) ), PA_ALSA_MAX_PROBE_THREADS_ );
+
+    /* Collect distinct cards, devices of a card are contiguous */
+    PA_UNLESS( cards = (int *)PaUtil_AllocateMemory( sizeof (int) * (numDevices + 1) ), paInsufficientMemory );
+    for( j = 0; j < numDevices; ++j )
+    {
+        if( hwDevInfos[j].card >= 0 && ( numCards == 0 || cards[numCards - 1] != hwDevInfos[j].card ) )
+            cards[numCards++] = hwDevInfos[j].card;
+    }
+
+    job.alsaApi = alsaApi;
+    job.hwDevInfos = hwDevInfos;
+    job.deviceInfos = deviceInfos;
+    job.numDevices = numDevices;
+    job.cards = cards;
+    job.numCards = numCards;
+    job.nextCard = 0;
+    job.result = paNoError;
+    PA_ENSURE( PaUnixMutex_Initialize( &job.mtx ) );
+    mtxInitialized = 1;
+
+    numThreads = PA_MIN( numThreads, numCards );
+    for( i = 0; i < numThreads - 1; ++i )
+    {
+        if( pthread_create( &threads[i], NULL, &ProbeThreadFunc, &job ) != 0 )
+        {
+            /* Not fatal, the remaining cards are probed by the threads we have */
+            PA_DEBUG(( "%s: Failed creating probe thread\n", __FUNCTION__ ));
+            break;
+        }
+        ++numStarted;
+    }
+    PA_DEBUG(( "%s: Probing %d cards using %d threads\n", __FUNCTION__, numCards, numStarted + 1 ));
+
+    /* The calling thread takes part as well, this also makes sure every card is probed */
+    ProbeThreadFunc( &job );
+    for( i = 0; i < numStarted; ++i )
+        pthread_join( threads[i], NULL );
+
+    PA_ENSURE( job.result );
+
+end:
+    if( mtxInitialized )
+        PaUnixMutex_Terminate( &job.mtx );
+    PaUtil_FreeMemory( cards );
+    return result;
+
+error:
+    goto end;
 }
 
 /* Build PaDeviceInfo list, ignore devices for which we cannot determine capabilities (possibly busy, sigh) */
@@ -1246,6 +2021,8 @@ static PaError BuildDeviceList( PaAlsaHostApiRepresentation *alsaApi )
 
     if( getenv( "PA_ALSA_INITIALIZE_BLOCK" ) && atoi( getenv( "PA_ALSA_INITIALIZE_BLOCK" ) ) )
         blocking = 0;
+    /* Devices may also be probed after initialization, remember how to open them */
+    alsaApi->probeMode = blocking;
 
     /* If PA_ALSA_PLUGHW is 1 (non-zero), use the plughw: pcm throughout instead of hw: */
     if( getenv( "PA_ALSA_PLUGHW" ) && atoi( getenv( "PA_ALSA_PLUGHW" ) ) )
@@ -1292,7 +2069,7 @@ static PaError BuildDeviceList( PaAlsaHostApiRepresentation *alsaApi )
 
         while( alsa_snd_ctl_pcm_next_device( ctl, &devIdx ) == 0 && devIdx >= 0 )
         {
-            char *alsaDeviceName, *deviceName, *infoName;
+            char *alsaDeviceName, *deviceName, *infoName, *cacheKey;
             size_t len;
             int hasPlayback = 0, hasCapture = 0;
 
@@ -1337,11 +2114,26 @@ static PaError BuildDeviceList( PaAlsaHostApiRepresentation *alsaApi )
 
             PA_ENSURE( PaAlsa_StrDup( alsaApi, &alsaDeviceName, buf ) );
 
+            /* The card's id and driver identify it in the device cache independently of its index */
+            len = snprintf( NULL, 0, "%s/%s/%d%s", alsa_snd_ctl_card_info_get_id( cardInfo ),
+                    alsa_snd_ctl_card_info_get_driver( cardInfo ), devIdx, usePlughw ? ":plug" : "" ) + 1;
+            PA_UNLESS( cacheKey = (char *)PaUtil_GroupAllocateMemory( alsaApi->allocations, len ),
+                    paInsufficientMemory );
+            snprintf( cacheKey, len, "%s/%s/%d%s", alsa_snd_ctl_card_info_get_id( cardInfo ),
+                    alsa_snd_ctl_card_info_get_driver( cardInfo ), devIdx, usePlughw ? ":plug" : "" );
+            if( !PaAlsaDeviceCache_IsValidKey( cacheKey ) )
+            {
+                PA_DEBUG(( "%s: Not caching %s, its key '%s' is unsuitable\n", __FUNCTION__, buf, cacheKey ));
+                cacheKey = NULL;
+            }
+
             hwDevInfos[ numDeviceNames - 1 ].alsaName = alsaDeviceName;
             hwDevInfos[ numDeviceNames - 1 ].name = deviceName;
             hwDevInfos[ numDeviceNames - 1 ].isPlug = usePlughw;
             hwDevInfos[ numDeviceNames - 1 ].hasPlayback = hasPlayback;
             hwDevInfos[ numDeviceNames - 1 ].hasCapture = hasCapture;
+            hwDevInfos[ numDeviceNames - 1 ].cacheKey = cacheKey;
+            hwDevInfos[ numDeviceNames - 1 ].card = cardIdx;
         }
         alsa_snd_ctl_close( ctl );
     }
@@ -1406,6 +2198,9 @@ static PaError BuildDeviceList( PaAlsaHostApiRepresentation *alsaApi )
             hwDevInfos[numDeviceNames - 1].alsaName = alsaDeviceName;
             hwDevInfos[numDeviceNames - 1].name     = deviceName;
             hwDevInfos[numDeviceNames - 1].isPlug   = 1;
+            /* Plugins are cheap to reconfigure and are not cached */
+            hwDevInfos[numDeviceNames - 1].cacheKey = NULL;
+            hwDevInfos[numDeviceNames - 1].card = -1;
 
             if( predefined )
             {
@@ -1422,6 +2217,39 @@ static PaError BuildDeviceList( PaAlsaHostApiRepresentation *alsaApi )
     else
         PA_DEBUG(( "%s: Iterating over ALSA plugins failed: %s\n", __FUNCTION__, alsa_snd_strerror( res ) ));
 
+    /* If PA_ALSA_AGGREGATE lists hw devices, separated by '+' (e.g. "hw:1,0+hw:2,0"), these are offered combined
+     * as a single device. The members must be devices of one card, there is no drift compensation between
+     * independent clocks. Opening it fails otherwise, see CheckAggregateMembers */
+    if( getenv( "PA_ALSA_AGGREGATE" ) && *getenv( "PA_ALSA_AGGREGATE" ) )
+    {
+        char *members, *alsaDeviceName, *deviceName;
+        size_t len;
+
+        PA_ENSURE( PaAlsa_StrDup( alsaApi, &members, getenv( "PA_ALSA_AGGREGATE" ) ) );
+        PA_ENSURE( PaAlsa_StrDup( alsaApi, &alsaDeviceName, PA_ALSA_AGGREGATE_NAME_ ) );
+        len = snprintf( NULL, 0, "Aggregate (%s)", members ) + 1;
+        PA_UNLESS( deviceName = (char *)PaUtil_GroupAllocateMemory( alsaApi->allocations, len ),
+                paInsufficientMemory );
+        snprintf( deviceName, len, "Aggregate (%s)", members );
+        alsaApi->aggregateMembers = members;
+
+        ++numDeviceNames;
+        if( !hwDevInfos || numDeviceNames > maxDeviceNames )
+        {
+            maxDeviceNames *= 2;
+            PA_UNLESS( hwDevInfos = (HwDevInfo *) realloc( hwDevInfos, maxDeviceNames * sizeof (HwDevInfo) ),
+                    paInsufficientMemory );
+        }
+
+        hwDevInfos[numDeviceNames - 1].alsaName = alsaDeviceName;
+        hwDevInfos[numDeviceNames - 1].name = deviceName;
+        hwDevInfos[numDeviceNames - 1].isPlug = 1;
+        hwDevInfos[numDeviceNames - 1].hasPlayback = 1;
+        hwDevInfos[numDeviceNames - 1].hasCapture = 1;
+        hwDevInfos[numDeviceNames - 1].cacheKey = NULL;
+        hwDevInfos[numDeviceNames - 1].card = -1;
+    }
+
     /* allocate deviceInfo memory based on the number of devices */
     PA_UNLESS( baseApi->deviceInfos = (PaDeviceInfo**)PaUtil_GroupAllocateMemory(
             alsaApi->allocations, sizeof(PaDeviceInfo*) * (numDeviceNames) ), paInsufficientMemory );
@@ -1430,6 +2258,14 @@ static PaError BuildDeviceList( PaAlsaHostApiRepresentation *alsaApi )
     PA_UNLESS( deviceInfoArray = (PaAlsaDeviceInfo*)PaUtil_GroupAllocateMemory(
             alsaApi->allocations, sizeof(PaAlsaDeviceInfo) * numDeviceNames ), paInsufficientMemory );
 
+    for( i = 0; i < numDeviceNames; ++i )
+        InitializeAlsaDeviceInfo( alsaApi, &hwDevInfos[i], &deviceInfoArray[i] );
+
+    /* Probe hardware devices up front, in parallel. Plugins are probed below as they may depend on hardware
+     * devices, so probing them concurrently could find these busy */
+    if( !alsaApi->lazyProbe )
+        PA_ENSURE( ProbeHardwareDevices( alsaApi, hwDevInfos, deviceInfoArray, numDeviceNames ) );
+
     /* Loop over list of cards, filling in info. If a device is deemed unavailable (can't get name),
      * it's ignored.
      *
@@ -1448,7 +2284,7 @@ static PaError BuildDeviceList( PaAlsaHostApiRepresentation *alsaApi )
             continue;
         }
 
-        PA_ENSURE( FillInDevInfo( alsaApi, hwInfo, blocking, devInfo, &devIdx ) );
+        PA_ENSURE( FillInDevInfo( alsaApi, hwInfo, devInfo, &devIdx ) );
     }
     assert( devIdx < numDeviceNames );
     /* Now inspect 'dmix' and 'default' plugins */
@@ -1461,7 +2297,7 @@ static PaError BuildDeviceList( PaAlsaHostApiRepresentation *alsaApi )
             continue;
         }
 
-        PA_ENSURE( FillInDevInfo( alsaApi, hwInfo, blocking, devInfo, &devIdx ) );
+        PA_ENSURE( FillInDevInfo( alsaApi, hwInfo, devInfo, &devIdx ) );
     }
     free( hwDevInfos );
 
@@ -1491,6 +2327,8 @@ static PaError ValidateParameters( const PaStreamParameters *parameters, PaUtilH
     {
         assert( parameters->device < hostApi->info.deviceCount );
         PA_UNLESS( parameters->hostApiSpecificStreamInfo == NULL, paBadIODeviceCombination );
+        /* The device may not have been probed yet if enumeration is lazy */
+        PA_ENSURE( UpdateDeviceInfo( hostApi, parameters->device ) );
         deviceInfo = GetDeviceInfo( hostApi, parameters->device );
     }
     else
@@ -1516,6 +2354,64 @@ error:
     return result;
 }
 
+static snd_pcm_format_t Pa2AlsaFormat( PaSampleFormat paFormat )
+{
+    switch( paFormat )
+    {
+#ifdef PA_LITTLE_ENDIAN
+        case paInt24In32 | paSwapEndian:
+            return SND_PCM_FORMAT_S24_BE;
+        case paInt16 | paSwapEndian:
+            return SND_PCM_FORMAT_S16_BE;
+        case paInt24 | paSwapEndian:
+            return SND_PCM_FORMAT_S24_3BE;
+        case paInt32 | paSwapEndian:
+            return SND_PCM_FORMAT_S32_BE;
+        case paFloat32 | paSwapEndian:
+            return SND_PCM_FORMAT_FLOAT_BE;
+#elif defined PA_BIG_ENDIAN
+        case paInt24In32 | paSwapEndian:
+            return SND_PCM_FORMAT_S24_LE;
+        case paInt16 | paSwapEndian:
+            return SND_PCM_FORMAT_S16_LE;
+        case paInt24 | paSwapEndian:
+            return SND_PCM_FORMAT_S24_3LE;
+        case paInt32 | paSwapEndian:
+            return SND_PCM_FORMAT_S32_LE;
+        case paFloat32 | paSwapEndian:
+            return SND_PCM_FORMAT_FLOAT_LE;
+#endif
+
+        case paInt24In32:
+            return SND_PCM_FORMAT_S24;
+
+        case paFloat32:
+            return SND_PCM_FORMAT_FLOAT;
+
+        case paInt16:
+            return SND_PCM_FORMAT_S16;
+
+        case paInt24:
+#ifdef PA_LITTLE_ENDIAN
+            return SND_PCM_FORMAT_S24_3LE;
+#elif defined PA_BIG_ENDIAN
+            return SND_PCM_FORMAT_S24_3BE;
+#endif
+
+        case paInt32:
+            return SND_PCM_FORMAT_S32;
+
+        case paInt8:
+            return SND_PCM_FORMAT_S8;
+
+        case paUInt8:
+            return SND_PCM_FORMAT_U8;
+
+        default:
+            return SND_PCM_FORMAT_UNKNOWN;
+    }
+}
+
 /* Given an open stream, what sample formats are available? */
 static PaSampleFormat GetAvailableFormats( snd_pcm_t *pcm )
 {
@@ -1548,9 +2444,87 @@ static PaSampleFormat GetAvailableFormats( snd_pcm_t *pcm )
     if( alsa_snd_pcm_hw_params_test_format( pcm, hwParams, SND_PCM_FORMAT_S8 ) >= 0)
         available |= paInt8;
 
+    /* 24 bits in a 32 bit word, handled by the buffer processor as a host-only format */
+    if( alsa_snd_pcm_hw_params_test_format( pcm, hwParams, SND_PCM_FORMAT_S24 ) >= 0)
+        available |= paInt24In32;
+
+    return available;
+}
+
+/** Get the formats this PCM supports in the opposite of the native byte order.
+ *
+ * @return Formats in terms of their native counterparts, combine with paSwapEndian to obtain the host format.
+ */
+static PaSampleFormat GetAvailableSwappedFormats( snd_pcm_t *pcm )
+{
+    PaSampleFormat available = 0;
+    snd_pcm_hw_params_t *hwParams;
+    alsa_snd_pcm_hw_params_alloca( &hwParams );
+
+    alsa_snd_pcm_hw_params_any( pcm, hwParams );
+
+    if( alsa_snd_pcm_hw_params_test_format( pcm, hwParams, Pa2AlsaFormat( paFloat32 | paSwapEndian ) ) >= 0)
+        available |= paFloat32;
+
+    if( alsa_snd_pcm_hw_params_test_format( pcm, hwParams, Pa2AlsaFormat( paInt32 | paSwapEndian ) ) >= 0)
+        available |= paInt32;
+
+    if( alsa_snd_pcm_hw_params_test_format( pcm, hwParams, Pa2AlsaFormat( paInt24In32 | paSwapEndian ) ) >= 0)
+        available |= paInt24In32;
+
+    if( alsa_snd_pcm_hw_params_test_format( pcm, hwParams, Pa2AlsaFormat( paInt24 | paSwapEndian ) ) >= 0)
+        available |= paInt24;
+
+    if( alsa_snd_pcm_hw_params_test_format( pcm, hwParams, Pa2AlsaFormat( paInt16 | paSwapEndian ) ) >= 0)
+        available |= paInt16;
+
     return available;
 }
 
+/** Select the host format to represent a user format with.
+ *
+ * The closest native format is preferred, unless it would lose resolution which 24 bits in a 32 bit word can keep.
+ * Failing any native format, the user format or paFloat32's nearest is tried in the opposite byte order. This way
+ * devices that only offer S24_LE or big endian formats can be driven as hw: with a single conversion pass, rather
+ * than requiring a plug device.
+ *
+ * @param available Formats as returned by GetAvailableFormats.
+ * @param swapped Formats as returned by GetAvailableSwappedFormats.
+ */
+static PaSampleFormat SelectHostFormatFrom( PaSampleFormat available, PaSampleFormat swapped, PaSampleFormat userFormat )
+{
+    PaSampleFormat format;
+    const PaSampleFormat highResolution = paFloat32 | paInt32 | paInt24;
+
+    userFormat &= ~paNonInterleaved;
+    format = PaUtil_SelectClosestAvailableFormat( available & ~paInt24In32, userFormat );
+
+    if( ( available & paInt24In32 ) && ( userFormat & ( highResolution | paInt16 ) ) &&
+            ( format == paSampleFormatNotSupported || ( ( userFormat & highResolution ) && !( format & highResolution ) ) ) )
+        return paInt24In32;
+    if( format != paSampleFormatNotSupported )
+        return format;
+
+    if( userFormat & swapped )
+        return userFormat | paSwapEndian;
+    if( paFloat32 == userFormat )
+    {
+        if( swapped & paInt32 )
+            return paInt32 | paSwapEndian;
+        if( swapped & paInt24In32 )
+            return paInt24In32 | paSwapEndian;
+        if( swapped & paInt16 )
+            return paInt16 | paSwapEndian;
+    }
+
+    return paSampleFormatNotSupported;
+}
+
+static PaSampleFormat SelectHostFormat( snd_pcm_t *pcm, PaSampleFormat userFormat )
+{
+    return SelectHostFormatFrom( GetAvailableFormats( pcm ), GetAvailableSwappedFormats( pcm ), userFormat );
+}
+
 /* Output to console all formats supported by device */
 static void LogAllAvailableFormats( snd_pcm_t *pcm )
 {
@@ -1673,37 +2647,6 @@ static void LogAllAvailableFormats( snd_pcm_t *pcm )
     PA_DEBUG(( " -------------------------\n" ));
 }
 
-static snd_pcm_format_t Pa2AlsaFormat( PaSampleFormat paFormat )
-{
-    switch( paFormat )
-    {
-        case paFloat32:
-            return SND_PCM_FORMAT_FLOAT;
-
-        case paInt16:
-            return SND_PCM_FORMAT_S16;
-
-        case paInt24:
-#ifdef PA_LITTLE_ENDIAN
-            return SND_PCM_FORMAT_S24_3LE;
-#elif defined PA_BIG_ENDIAN
-            return SND_PCM_FORMAT_S24_3BE;
-#endif
-
-        case paInt32:
-            return SND_PCM_FORMAT_S32;
-
-        case paInt8:
-            return SND_PCM_FORMAT_S8;
-
-        case paUInt8:
-            return SND_PCM_FORMAT_U8;
-
-        default:
-            return SND_PCM_FORMAT_UNKNOWN;
-    }
-}
-
 /** Open an ALSA pcm handle.
  *
  * The device to be open can be specified by name in a custom PaAlsaStreamInfo struct, or it will be by
@@ -1727,7 +2670,8 @@ static PaError AlsaOpen( const PaUtilHostApiRepresentation *hostApi, const PaStr
         deviceName = streamInfo->deviceString;
 
     PA_DEBUG(( "%s: Opening device %s\n", __FUNCTION__, deviceName ));
-    if( (ret = OpenPcm( pcm, deviceName, streamDir == StreamDirection_In ? SND_PCM_STREAM_CAPTURE : SND_PCM_STREAM_PLAYBACK,
+    if( (ret = OpenPcm( (const PaAlsaHostApiRepresentation *)hostApi, pcm, deviceName,
+                    streamDir == StreamDirection_In ? SND_PCM_STREAM_CAPTURE : SND_PCM_STREAM_PLAYBACK,
                     SND_PCM_NONBLOCK, 1 )) < 0 )
     {
         /* Not to be closed */
@@ -1743,29 +2687,185 @@ error:
     goto end;
 }
 
+/* Sample rates recorded in PaAlsaDeviceCapabilities, other rates are tested by opening the device */
+static const unsigned int standardRates_[] = { 8000, 11025, 16000, 22050, 32000, 44100, 48000, 88200, 96000,
+    176400, 192000, 352800, 384000 };
+#define PA_ALSA_NUM_STANDARD_RATES_ (sizeof (standardRates_) / sizeof (standardRates_[0]))
+
+/* Identify the current incarnation of a card through its control device node, which is created anew when the
+ * card is plugged in again. Plugin devices aren't tracked and always yield zeroes. */
+static void GetCardNodeIdentity( int card, ino_t *node, time_t *nodeTime )
+{
+    char path[32];
+    struct stat st;
+
+    *node = 0;
+    *nodeTime = 0;
+    if( card < 0 )
+        return;
+
+    snprintf( path, sizeof (path), "/dev/snd/controlC%d", card );
+    if( stat( path, &st ) == 0 )
+    {
+        *node = st.st_ino;
+        *nodeTime = st.st_ctime;
+    }
+}
+
+/** Record the capabilities of a device in one direction, from the device opened to test parameters.
+ *
+ * @param cardNode The identity of the card, taken before the device was opened. A card replugged in the meantime
+ * makes the record stale rather than wrong.
+ */
+static PaError RecordCapabilities( snd_pcm_t *pcm, const PaAlsaDeviceInfo *devInfo, StreamDirection streamDir,
+        ino_t cardNode, time_t cardNodeTime, PaAlsaDeviceCapabilities *caps )
+{
+    PaError result = paNoError;
+    snd_pcm_hw_params_t *hwParams;
+    size_t i;
+    alsa_snd_pcm_hw_params_alloca( &hwParams );
+
+    caps->valid = 0;
+    caps->cardNode = cardNode;
+    caps->cardNodeTime = cardNodeTime;
+    caps->numVerified = caps->nextVerified = 0;
+
+    caps->formats = GetAvailableFormats( pcm );
+    caps->swappedFormats = GetAvailableSwappedFormats( pcm );
+
+    ENSURE_( alsa_snd_pcm_hw_params_any( pcm, hwParams ), paUnanticipatedHostError );
+    ENSURE_( alsa_snd_pcm_hw_params_get_channels_min( hwParams, &caps->minChannels ), paUnanticipatedHostError );
+    ENSURE_( alsa_snd_pcm_hw_params_get_channels_max( hwParams, &caps->maxChannels ), paUnanticipatedHostError );
+
+    caps->rates = 0;
+    for( i = 0; i < PA_ALSA_NUM_STANDARD_RATES_; ++i )
+    {
+        alsa_snd_pcm_hw_params_any( pcm, hwParams );
+        if( SetApproximateSampleRate( pcm, hwParams, standardRates_[i] ) == paNoError )
+            caps->rates |= 1UL << i;
+    }
+
+    PA_DEBUG(( "%s: %s %s: channels %u-%u, formats 0x%lx (swapped 0x%lx), rates 0x%lx\n", __FUNCTION__,
+                devInfo->alsaName, StreamDirection_In == streamDir ? "capture" : "playback", caps->minChannels,
+                caps->maxChannels, caps->formats, caps->swappedFormats, caps->rates ));
+    caps->valid = 1;
+
+error:
+    return result;
+}
+
+/** Answer a test of parameters from the recorded capabilities of a device.
+ *
+ * Combinations tested on the device before are answered with the outcome of that test. Otherwise the capabilities,
+ * which are ranges over all configurations of the device, can only tell for sure that a combination is
+ * unsupported. The record is dropped if the card has been replugged.
+ *
+ * @param result The outcome of the test, if answered.
+ * @return Nonzero if the test could be answered.
+ */
+static int LookUpCapabilities( const PaAlsaDeviceInfo *devInfo, PaAlsaDeviceCapabilities *caps,
+        unsigned int numHostChannels, double sampleRate, PaSampleFormat sampleFormat, PaError *result )
+{
+    ino_t node;
+    time_t nodeTime;
+    size_t i;
+
+    if( !caps->valid )
+        return 0;
+
+    GetCardNodeIdentity( devInfo->card, &node, &nodeTime );
+    if( node != caps->cardNode || nodeTime != caps->cardNodeTime )
+    {
+        PA_DEBUG(( "%s: Card of %s was replugged, capabilities are stale\n", __FUNCTION__, devInfo->alsaName ));
+        caps->valid = 0;
+        return 0;
+    }
+
+    for( i = 0; i < caps->numVerified; ++i )
+    {
+        const PaAlsaVerifiedParameters *verified = &caps->verified[i];
+        if( verified->sampleRate == sampleRate && verified->numHostChannels == numHostChannels &&
+                verified->sampleFormat == sampleFormat )
+        {
+            *result = verified->result;
+            return 1;
+        }
+    }
+
+    for( i = 0; i < PA_ALSA_NUM_STANDARD_RATES_ && standardRates_[i] != sampleRate; ++i )
+        ;
+    /* Only the standard rates are recorded */
+    if( i < PA_ALSA_NUM_STANDARD_RATES_ && !( caps->rates & ( 1UL << i ) ) )
+        *result = paInvalidSampleRate;
+    else if( numHostChannels < caps->minChannels || numHostChannels > caps->maxChannels )
+        *result = paInvalidChannelCount;
+    else if( SelectHostFormatFrom( caps->formats, caps->swappedFormats, sampleFormat ) ==
+            paSampleFormatNotSupported )
+        *result = paSampleFormatNotSupported;
+    else
+        return 0;
+
+    return 1;
+}
+
+/* Remember the outcome of testing parameters on the device, unless it depends on the moment, e.g. the device being
+ * busy */
+static void RememberVerifiedParameters( PaAlsaDeviceCapabilities *caps, unsigned int numHostChannels,
+        double sampleRate, PaSampleFormat sampleFormat, PaError result )
+{
+    PaAlsaVerifiedParameters *verified;
+
+    if( result != paNoError && result != paInvalidSampleRate && result != paInvalidChannelCount &&
+            result != paSampleFormatNotSupported && result != paBadIODeviceCombination )
+        return;
+
+    verified = &caps->verified[caps->nextVerified];
+    verified->sampleRate = sampleRate;
+    verified->numHostChannels = numHostChannels;
+    verified->sampleFormat = sampleFormat;
+    verified->result = result;
+    caps->nextVerified = (caps->nextVerified + 1) % PA_ALSA_NUM_VERIFIED_;
+    if( caps->numVerified < PA_ALSA_NUM_VERIFIED_ )
+        ++caps->numVerified;
+}
+
 static PaError TestParameters( const PaUtilHostApiRepresentation *hostApi, const PaStreamParameters *parameters,
         double sampleRate, StreamDirection streamDir )
 {
     PaError result = paNoError;
     snd_pcm_t *pcm = NULL;
-    PaSampleFormat availableFormats;
     /* We are able to adapt to a number of channels less than what the device supports */
     unsigned int numHostChannels;
     PaSampleFormat hostFormat;
     snd_pcm_hw_params_t *hwParams;
+    PaAlsaDeviceInfo *devInfo = NULL;
+    PaAlsaDeviceCapabilities *caps = NULL;
+    ino_t cardNode = 0;
+    time_t cardNodeTime = 0;
     alsa_snd_pcm_hw_params_alloca( &hwParams );
 
     if( !parameters->hostApiSpecificStreamInfo )
     {
-        const PaAlsaDeviceInfo *devInfo = GetDeviceInfo( hostApi, parameters->device );
+        devInfo = (PaAlsaDeviceInfo *)hostApi->deviceInfos[parameters->device];
+        caps = &devInfo->capabilities[streamDir];
         numHostChannels = PA_MAX( parameters->channelCount, StreamDirection_In == streamDir ?
                 devInfo->minInputChannels : devInfo->minOutputChannels );
+
+        /* Answered from memory where possible, opening devices is slow and may block if they're busy */
+        if( LookUpCapabilities( devInfo, caps, numHostChannels, sampleRate, parameters->sampleFormat, &result ) )
+            return result;
+        GetCardNodeIdentity( devInfo->card, &cardNode, &cardNodeTime );
     }
     else
         numHostChannels = parameters->channelCount;
 
     PA_ENSURE( AlsaOpen( hostApi, parameters, streamDir, &pcm ) );
 
+    /* The capabilities are recorded while the device is open anyway */
+    if( caps && !caps->valid && RecordCapabilities( pcm, devInfo, streamDir, cardNode, cardNodeTime, caps )
+            != paNoError )
+        PA_DEBUG(( "%s: Failed recording capabilities of %s\n", __FUNCTION__, devInfo->alsaName ));
+
     alsa_snd_pcm_hw_params_any( pcm, hwParams );
 
     if( SetApproximateSampleRate( pcm, hwParams, sampleRate ) < 0 )
@@ -1781,8 +2881,7 @@ static PaError TestParameters( const PaUtilHostApiRepresentation *hostApi, const
     }
 
     /* See if we can find a best possible match */
-    availableFormats = GetAvailableFormats( pcm );
-    PA_ENSURE( hostFormat = PaUtil_SelectClosestAvailableFormat( availableFormats, parameters->sampleFormat ) );
+    PA_ENSURE( hostFormat = SelectHostFormat( pcm, parameters->sampleFormat ) );
 
     /* Some specific hardware (reported: Audio8 DJ) can fail with assertion during this step. */
     ENSURE_( alsa_snd_pcm_hw_params_set_format( pcm, hwParams, Pa2AlsaFormat( hostFormat ) ), paUnanticipatedHostError );
@@ -1815,6 +2914,8 @@ static PaError TestParameters( const PaUtilHostApiRepresentation *hostApi, const
 end:
     if( pcm )
     {
+        if( caps && caps->valid )
+            RememberVerifiedParameters( caps, numHostChannels, sampleRate, parameters->sampleFormat, result );
         alsa_snd_pcm_close( pcm );
     }
     return result;
@@ -1902,7 +3003,7 @@ static PaError PaAlsaStreamComponent_Initialize( PaAlsaStreamComponent *self, Pa
     PA_ENSURE( AlsaOpen( &alsaApi->baseHostApiRep, params, streamDir, &self->pcm ) );
     self->nfds = alsa_snd_pcm_poll_descriptors_count( self->pcm );
 
-    PA_ENSURE( hostSampleFormat = PaUtil_SelectClosestAvailableFormat( GetAvailableFormats( self->pcm ), userSampleFormat ) );
+    PA_ENSURE( hostSampleFormat = SelectHostFormat( self->pcm, userSampleFormat ) );
 
     self->hostSampleFormat = hostSampleFormat;
     self->nativeFormat = Pa2AlsaFormat( hostSampleFormat );
@@ -1912,6 +3013,9 @@ static PaError PaAlsaStreamComponent_Initialize( PaAlsaStreamComponent *self, Pa
     self->canMmap = 0;
     self->nonMmapBuffer = NULL;
     self->nonMmapBufferSize = 0;
+    /* Candidate for zero-copy operation, confirmed once the access mode is known */
+    self->zeroCopy = callbackMode && hostSampleFormat == ( userSampleFormat & ~paNonInterleaved ) &&
+        self->numHostChannels == self->numUserChannels;
 
     if( !callbackMode && !self->userInterleaved )
     {
@@ -2030,6 +3134,7 @@ static PaError PaAlsaStreamComponent_InitialConfigure( PaAlsaStreamComponent *se
         /* Flip mode */
         self->hostInterleaved = !self->userInterleaved;
     }
+    self->zeroCopy = self->zeroCopy && self->canMmap && self->hostInterleaved == self->userInterleaved;
 
     /* Some specific hardware (reported: Audio8 DJ) can fail with assertion during this step. */
     ENSURE_( alsa_snd_pcm_hw_params_set_format( pcm, hwParams, self->nativeFormat ), paUnanticipatedHostError );
@@ -2060,6 +3165,27 @@ error:
     goto end;
 }
 
+/** Align value in backward direction.
+ *
+ * @param v: Value to align.
+ * @param align: Alignment.
+ */
+static unsigned long PaAlsa_AlignBackward(unsigned long v, unsigned long align)
+{
+    return ( v - ( align ? v % align : 0 ) );
+}
+
+/** Align value in forward direction.
+ *
+ * @param v: Value to align.
+ * @param align: Alignment.
+ */
+static unsigned long PaAlsa_AlignForward(unsigned long v, unsigned long align)
+{
+    unsigned long remainder = ( align ? ( v % align ) : 0);
+    return ( remainder != 0 ? v + ( align - remainder ) : v );
+}
+
 /** Finish the configuration of the component's ALSA device.
  *
  * As part of this method, the component's alsaBufferSize attribute will be set.
@@ -2076,7 +3202,16 @@ static PaError PaAlsaStreamComponent_FinishConfigure( PaAlsaStreamComponent *sel
     alsa_snd_pcm_sw_params_alloca( &swParams );
 
     bufSz = params->suggestedLatency * sampleRate + self->framesPerPeriod;
-    ENSURE_( alsa_snd_pcm_hw_params_set_buffer_size_near( self->pcm, hwParams, &bufSz ), paUnanticipatedHostError );
+    if( self->zeroCopy )
+    {
+        /* A whole number of periods keeps every period contiguous in the mmap area, so host buffers are never split
+         * at the wrap-around and can be handed to the callback as they are */
+        bufSz = PaAlsa_AlignForward( bufSz, self->framesPerPeriod );
+        if( alsa_snd_pcm_hw_params_set_buffer_size( self->pcm, hwParams, bufSz ) < 0 )
+            ENSURE_( alsa_snd_pcm_hw_params_set_buffer_size_near( self->pcm, hwParams, &bufSz ), paUnanticipatedHostError );
+    }
+    else
+        ENSURE_( alsa_snd_pcm_hw_params_set_buffer_size_near( self->pcm, hwParams, &bufSz ), paUnanticipatedHostError );
 
     /* Set the parameters! */
     {
@@ -2103,10 +3238,22 @@ static PaError PaAlsaStreamComponent_FinishConfigure( PaAlsaStreamComponent *sel
     /* Latency in seconds */
     *latency = (self->alsaBufferSize - self->framesPerPeriod) / sampleRate;
 
+    if( self->zeroCopy && self->alsaBufferSize % self->framesPerPeriod != 0 )
+    {
+        /* Still works without copying, but host buffers may arrive split in two */
+        PA_DEBUG(( "%s: Buffer size %lu is not a multiple of the period size %lu\n", __FUNCTION__, self->alsaBufferSize,
+                    self->framesPerPeriod ));
+    }
+    PA_DEBUG(( "%s: Zero-copy %s: %s\n", __FUNCTION__, StreamDirection_In == self->streamDir ? "capture" : "playback",
+                self->zeroCopy ? "YES" : "NO" ));
+
     /* Now software parameters... */
     ENSURE_( alsa_snd_pcm_sw_params_current( self->pcm, swParams ), paUnanticipatedHostError );
 
-    ENSURE_( alsa_snd_pcm_sw_params_set_start_threshold( self->pcm, swParams, self->framesPerPeriod ), paUnanticipatedHostError );
+    /* A primed playback pcm is started explicitly once the callback has filled the buffer, it must not start on
+     * its own after the first period has been written */
+    ENSURE_( alsa_snd_pcm_sw_params_set_start_threshold( self->pcm, swParams, primeBuffers && StreamDirection_Out ==
+                self->streamDir ? self->alsaBufferSize : self->framesPerPeriod ), paUnanticipatedHostError );
     ENSURE_( alsa_snd_pcm_sw_params_set_stop_threshold( self->pcm, swParams, self->alsaBufferSize ), paUnanticipatedHostError );
 
     /* Silence buffer in the case of underrun */
@@ -2122,6 +3269,15 @@ static PaError PaAlsaStreamComponent_FinishConfigure( PaAlsaStreamComponent *sel
     ENSURE_( alsa_snd_pcm_sw_params_set_xfer_align( self->pcm, swParams, 1 ), paUnanticipatedHostError );
     ENSURE_( alsa_snd_pcm_sw_params_set_tstamp_mode( self->pcm, swParams, SND_PCM_TSTAMP_ENABLE ), paUnanticipatedHostError );
 
+    /* Timestamps are taken from the realtime clock by default, which may be stepped */
+    self->monotonicTstamps = 0;
+#ifdef PA_ALSA_HAVE_TSTAMP_TYPE
+    if( alsa_snd_pcm_sw_params_set_tstamp_type &&
+            alsa_snd_pcm_sw_params_set_tstamp_type( self->pcm, swParams, SND_PCM_TSTAMP_TYPE_MONOTONIC ) >= 0 )
+        self->monotonicTstamps = 1;
+#endif
+    PA_DEBUG(( "%s: Using %s timestamps\n", __FUNCTION__, self->monotonicTstamps ? "monotonic" : "realtime" ));
+
     /* Set the parameters! */
     ENSURE_( alsa_snd_pcm_sw_params( self->pcm, swParams ), paUnanticipatedHostError );
 
@@ -2137,6 +3293,7 @@ static PaError PaAlsaStream_Initialize( PaAlsaStream *self, PaAlsaHostApiReprese
     assert( self );
 
     memset( self, 0, sizeof( PaAlsaStream ) );
+    self->epollFd = self->wakeFd = self->readyFd = -1;
 
     if( NULL != callback )
     {
@@ -2154,11 +3311,9 @@ static PaError PaAlsaStream_Initialize( PaAlsaStream *self, PaAlsaHostApiReprese
 
     self->framesPerUserBuffer = framesPerUserBuffer;
     self->neverDropInput = streamFlags & paNeverDropInput;
-    /* XXX: Ignore paPrimeOutputBuffersUsingStreamCallback untill buffer priming is fully supported in pa_process.c */
-    /*
-    if( outParams & streamFlags & paPrimeOutputBuffersUsingStreamCallback )
+    /* Priming fills the output buffer from the callback rather than with silence, it has no meaning otherwise */
+    if( outParams && callback && (streamFlags & paPrimeOutputBuffersUsingStreamCallback) )
         self->primeBuffers = 1;
-        */
     memset( &self->capture, 0, sizeof (PaAlsaStreamComponent) );
     memset( &self->playback, 0, sizeof (PaAlsaStreamComponent) );
     if( inParams )
@@ -2177,11 +3332,86 @@ static PaError PaAlsaStream_Initialize( PaAlsaStream *self, PaAlsaHostApiReprese
 
     PaUtil_InitializeCpuLoadMeasurer( &self->cpuLoadMeasurer, sampleRate );
     ASSERT_CALL_( PaUnixMutex_Initialize( &self->stateMtx ), paNoError );
+    ASSERT_CALL_( sem_init( &self->releaseSem, 0, 0 ), 0 );
+
+error:
+    return result;
+}
+
+/* Marks the wake-up eventfd in the epoll set, as opposed to an index into the stream's pollfds */
+#define PA_ALSA_WAKE_EVENT_ ((uint32_t)-1)
+
+/* How much of its stack a prepared callback thread touches before it is parked */
+#define PA_ALSA_PREFAULT_STACK_ (32 * 1024)
+
+static PaError PaAlsaStreamComponent_RegisterEpoll( PaAlsaStreamComponent *self, int epollFd, struct pollfd *pfds,
+        uint32_t firstIndex )
+{
+    PaError result = paNoError;
+    struct epoll_event ev;
+    unsigned int i;
+
+    if( !self->pcm )
+        return result;
+
+    PA_UNLESS( alsa_snd_pcm_poll_descriptors( self->pcm, pfds, self->nfds ) == self->nfds, paInternalError );
+    for( i = 0; i < self->nfds; ++i )
+    {
+        memset( &ev, 0, sizeof (ev) );
+        ev.events = pfds[i].events;     /* The poll and epoll event flags coincide */
+        ev.data.u32 = firstIndex + i;
+        PA_UNLESS( epoll_ctl( epollFd, EPOLL_CTL_ADD, pfds[i].fd, &ev ) == 0, paInternalError );
+    }
+    self->epollArmed = 1;
 
 error:
     return result;
 }
 
+/** Set up the persistent epoll set for waiting on the PCMs.
+ *
+ * The PCMs' descriptors do not change once these are configured, so they are registered once and for all. An
+ * eventfd is added as well, by which stopping the stream wakes the callback thread immediately. If any of this
+ * fails the stream falls back to poll().
+ */
+static void PaAlsaStream_InitializeEpoll( PaAlsaStream *self )
+{
+    PaError result = paNoError;
+    struct epoll_event ev;
+
+    PA_UNLESS( (self->epollFd = epoll_create1( EPOLL_CLOEXEC )) >= 0, paInternalError );
+    PA_UNLESS( (self->wakeFd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC )) >= 0, paInternalError );
+
+    memset( &ev, 0, sizeof (ev) );
+    ev.events = EPOLLIN;
+    ev.data.u32 = PA_ALSA_WAKE_EVENT_;
+    PA_UNLESS( epoll_ctl( self->epollFd, EPOLL_CTL_ADD, self->wakeFd, &ev ) == 0, paInternalError );
+
+    /* Capture descriptors come first in pfds, followed by the playback descriptors */
+    PA_ENSURE( PaAlsaStreamComponent_RegisterEpoll( &self->capture, self->epollFd, self->pfds, 0 ) );
+    PA_ENSURE( PaAlsaStreamComponent_RegisterEpoll( &self->playback, self->epollFd, self->pfds + self->capture.nfds,
+                self->capture.nfds ) );
+
+    return;
+
+error:
+    PA_DEBUG(( "%s: Failed setting up epoll (%s), falling back to poll\n", __FUNCTION__, strerror( errno ) ));
+    if( self->epollFd >= 0 )
+        close( self->epollFd );
+    if( self->wakeFd >= 0 )
+        close( self->wakeFd );
+    self->epollFd = self->wakeFd = -1;
+    (void)result;
+}
+
+/** Wake the callback thread if it is waiting in PaAlsaStream_WaitForFrames. */
+static void PaAlsaStream_Wake( PaAlsaStream *self )
+{
+    uint64_t one = 1;
+    if( self->wakeFd >= 0 && write( self->wakeFd, &one, sizeof (one) ) < 0 )
+        PA_DEBUG(( "%s: Failed signalling eventfd\n", __FUNCTION__ ));
+}
+
 /** Free resources associated with stream, and eventually stream itself.
  *
  * Frees allocated memory, and terminates individual StreamComponents.
@@ -2199,8 +3429,15 @@ static void PaAlsaStream_Terminate( PaAlsaStream *self )
         PaAlsaStreamComponent_Terminate( &self->playback );
     }
 
+    if( self->epollFd >= 0 )
+        close( self->epollFd );
+    if( self->wakeFd >= 0 )
+        close( self->wakeFd );
+    if( self->readyFd >= 0 )
+        close( self->readyFd );
     PaUtil_FreeMemory( self->pfds );
     ASSERT_CALL_( PaUnixMutex_Terminate( &self->stateMtx ), paNoError );
+    ASSERT_CALL_( sem_destroy( &self->releaseSem ), 0 );
 
     PaUtil_FreeMemory( self );
 }
@@ -2217,41 +3454,20 @@ static int CalculatePollTimeout( const PaAlsaStream *stream, unsigned long frame
     return (int)ceil( 1000 * frames / stream->streamRepresentation.streamInfo.sampleRate );
 }
 
-/** Align value in backward direction.
+/** Get size of host buffer maintained from the number of user frames, sample rate and suggested latency. Minimum double buffering
+ *  is maintained to allow 100% CPU usage inside user callback.
  *
- * @param v: Value to align.
- * @param align: Alignment.
+ * @param userFramesPerBuffer: User buffer size in number of frames.
+ * @param suggestedLatency: User provided desired latency.
+ * @param sampleRate: Sample rate.
  */
-static unsigned long PaAlsa_AlignBackward(unsigned long v, unsigned long align)
+static unsigned long PaAlsa_GetFramesPerHostBuffer(unsigned long userFramesPerBuffer, PaTime suggestedLatency, double sampleRate)
 {
-    return ( v - ( align ? v % align : 0 ) );
+    unsigned long frames = userFramesPerBuffer + PA_MAX( userFramesPerBuffer, (unsigned long)( suggestedLatency * sampleRate ) );
+    return frames;
 }
 
-/** Align value in forward direction.
- *
- * @param v: Value to align.
- * @param align: Alignment.
- */
-static unsigned long PaAlsa_AlignForward(unsigned long v, unsigned long align)
-{
-    unsigned long remainder = ( align ? ( v % align ) : 0);
-    return ( remainder != 0 ? v + ( align - remainder ) : v );
-}
-
-/** Get size of host buffer maintained from the number of user frames, sample rate and suggested latency. Minimum double buffering
- *  is maintained to allow 100% CPU usage inside user callback.
- *
- * @param userFramesPerBuffer: User buffer size in number of frames.
- * @param suggestedLatency: User provided desired latency.
- * @param sampleRate: Sample rate.
- */
-static unsigned long PaAlsa_GetFramesPerHostBuffer(unsigned long userFramesPerBuffer, PaTime suggestedLatency, double sampleRate)
-{
-    unsigned long frames = userFramesPerBuffer + PA_MAX( userFramesPerBuffer, (unsigned long)( suggestedLatency * sampleRate ) );
-    return frames;
-}
-
-/** Determine size per host buffer.
+/** Determine size per host buffer.
  *
  * During this method call, the component's framesPerPeriod attribute gets computed, and the corresponding period size
  * gets configured for the device.
@@ -2682,7 +3898,11 @@ static PaError PaAlsaStream_DetermineFramesPerBuffer( PaAlsaStream* self, double
     PA_UNLESS( framesPerHostBuffer != 0, paInternalError );
     self->maxFramesPerHostBuffer = framesPerHostBuffer;
 
-    if( !self->playback.canMmap || !accurate )
+    /* Host buffers have a fixed size if the period size is exact and periods are handed out whole, as mmap playback
+     * does. So does a zero-copy capture-only stream, its buffer holds a whole number of periods (checked once the
+     * buffer size is known, in PaAlsaStream_Configure). Full-duplex streams whose periods differ are bounded above,
+     * and unless the user buffer size is unspecified the buffer processor then copies even for zero-copy components */
+    if( !accurate || !( self->playback.canMmap || ( !self->playback.pcm && self->capture.zeroCopy ) ) )
     {
         /* Don't know the exact size per host buffer */
         *hostBufferSizeMode = paUtilBoundedHostBufferSize;
@@ -2725,6 +3945,13 @@ static PaError PaAlsaStream_Configure( PaAlsaStream *self, const PaStreamParamet
         PA_ENSURE( PaAlsaStreamComponent_FinishConfigure( &self->capture, hwParamsCapture, inParams, self->primeBuffers, realSr,
                     inputLatency ) );
         PA_DEBUG(( "%s: Capture period size: %lu, latency: %f\n", __FUNCTION__, self->capture.framesPerPeriod, *inputLatency ));
+
+        if( !self->playback.pcm && paUtilFixedHostBufferSize == *hostBufferSizeMode &&
+                self->capture.alsaBufferSize % self->capture.framesPerPeriod != 0 )
+        {
+            /* Periods may be split at the wrap-around of the mmap area */
+            *hostBufferSizeMode = paUtilBoundedHostBufferSize;
+        }
     }
     if( self->playback.pcm )
     {
@@ -2748,6 +3975,13 @@ static PaError PaAlsaStream_Configure( PaAlsaStream *self, const PaStreamParamet
             self->pcmsSynced = 1;
         else
             PA_DEBUG(( "%s: Unable to sync pcms: %s\n", __FUNCTION__, alsa_snd_strerror( err ) ));
+
+        /* Linked pcms are driven by the same trigger, with equal periods playback space becomes available as
+         * capture data does, so there is no need to be woken by both. PA_ALSA_LINKED_WAIT=0 turns this off */
+        if( self->pcmsSynced && self->capture.framesPerPeriod == self->playback.framesPerPeriod &&
+                !( getenv( "PA_ALSA_LINKED_WAIT" ) && !atoi( getenv( "PA_ALSA_LINKED_WAIT" ) ) ) )
+            self->linkedWait = 1;
+        PA_DEBUG(( "%s: Waiting on capture alone: %s\n", __FUNCTION__, self->linkedWait ? "YES" : "NO" ));
     }
 
     {
@@ -2836,6 +4070,7 @@ static PaError OpenStream( struct PaUtilHostApiRepresentation *hostApi,
 
     PA_ENSURE( PaAlsaStream_Configure( stream, inputParameters, outputParameters, sampleRate, framesPerBuffer,
                 &inputLatency, &outputLatency, &hostBufferSizeMode ) );
+    PaAlsaStream_InitializeEpoll( stream );
     hostInputSampleFormat = stream->capture.hostSampleFormat | (!stream->capture.hostInterleaved ? paNonInterleaved : 0);
     hostOutputSampleFormat = stream->playback.hostSampleFormat | (!stream->playback.hostInterleaved ? paNonInterleaved : 0);
 
@@ -2874,6 +4109,10 @@ static PaError CloseStream( PaStream* s )
     PaError result = paNoError;
     PaAlsaStream *stream = (PaAlsaStream*)s;
 
+    /* A prepared stream counts as stopped, but still has its pcms readied and maybe a thread */
+    if( stream->isPrepared )
+        AbortStream( stream );
+
     PaUtil_TerminateBufferProcessor( &stream->bufferProcessor );
     PaUtil_TerminateStreamRepresentation( &stream->streamRepresentation );
 
@@ -2882,6 +4121,69 @@ static PaError CloseStream( PaStream* s )
     return result;
 }
 
+/* Stream time is kept on the monotonic clock, which unlike the realtime clock is never stepped */
+static PaTime GetMonotonicTime( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + (PaTime)ts.tv_nsec / 1e9;
+}
+
+static PaTime GetRealtimeTime( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_REALTIME, &ts );
+    return ts.tv_sec + (PaTime)ts.tv_nsec / 1e9;
+}
+
+/* Bandwidth of the time DLL in Hz, low enough to filter out interrupt jitter yet quick to settle */
+#define PA_ALSA_TIME_DLL_BANDWIDTH_ 0.5
+
+static void PaAlsaTimeDll_Update( PaAlsaTimeDll *self, long long position, PaTime time, double sampleRate )
+{
+    long long elapsed = position - self->position;
+    PaTime predicted, error;
+    double omega;
+
+    if( self->valid && elapsed <= 0 )
+        return;     /* Nothing new */
+
+    predicted = self->time + elapsed * self->secondsPerFrame;
+    error = time - predicted;
+
+    /* (Re)initialize on the first measurement and when the estimate has gone off by more than 50 ms, in which
+     * case the stream was presumably stalled */
+    if( !self->valid || fabs( error ) > 0.05 )
+    {
+        self->valid = 1;
+        self->position = position;
+        self->time = time;
+        self->secondsPerFrame = self->nominalSecondsPerFrame = 1. / sampleRate;
+        return;
+    }
+
+    /* Second order loop, with coefficients scaled to the time elapsed since the previous update */
+    omega = PA_MIN( 2 * 3.14159265358979 * PA_ALSA_TIME_DLL_BANDWIDTH_ * elapsed * self->nominalSecondsPerFrame, 0.5 );
+    self->time = predicted + sqrt( 2 ) * omega * error;
+    self->secondsPerFrame += omega * omega * error / elapsed;
+    self->position = position;
+
+    /* Don't let the rate estimate wander off on account of a bad measurement */
+    self->secondsPerFrame = PA_MAX( PA_MIN( self->secondsPerFrame, self->nominalSecondsPerFrame * 1.01 ),
+            self->nominalSecondsPerFrame * 0.99 );
+}
+
+static PaTime PaAlsaTimeDll_TimeAt( const PaAlsaTimeDll *self, long long position )
+{
+    return self->time + ( position - self->position ) * self->secondsPerFrame;
+}
+
+static void PaAlsaStreamComponent_ResetTiming( PaAlsaStreamComponent *self )
+{
+    self->framesTransferred = 0;
+    self->timeDll.valid = 0;
+}
+
 static void SilenceBuffer( PaAlsaStream *stream )
 {
     const snd_pcm_channel_area_t *areas;
@@ -2905,6 +4207,12 @@ static PaError AlsaStart( PaAlsaStream *stream, int priming )
 {
     PaError result = paNoError;
 
+    /* Positions restart at zero, the time base has to be established anew. Primed output has already been counted
+     * from zero by PaAlsaStream_PrimeOutput */
+    PaAlsaStreamComponent_ResetTiming( &stream->capture );
+    if( !priming )
+        PaAlsaStreamComponent_ResetTiming( &stream->playback );
+
     if( stream->playback.pcm )
     {
         if( stream->callbackMode )
@@ -2915,9 +4223,14 @@ static PaError AlsaStart( PaAlsaStream *stream, int priming )
                 ENSURE_( alsa_snd_pcm_prepare( stream->playback.pcm ), paUnanticipatedHostError );
                 if( stream->playback.canMmap )
                     SilenceBuffer( stream );
+                if( stream->playback.canMmap && !stream->deferTrigger )
+                    ENSURE_( alsa_snd_pcm_start( stream->playback.pcm ), paUnanticipatedHostError );
             }
-            if( stream->playback.canMmap )
+            else if( SND_PCM_STATE_PREPARED == alsa_snd_pcm_state( stream->playback.pcm ) && !stream->deferTrigger )
+            {
+                /* The primed buffer holds real output, start playing it regardless of the access mode */
                 ENSURE_( alsa_snd_pcm_start( stream->playback.pcm ), paUnanticipatedHostError );
+            }
         }
         else
             ENSURE_( alsa_snd_pcm_prepare( stream->playback.pcm ), paUnanticipatedHostError );
@@ -2926,7 +4239,8 @@ static PaError AlsaStart( PaAlsaStream *stream, int priming )
     {
         ENSURE_( alsa_snd_pcm_prepare( stream->capture.pcm ), paUnanticipatedHostError );
         /* For a blocking stream we want to start capture as well, since nothing will happen otherwise */
-        ENSURE_( alsa_snd_pcm_start( stream->capture.pcm ), paUnanticipatedHostError );
+        if( !stream->deferTrigger )
+            ENSURE_( alsa_snd_pcm_start( stream->capture.pcm ), paUnanticipatedHostError );
     }
 
 end:
@@ -2976,26 +4290,95 @@ error:
 }
 #endif
 
+/* Whether AlsaStart leaves playback to be started by the first write, rather than starting it itself */
+static int PaAlsaStream_PlaybackStartsOnWrite( PaAlsaStream *self )
+{
+    return self->playback.pcm && !( self->callbackMode && ( self->playback.canMmap || self->primeBuffers ) );
+}
+
+/* Start what AlsaStart left of a stream readied with deferTrigger, pcms started through a link are running already */
+static PaError PaAlsaStream_Trigger( PaAlsaStream *self )
+{
+    PaError result = paNoError;
+
+    if( self->playback.pcm && !PaAlsaStream_PlaybackStartsOnWrite( self ) &&
+            SND_PCM_STATE_PREPARED == alsa_snd_pcm_state( self->playback.pcm ) )
+        ENSURE_( alsa_snd_pcm_start( self->playback.pcm ), paUnanticipatedHostError );
+    if( self->capture.pcm && SND_PCM_STATE_PREPARED == alsa_snd_pcm_state( self->capture.pcm ) )
+        ENSURE_( alsa_snd_pcm_start( self->capture.pcm ), paUnanticipatedHostError );
+
+error:
+    return result;
+}
+
+/* Sleep until a blocking stream's start is close enough for its buffers to span the rest of the time. Output needs
+ * room for a period beyond the silence that leads up to the start, input is started a little early */
+static void PaAlsaStream_SleepUntilStart( PaAlsaStream *self, PaTime when )
+{
+    double sampleRate = self->streamRepresentation.streamInfo.sampleRate;
+    PaTime lead = self->playback.pcm ?
+        (self->playback.alsaBufferSize - self->playback.framesPerPeriod) / sampleRate : 0.01;
+    PaTime remaining;
+
+    while( (remaining = when - lead - GetMonotonicTime()) > 0. )
+        Pa_Sleep( remaining > 1. ? 1000 : (long)(remaining * 1000.) + 1 );
+}
+
 static PaError StartStream( PaStream *s )
+{
+    return StartStreamAt( s, 0. );
+}
+
+/* A callback stream has the buffer processor output silence until when, a blocking stream is aligned on when by
+ * PaAlsaStream_AlignStart. when is 0 for an immediate start.
+ *
+ * If the stream has been prepared the pcms only need to be started, and the parked callback thread released */
+static PaError StartStreamAt( PaStream *s, PaTime when )
 {
     PaError result = paNoError;
     PaAlsaStream* stream = (PaAlsaStream*)s;
     int streamStarted = 0;  /* So we can know whether we need to take the stream down */
+    int prepared = stream->isPrepared;
 
     /* Ready the processor */
-    PaUtil_ResetBufferProcessor( &stream->bufferProcessor );
+    if( !prepared )
+    {
+        PaUtil_ResetBufferProcessor( &stream->bufferProcessor );
+        stream->captureSkipFrames = 0;
+    }
 
     /* Set now, so we can test for activity further down */
     stream->isActive = 1;
 
     if( stream->callbackMode )
     {
-        PA_ENSURE( PaUnixThread_New( &stream->thread, &CallbackThreadFunc, stream, 1., stream->rtSched ) );
+        if( when > 0. )
+            PaUtil_SetBufferProcessorStartTime( &stream->bufferProcessor, when );
+        if( prepared )
+        {
+            streamStarted = 1;
+            if( !stream->deferTrigger )
+                PA_ENSURE( PaAlsaStream_Trigger( stream ) );
+            stream->isPrepared = 0;
+            ASSERT_CALL_( sem_post( &stream->releaseSem ), 0 );
+        }
+        else
+            PA_ENSURE( PaUnixThread_New( &stream->thread, &CallbackThreadFunc, stream, 1., stream->rtSched ) );
     }
     else
     {
-        PA_ENSURE( AlsaStart( stream, 0 ) );
+        if( when > 0. )
+            PaAlsaStream_SleepUntilStart( stream, when );
+        if( prepared )
+        {
+            stream->isPrepared = 0;
+            PA_ENSURE( PaAlsaStream_Trigger( stream ) );
+        }
+        else
+            PA_ENSURE( AlsaStart( stream, 0 ) );
         streamStarted = 1;
+        if( when > 0. )
+            PA_ENSURE( PaAlsaStream_AlignStart( stream, when ) );
     }
 
 end:
@@ -3010,6 +4393,61 @@ error:
     goto end;
 }
 
+/* Touch the stack a callback thread is going to use, so that it doesn't fault in pages once started */
+static void PaAlsa_PrefaultStack( void )
+{
+    volatile char stack[PA_ALSA_PREFAULT_STACK_];
+    size_t i;
+
+    for( i = 0; i < sizeof (stack); i += 4096 )
+        stack[i] = 0;
+}
+
+/* Do the work of starting a stream ahead of StartStreamAt: the pcms are prepared, and for a callback stream the
+ * thread is created, fills playback with silence or primes it, and is parked. The buffers, including the buffer
+ * processor's temp buffers, are touched along the way. The stream remains stopped meanwhile */
+static PaError PrepareStream( PaStream *s )
+{
+    PaError result = paNoError;
+    PaAlsaStream* stream = (PaAlsaStream*)s;
+    PaUtilBufferProcessor *bp = &stream->bufferProcessor;
+
+    if( stream->isPrepared )
+        goto end;
+
+    PaUtil_ResetBufferProcessor( &stream->bufferProcessor );
+    stream->captureSkipFrames = 0;
+    /* The reset only clears the temp buffers when it primes them */
+    if( bp->tempInputBuffer )
+        memset( bp->tempInputBuffer, 0, bp->framesPerTempBuffer * bp->bytesPerUserInputSample *
+                bp->inputChannelCount );
+    if( bp->tempOutputBuffer )
+        memset( bp->tempOutputBuffer, 0, bp->framesPerTempBuffer * bp->bytesPerUserOutputSample *
+                bp->outputChannelCount );
+    if( stream->capture.nonMmapBuffer )
+        memset( stream->capture.nonMmapBuffer, 0, stream->capture.nonMmapBufferSize );
+    if( stream->playback.nonMmapBuffer )
+        memset( stream->playback.nonMmapBuffer, 0, stream->playback.nonMmapBufferSize );
+
+    stream->deferTrigger = 1;
+    stream->isPrepared = 1;
+    if( stream->callbackMode )
+        result = PaUnixThread_New( &stream->thread, &CallbackThreadFunc, stream, 1., stream->rtSched );
+    else
+        result = AlsaStart( stream, 0 );
+    stream->deferTrigger = 0;
+    if( result != paNoError )
+        stream->isPrepared = 0;
+    PA_ENSURE( result );
+
+    PA_DEBUG(( "%s: Stream prepared\n", __FUNCTION__ ));
+
+end:
+    return result;
+error:
+    goto end;
+}
+
 /** Stop PCM handle, either softly or abruptly.
  */
 static PaError AlsaStop( PaAlsaStream *stream, int abort )
@@ -3088,13 +4526,30 @@ static PaError RealStop( PaAlsaStream *stream, int abort )
     if( stream->callbackMode )
     {
         PaError threadRes;
-        stream->callbackAbort = abort;
+        /* A thread parked by PrepareStream has nothing to play out */
+        int parked = stream->isPrepared;
+        /* Without a means to wake the thread it has to be cancelled in order to abort quickly */
+        int cancel = abort && stream->wakeFd < 0 && !parked;
+        stream->callbackAbort = abort = abort || parked;
 
         if( !abort )
         {
             PA_DEBUG(( "Stopping callback\n" ));
         }
-        PA_ENSURE( PaUnixThread_Terminate( &stream->thread, !abort, &threadRes ) );
+        /* Terminate flags the stop request before joining, wake the thread so it notices right away */
+        if( !cancel )
+        {
+            PaUnixThread_RequestStop( &stream->thread );
+            PaAlsaStream_Wake( stream );
+        }
+        if( parked )
+        {
+            stream->isPrepared = 0;
+            stream->unparkToExit = 1;
+            ASSERT_CALL_( sem_post( &stream->releaseSem ), 0 );
+        }
+        PA_ENSURE( PaUnixThread_Terminate( &stream->thread, !cancel, &threadRes ) );
+        stream->unparkToExit = 0;
         if( threadRes != paNoError )
         {
             PA_DEBUG(( "Callback thread returned: %d\n", threadRes ));
@@ -3108,6 +4563,7 @@ static PaError RealStop( PaAlsaStream *stream, int abort )
     }
     else
     {
+        stream->isPrepared = 0;
         PA_ENSURE( AlsaStop( stream, abort ) );
     }
 
@@ -3130,6 +4586,110 @@ static PaError AbortStream( PaStream *s )
     return RealStop( (PaAlsaStream * ) s, 1 );
 }
 
+/* Start the readied pcms of several streams with a single trigger, by linking them all to the first. The link only
+ * lasts for the start, so that the streams can be stopped on their own later, the pcms a stream has synced are
+ * linked again afterwards. Where linking isn't possible, e.g. with plugins, the pcms are started one after another */
+static void PaAlsa_TriggerLinked( PaAlsaStream **streams, int count )
+{
+    snd_pcm_t *leader = NULL;
+    int linked = 1, i, j;
+
+    for( i = 0; i < count && linked; ++i )
+    {
+        snd_pcm_t *pcms[2] = { streams[i]->playback.pcm, streams[i]->capture.pcm };
+
+        if( streams[i]->pcmsSynced )
+            alsa_snd_pcm_unlink( streams[i]->capture.pcm );
+        for( j = 0; j < 2 && linked; ++j )
+        {
+            if( !pcms[j] )
+                continue;
+            if( !leader )
+                leader = pcms[j];
+            else if( alsa_snd_pcm_link( leader, pcms[j] ) < 0 )
+                linked = 0;
+        }
+    }
+    if( linked && alsa_snd_pcm_start( leader ) < 0 )
+        linked = 0;
+    PA_DEBUG(( "%s: Started %d streams %s\n", __FUNCTION__, count, linked ? "linked" : "one by one" ));
+
+    for( i = 0; i < count; ++i )
+    {
+        if( streams[i]->playback.pcm )
+            alsa_snd_pcm_unlink( streams[i]->playback.pcm );
+        if( streams[i]->capture.pcm )
+            alsa_snd_pcm_unlink( streams[i]->capture.pcm );
+        if( streams[i]->pcmsSynced && alsa_snd_pcm_link( streams[i]->capture.pcm, streams[i]->playback.pcm ) < 0 )
+        {
+            PA_DEBUG(( "%s: Unable to sync pcms again\n", __FUNCTION__ ));
+            streams[i]->pcmsSynced = streams[i]->linkedWait = 0;
+        }
+    }
+}
+
+/* Callback streams are started with a single trigger. Their threads ready the pcms as for any start, but leave
+ * them stopped until all threads have done so. Blocking streams, and callback streams whose playback AlsaStart
+ * leaves to be started by the first write, are started at a common time instead */
+static PaError StartStreams( PaStream **s, int count )
+{
+    PaError result = paNoError;
+    PaAlsaStream **streams = (PaAlsaStream **)s;
+    int i, j;
+
+    for( i = 0; i < count; ++i )
+    {
+        if( !streams[i]->callbackMode || PaAlsaStream_PlaybackStartsOnWrite( streams[i] ) )
+            return PaUtil_DefaultStartStreams( s, count );
+    }
+
+    for( i = 0; i < count; ++i )
+    {
+        streams[i]->deferTrigger = 1;
+        result = StartStreamAt( streams[i], 0. );
+        streams[i]->deferTrigger = 0;
+        PA_ENSURE( result );
+    }
+
+    PaAlsa_TriggerLinked( streams, count );
+    for( j = 0; j < count; ++j )
+        PA_ENSURE( PaAlsaStream_Trigger( streams[j] ) );
+
+end:
+    return result;
+error:
+    while( --i >= 0 )
+        AbortStream( streams[i] );
+    goto end;
+}
+
+/* The callback threads of all streams are asked to stop before waiting for any of them, blocking streams are
+ * stopped in turn */
+static PaError StopStreams( PaStream **s, int count )
+{
+    PaError result = paNoError, error;
+    PaAlsaStream **streams = (PaAlsaStream **)s;
+    int i;
+
+    for( i = 0; i < count; ++i )
+    {
+        if( streams[i]->callbackMode )
+        {
+            streams[i]->callbackAbort = 0;
+            PaUnixThread_RequestStop( &streams[i]->thread );
+            PaAlsaStream_Wake( streams[i] );
+        }
+    }
+    for( i = 0; i < count; ++i )
+    {
+        error = RealStop( streams[i], 0 );
+        if( result == paNoError )
+            result = error;
+    }
+
+    return result;
+}
+
 /** The stream is considered stopped before StartStream, or AFTER a call to Abort/StopStream (callback
  * returning !paContinue is not considered)
  *
@@ -3150,29 +4710,10 @@ static PaError IsStreamActive( PaStream *s )
 
 static PaTime GetStreamTime( PaStream *s )
 {
-    PaAlsaStream *stream = (PaAlsaStream*)s;
-
-    snd_timestamp_t timestamp;
-    snd_pcm_status_t* status;
-    alsa_snd_pcm_status_alloca( &status );
-
-    /* TODO: what if we have both?  does it really matter? */
-
-    /* TODO: if running in callback mode, this will mean
-     * libasound routines are being called from multiple threads.
-     * need to verify that libasound is thread-safe. */
-
-    if( stream->capture.pcm )
-    {
-        alsa_snd_pcm_status( stream->capture.pcm, status );
-    }
-    else if( stream->playback.pcm )
-    {
-        alsa_snd_pcm_status( stream->playback.pcm, status );
-    }
-
-    alsa_snd_pcm_status_get_tstamp( status, &timestamp );
-    return timestamp.tv_sec + (PaTime)timestamp.tv_usec / 1e6;
+    /* Callback time info is expressed in terms of the monotonic clock, which is cheaper to query than the PCM
+     * status and does not involve calling into libasound from an arbitrary thread */
+    (void)s;
+    return GetMonotonicTime();
 }
 
 static double GetStreamCpuLoad( PaStream* s )
@@ -3248,64 +4789,112 @@ error:
     return result;
 }
 
+/** Record an xrun of a component and recover its PCM in place.
+ *
+ * @param xrunTime Return the time of the xrun, in terms of the stream time
+ * @param xrunDuration Return how long ago the xrun occurred, in milliseconds
+ * @return 1 if the xrun was recovered from, 0 if the stream has to be restarted
+ */
+static int PaAlsaStreamComponent_RecoverXrun( PaAlsaStreamComponent *self, snd_pcm_status_t *st, PaTime *xrunTime,
+        PaTime *xrunDuration )
+{
+    snd_timestamp_t t;
+    PaTime triggerTime, now = self->monotonicTstamps ? GetMonotonicTime() : GetRealtimeTime();
+
+    alsa_snd_pcm_status_get_trigger_tstamp( st, &t );
+    triggerTime = t.tv_sec + (PaTime)t.tv_usec / 1e6;
+    *xrunDuration = ( now - triggerTime ) * 1000;
+    *xrunTime = self->monotonicTstamps ? triggerTime : triggerTime + GetMonotonicTime() - now;
+
+    /* Re-prepare the PCM. Since the hardware pointer is reset, the timing has to be established anew */
+    if( alsa_snd_pcm_recover( self->pcm, -EPIPE, 1 ) < 0 )
+        return 0;
+    PaAlsaStreamComponent_ResetTiming( self );
+
+    return 1;
+}
+
 /** Recover from xrun state.
  *
+ * The PCMs that are in xrun state are re-prepared in place with snd_pcm_recover, leaving a running counterpart
+ * of a full duplex stream undisturbed. Non-mmap playback is restarted implicitly by writing to it, mmap PCMs and
+ * capture PCMs are explicitly started again, playback after filling its buffer with silence. Only if this fails
+ * is the stream restarted as a whole.
  */
 static PaError PaAlsaStream_HandleXrun( PaAlsaStream *self )
 {
     PaError result = paNoError;
-    snd_pcm_status_t *st;
-    PaTime now = PaUtil_GetTime();
-    snd_timestamp_t t;
+    snd_pcm_status_t *playbackStatus, *captureStatus;
+    PaTime xrunTime;
     int restartAlsa = 0; /* do not restart Alsa by default */
+    int playbackXrun = 0, captureXrun = 0, startPlayback = 0, startCapture = 0;
 
-    alsa_snd_pcm_status_alloca( &st );
+    alsa_snd_pcm_status_alloca( &playbackStatus );
+    alsa_snd_pcm_status_alloca( &captureStatus );
 
+    /* Query both PCMs before recovering either, preparing one of a linked pair prepares the other as well */
     if( self->playback.pcm )
     {
-        alsa_snd_pcm_status( self->playback.pcm, st );
-        if( alsa_snd_pcm_status_get_state( st ) == SND_PCM_STATE_XRUN )
-        {
-            alsa_snd_pcm_status_get_trigger_tstamp( st, &t );
-            self->underrun = now * 1000 - ( (PaTime)t.tv_sec * 1000 + (PaTime)t.tv_usec / 1000 );
-
-            if( !self->playback.canMmap )
-            {
-                if( alsa_snd_pcm_recover( self->playback.pcm, -EPIPE, 0 ) < 0 )
-                {
-                    PA_DEBUG(( "%s: [playback] non-MMAP-PCM failed recovering from XRUN, will restart Alsa\n", __FUNCTION__ ));
-                    ++ restartAlsa; /* did not manage to recover */
-                }
-            }
-            else
-                ++ restartAlsa; /* always restart MMAPed device */
-        }
+        alsa_snd_pcm_status( self->playback.pcm, playbackStatus );
+        playbackXrun = alsa_snd_pcm_status_get_state( playbackStatus ) == SND_PCM_STATE_XRUN;
     }
     if( self->capture.pcm )
     {
-        alsa_snd_pcm_status( self->capture.pcm, st );
-        if( alsa_snd_pcm_status_get_state( st ) == SND_PCM_STATE_XRUN )
+        alsa_snd_pcm_status( self->capture.pcm, captureStatus );
+        captureXrun = alsa_snd_pcm_status_get_state( captureStatus ) == SND_PCM_STATE_XRUN;
+    }
+
+    if( playbackXrun )
+    {
+        if( PaAlsaStreamComponent_RecoverXrun( &self->playback, playbackStatus, &xrunTime, &self->underrun ) )
+            startPlayback = self->playback.canMmap && self->callbackMode;
+        else
         {
-            alsa_snd_pcm_status_get_trigger_tstamp( st, &t );
-            self->overrun = now * 1000 - ((PaTime) t.tv_sec * 1000 + (PaTime) t.tv_usec / 1000);
+            PA_DEBUG(( "%s: [playback] failed recovering from XRUN, will restart Alsa\n", __FUNCTION__ ));
+            ++ restartAlsa; /* did not manage to recover */
+        }
 
-            if (!self->capture.canMmap)
-            {
-                if (alsa_snd_pcm_recover( self->capture.pcm, -EPIPE, 0 ) < 0)
-                {
-                    PA_DEBUG(( "%s: [capture] non-MMAP-PCM failed recovering from XRUN, will restart Alsa\n", __FUNCTION__ ));
-                    ++ restartAlsa; /* did not manage to recover */
-                }
-            }
-            else
-                ++ restartAlsa; /* always restart MMAPed device */
+        PA_ENSURE( PaUnixMutex_Lock( &self->stateMtx ) );
+        ++ self->xrunStats.underrunCount;
+        self->xrunStats.lastUnderrunTime = xrunTime;
+        PA_ENSURE( PaUnixMutex_Unlock( &self->stateMtx ) );
+    }
+    if( captureXrun )
+    {
+        if( PaAlsaStreamComponent_RecoverXrun( &self->capture, captureStatus, &xrunTime, &self->overrun ) )
+            startCapture = !self->pcmsSynced;
+        else
+        {
+            PA_DEBUG(( "%s: [capture] failed recovering from XRUN, will restart Alsa\n", __FUNCTION__ ));
+            ++ restartAlsa; /* did not manage to recover */
         }
+
+        PA_ENSURE( PaUnixMutex_Lock( &self->stateMtx ) );
+        ++ self->xrunStats.overrunCount;
+        self->xrunStats.lastOverrunTime = xrunTime;
+        PA_ENSURE( PaUnixMutex_Unlock( &self->stateMtx ) );
     }
 
     if( restartAlsa )
     {
         PA_DEBUG(( "%s: restarting Alsa to recover from XRUN\n", __FUNCTION__ ));
         PA_ENSURE( AlsaRestart( self ) );
+
+        PA_ENSURE( PaUnixMutex_Lock( &self->stateMtx ) );
+        ++ self->xrunStats.restartCount;
+        PA_ENSURE( PaUnixMutex_Unlock( &self->stateMtx ) );
+        goto end;
+    }
+
+    if( startPlayback )
+    {
+        SilenceBuffer( self );
+        ENSURE_( alsa_snd_pcm_start( self->playback.pcm ), paUnanticipatedHostError );
+    }
+    /* As in AlsaStart, linked capture is started along with playback */
+    if( startCapture )
+    {
+        ENSURE_( alsa_snd_pcm_start( self->capture.pcm ), paUnanticipatedHostError );
     }
 
 end:
@@ -3383,67 +4972,89 @@ static void OnExit( void *data )
 
     PaUtil_ResetCpuLoadMeasurer( &stream->cpuLoadMeasurer );
 
-    stream->callback_finished = 1;  /* Let the outside world know stream was stopped in callback */
+    /* A thread released from PrepareStream's park without a start has run no callback, there is nothing to finish */
+    if( !stream->unparkToExit )
+        stream->callback_finished = 1;  /* Let the outside world know stream was stopped in callback */
     PA_DEBUG(( "%s: Stopping ALSA handles\n", __FUNCTION__ ));
     AlsaStop( stream, stream->callbackAbort );
 
     PA_DEBUG(( "%s: Stoppage\n", __FUNCTION__ ));
 
     /* Eventually notify user all buffers have played */
-    if( stream->streamRepresentation.streamFinishedCallback )
+    if( stream->streamRepresentation.streamFinishedCallback && !stream->unparkToExit )
     {
         stream->streamRepresentation.streamFinishedCallback( stream->streamRepresentation.userData );
     }
     stream->isActive = 0;
 }
 
-static void CalculateTimeInfo( PaAlsaStream *stream, PaStreamCallbackTimeInfo *timeInfo )
+/** Feed the latest hardware timestamp of a component to its DLL.
+ *
+ * snd_pcm_htimestamp reports the time of the last hardware pointer update along with the matching number of
+ * available frames, from which the hardware position is derived. For hw devices this is read from the status
+ * page shared with the kernel, so no system call is involved. Should the plugin not support it, we fall back to
+ * snd_pcm_status.
+ */
+static void PaAlsaStreamComponent_UpdateTiming( PaAlsaStreamComponent *self, double sampleRate )
 {
-    snd_pcm_status_t *capture_status, *playback_status;
-    snd_timestamp_t capture_timestamp, playback_timestamp;
-    PaTime capture_time = 0., playback_time = 0.;
-
-    alsa_snd_pcm_status_alloca( &capture_status );
-    alsa_snd_pcm_status_alloca( &playback_status );
+    snd_pcm_uframes_t avail;
+    snd_htimestamp_t tstamp;
+    snd_pcm_sframes_t delay;
+    PaTime time;
 
-    if( stream->capture.pcm )
+    if( alsa_snd_pcm_htimestamp && alsa_snd_pcm_htimestamp( self->pcm, &avail, &tstamp ) >= 0 &&
+            ( tstamp.tv_sec || tstamp.tv_nsec ) )
     {
-        snd_pcm_sframes_t capture_delay;
-
-        alsa_snd_pcm_status( stream->capture.pcm, capture_status );
-        alsa_snd_pcm_status_get_tstamp( capture_status, &capture_timestamp );
-
-        capture_time = capture_timestamp.tv_sec +
-            ( (PaTime)capture_timestamp.tv_usec / 1000000.0 );
-        timeInfo->currentTime = capture_time;
-
-        capture_delay = alsa_snd_pcm_status_get_delay( capture_status );
-        timeInfo->inputBufferAdcTime = timeInfo->currentTime -
-            (PaTime)capture_delay / stream->streamRepresentation.streamInfo.sampleRate;
+        /* Frames queued for playback, respectively captured but not yet read */
+        delay = StreamDirection_Out == self->streamDir ? (snd_pcm_sframes_t)( self->alsaBufferSize - avail ) :
+            (snd_pcm_sframes_t)avail;
+        time = tstamp.tv_sec + (PaTime)tstamp.tv_nsec / 1e9;
     }
-    if( stream->playback.pcm )
+    else
     {
-        snd_pcm_sframes_t playback_delay;
+        snd_pcm_status_t *status;
+        snd_timestamp_t timestamp;
 
-        alsa_snd_pcm_status( stream->playback.pcm, playback_status );
-        alsa_snd_pcm_status_get_tstamp( playback_status, &playback_timestamp );
+        alsa_snd_pcm_status_alloca( &status );
+        if( alsa_snd_pcm_status( self->pcm, status ) < 0 )
+            return;
+        alsa_snd_pcm_status_get_tstamp( status, &timestamp );
+        delay = alsa_snd_pcm_status_get_delay( status );
+        time = timestamp.tv_sec + (PaTime)timestamp.tv_usec / 1e6;
+    }
 
-        playback_time = playback_timestamp.tv_sec +
-            ((PaTime)playback_timestamp.tv_usec / 1000000.0);
+    /* Move timestamps from the realtime clock to the stream's time base if the PCM doesn't support another */
+    if( !self->monotonicTstamps )
+        time += GetMonotonicTime() - GetRealtimeTime();
 
-        if( stream->capture.pcm ) /* Full duplex */
-        {
-            /* Hmm, we have both a playback and a capture timestamp.
-             * Hopefully they are the same... */
-            if( fabs( capture_time - playback_time ) > 0.01 )
-                PA_DEBUG(( "Capture time and playback time differ by %f\n", fabs( capture_time-playback_time ) ));
-        }
-        else
-            timeInfo->currentTime = playback_time;
+    PaAlsaTimeDll_Update( &self->timeDll, StreamDirection_Out == self->streamDir ? self->framesTransferred - delay :
+            self->framesTransferred + delay, time, sampleRate );
+}
+
+/** Calculate the callback time info from the hardware timestamps.
+ *
+ * The time at which the next frame to be transferred passes the converter is found by looking up the application
+ * position in the component's DLL.
+ */
+static void CalculateTimeInfo( PaAlsaStream *stream, PaStreamCallbackTimeInfo *timeInfo )
+{
+    double sampleRate = stream->streamRepresentation.streamInfo.sampleRate;
 
-        playback_delay = alsa_snd_pcm_status_get_delay( playback_status );
-        timeInfo->outputBufferDacTime = timeInfo->currentTime +
-            (PaTime)playback_delay / stream->streamRepresentation.streamInfo.sampleRate;
+    timeInfo->currentTime = GetMonotonicTime();
+
+    if( stream->capture.pcm )
+    {
+        PaAlsaStreamComponent_UpdateTiming( &stream->capture, sampleRate );
+        timeInfo->inputBufferAdcTime = stream->capture.timeDll.valid ?
+            PaAlsaTimeDll_TimeAt( &stream->capture.timeDll, stream->capture.framesTransferred ) :
+            timeInfo->currentTime;
+    }
+    if( stream->playback.pcm )
+    {
+        PaAlsaStreamComponent_UpdateTiming( &stream->playback, sampleRate );
+        timeInfo->outputBufferDacTime = stream->playback.timeDll.valid ?
+            PaAlsaTimeDll_TimeAt( &stream->playback.timeDll, stream->playback.framesTransferred ) :
+            timeInfo->currentTime;
     }
 }
 
@@ -3495,6 +5106,7 @@ static PaError PaAlsaStreamComponent_EndProcessing( PaAlsaStreamComponent *self,
     else
     {
         ENSURE_( res, paUnanticipatedHostError );
+        self->framesTransferred += numFrames;
     }
 
 end:
@@ -3508,6 +5120,34 @@ static unsigned char *ExtractAddress( const snd_pcm_channel_area_t *area, snd_pc
     return (unsigned char *) area->addr + ( area->first + offset * area->step ) / 8;
 }
 
+/** Find out whether non-interleaved mmap areas lie at a fixed distance from each other.
+ *
+ * This is the case when the channels are kept in one block, which allows registering them with the buffer
+ * processor in one go.
+ *
+ * @param spacing Return the distance between channels in bytes
+ * @return Nonzero if the areas are uniformly spaced
+ */
+static int GetAreaSpacing( const snd_pcm_channel_area_t *areas, int numChannels, snd_pcm_format_t format,
+        unsigned int *spacing )
+{
+    int i;
+    unsigned int firstBits = numChannels > 1 ? areas[1].first - areas[0].first : 0;
+
+    /* Samples have to follow each other within a channel, for a stride of one */
+    if( firstBits % 8 || areas[0].step != 8 * alsa_snd_pcm_format_size( format, 1 ) )
+        return 0;
+    for( i = 1; i < numChannels; ++i )
+    {
+        if( areas[i].addr != areas[0].addr || areas[i].step != areas[0].step ||
+                areas[i].first != areas[0].first + i * firstBits )
+            return 0;
+    }
+
+    *spacing = firstBits / 8;
+    return 1;
+}
+
 /** Do necessary adaption between user and host channels.
  *
     @concern ChannelAdaption Adapting between user and host channels can involve silencing unused channels and
@@ -3589,7 +5229,8 @@ static PaError PaAlsaStream_EndProcessing( PaAlsaStream *self, unsigned long num
     }
     if( self->playback.pcm )
     {
-        if( self->playback.numHostChannels > self->playback.numUserChannels )
+        /* Nothing to adapt when the callback wrote straight into the mmap area */
+        if( !self->playback.zeroCopy && self->playback.numHostChannels > self->playback.numUserChannels )
         {
             PA_ENSURE( PaAlsaStreamComponent_DoChannelAdaption( &self->playback, &self->bufferProcessor, numFrames ) );
         }
@@ -3621,6 +5262,7 @@ static PaError PaAlsaStreamComponent_GetAvailableFrames( PaAlsaStreamComponent *
     }
 
     *numFrames = framesAvail;
+    self->availFresh = 1;
 
 error:
     return result;
@@ -3740,27 +5382,115 @@ error:
     return result;
 }
 
-/** Wait for and report available buffer space from ALSA.
- *
- * Unless ALSA reports a minimum of frames available for I/O, we poll the ALSA filedescriptors for more.
- * Both of these operations can uncover xrun conditions.
- *
- * @concern Xruns Both polling and querying available frames can report an xrun condition.
+/** Enable or disable a component's descriptors in the epoll set.
  *
- * @param framesAvail Return the number of available frames
- * @param xrunOccurred Return whether an xrun has occurred
+ * A component that is not being waited for has to be disabled, since its descriptors would otherwise keep
+ * signalling. Normally both components are waited for on every iteration, so this is a no-op.
  */
-static PaError PaAlsaStream_WaitForFrames( PaAlsaStream *self, unsigned long *framesAvail, int *xrunOccurred )
+static PaError PaAlsaStreamComponent_ArmEpoll( PaAlsaStreamComponent *self, int epollFd, struct pollfd *pfds,
+        uint32_t firstIndex, int arm )
 {
     PaError result = paNoError;
-    int pollPlayback = self->playback.pcm != NULL, pollCapture = self->capture.pcm != NULL;
-    int pollTimeout = self->pollTimeout;
+    struct epoll_event ev;
+    unsigned int i;
+
+    if( !self->pcm || self->epollArmed == arm )
+        return result;
+
+    for( i = 0; i < self->nfds; ++i )
+    {
+        memset( &ev, 0, sizeof (ev) );
+        ev.events = arm ? pfds[i].events : 0;
+        ev.data.u32 = firstIndex + i;
+        PA_ENSURE_SYSTEM( epoll_ctl( epollFd, EPOLL_CTL_MOD, pfds[i].fd, &ev ) == 0 ? 0 : errno, 0 );
+    }
+    self->epollArmed = arm;
+
+error:
+    return result;
+}
+
+/** Wait on the stream's epoll set.
+ *
+ * The revents of the stream's pollfds are filled in from the reported events, so they can be interpreted with
+ * snd_pcm_poll_descriptors_revents as usual.
+ *
+ * @param numEvents Return the result of epoll_wait, errno is left intact if this is negative
+ * @param woken Return whether the thread was woken through the eventfd
+ */
+static PaError PaAlsaStream_WaitForEvents( PaAlsaStream *self, int pollCapture, int pollPlayback, int timeout,
+        int *numEvents, int *woken )
+{
+    PaError result = paNoError;
+    unsigned int totalFds = self->capture.nfds + self->playback.nfds, i;
+    struct epoll_event events[totalFds + 1];
+    int n;
+
+    PA_ENSURE( PaAlsaStreamComponent_ArmEpoll( &self->capture, self->epollFd, self->pfds, 0, pollCapture ) );
+    PA_ENSURE( PaAlsaStreamComponent_ArmEpoll( &self->playback, self->epollFd, self->pfds + self->capture.nfds,
+                self->capture.nfds, pollPlayback ) );
+    if( pollCapture )
+        self->capture.ready = 0;
+    if( pollPlayback )
+        self->playback.ready = 0;
+
+    *woken = 0;
+    *numEvents = n = epoll_wait( self->epollFd, events, totalFds + 1, timeout );
+    if( n <= 0 )
+        goto end;
+
+    for( i = 0; i < totalFds; ++i )
+        self->pfds[i].revents = 0;
+    for( i = 0; i < (unsigned int)n; ++i )
+    {
+        if( PA_ALSA_WAKE_EVENT_ == events[i].data.u32 )
+        {
+            uint64_t count;
+            /* Reset the eventfd, we're not interested in how often we were woken */
+            if( read( self->wakeFd, &count, sizeof (count) ) < 0 )
+                PA_DEBUG(( "%s: Failed resetting eventfd\n", __FUNCTION__ ));
+            *woken = 1;
+        }
+        else
+            self->pfds[events[i].data.u32].revents = events[i].events;
+    }
+
+end:
+error:
+    return result;
+}
+
+/** Wait for and report available buffer space from ALSA.
+ *
+ * Unless ALSA reports a minimum of frames available for I/O, we poll the ALSA filedescriptors for more.
+ * Both of these operations can uncover xrun conditions.
+ *
+ * @concern Xruns Both polling and querying available frames can report an xrun condition.
+ *
+ * @param framesAvail Return the number of available frames
+ * @param xrunOccurred Return whether an xrun has occurred
+ */
+static PaError PaAlsaStream_WaitForFrames( PaAlsaStream *self, unsigned long *framesAvail, int *xrunOccurred )
+{
+    PaError result = paNoError;
+    int pollPlayback = self->playback.pcm != NULL, pollCapture = self->capture.pcm != NULL;
+    int pollTimeout = self->pollTimeout;
     int xrun = 0, timeouts = 0;
     int pollResults;
 
     assert( self );
     assert( framesAvail );
 
+    /* Available frames are to be queried anew after waiting */
+    self->capture.availFresh = self->playback.availFresh = 0;
+
+    if( self->linkedWait )
+    {
+        /* @concern FullDuplex The playback pcm is only waited for if it turns out to lag behind capture */
+        pollPlayback = 0;
+        self->playback.ready = 0;
+    }
+
     if( !self->callbackMode )
     {
         /* In blocking mode we will only wait if necessary */
@@ -3791,21 +5521,40 @@ static PaError PaAlsaStream_WaitForFrames( PaAlsaStream *self, unsigned long *fr
 #ifdef PTHREAD_CANCELED
         pthread_testcancel();
 #endif
-        if( pollCapture )
+        if( self->epollFd >= 0 )
         {
+            int woken;
+
+            /* The layout of pfds is fixed when using epoll */
             capturePfds = self->pfds;
-            PA_ENSURE( PaAlsaStreamComponent_BeginPolling( &self->capture, capturePfds ) );
-            totalFds += self->capture.nfds;
+            playbackPfds = self->pfds + self->capture.nfds;
+            PA_ENSURE( PaAlsaStream_WaitForEvents( self, pollCapture, pollPlayback, pollTimeout, &pollResults,
+                        &woken ) );
+            if( woken )
+            {
+                /* Let the caller have a look at the stream state */
+                *framesAvail = 0;
+                goto end;
+            }
         }
-        if( pollPlayback )
+        else
         {
-            /* self->pfds is in effect an array of fds; if necessary, index past the capture fds */
-            playbackPfds = self->pfds + (pollCapture ? self->capture.nfds : 0);
-            PA_ENSURE( PaAlsaStreamComponent_BeginPolling( &self->playback, playbackPfds ) );
-            totalFds += self->playback.nfds;
-        }
+            if( pollCapture )
+            {
+                capturePfds = self->pfds;
+                PA_ENSURE( PaAlsaStreamComponent_BeginPolling( &self->capture, capturePfds ) );
+                totalFds += self->capture.nfds;
+            }
+            if( pollPlayback )
+            {
+                /* self->pfds is in effect an array of fds; if necessary, index past the capture fds */
+                playbackPfds = self->pfds + (pollCapture ? self->capture.nfds : 0);
+                PA_ENSURE( PaAlsaStreamComponent_BeginPolling( &self->playback, playbackPfds ) );
+                totalFds += self->playback.nfds;
+            }
 
-        pollResults = poll( self->pfds, totalFds, pollTimeout );
+            pollResults = poll( self->pfds, totalFds, pollTimeout );
+        }
 
         if( pollResults < 0 )
         {
@@ -3865,11 +5614,29 @@ static PaError PaAlsaStream_WaitForFrames( PaAlsaStream *self, unsigned long *fr
             }
         }
 
+        if( self->linkedWait )
+        {
+            if( !pollCapture && !pollPlayback && !self->playback.ready )
+            {
+                /* Capture woke us, the linked playback pcm has normally advanced by the same amount. Its
+                 * availability is read without waiting, the descriptors are only polled should it lag behind */
+                unsigned long playbackFrames;
+                PA_ENSURE( PaAlsaStreamComponent_GetAvailableFrames( &self->playback, &playbackFrames, &xrun ) );
+                if( xrun )
+                {
+                    break;
+                }
+                if( playbackFrames >= self->playback.framesPerPeriod )
+                    self->playback.ready = 1;
+                else
+                    pollPlayback = 1;
+            }
+        }
         /* @concern FullDuplex If only one of two pcms is ready we may want to compromise between the two.
          * If there is less than half a period's worth of samples left of frames in the other pcm's buffer we will
          * stop polling.
          */
-        if( self->capture.pcm && self->playback.pcm )
+        else if( self->capture.pcm && self->playback.pcm )
         {
             if( pollCapture && !pollPlayback )
             {
@@ -3946,21 +5713,31 @@ static PaError PaAlsaStreamComponent_RegisterChannels( PaAlsaStreamComponent* se
     const snd_pcm_channel_area_t *areas, *area;
     void (*setChannel)(PaUtilBufferProcessor *, unsigned int, void *, unsigned int) =
         StreamDirection_In == self->streamDir ? PaUtil_SetInputChannel : PaUtil_SetOutputChannel;
-    unsigned char *buffer, *p;
+    void (*setChannels)(PaUtilBufferProcessor *, unsigned int, void *, unsigned int, unsigned int, unsigned int) =
+        StreamDirection_In == self->streamDir ? PaUtil_SetInputChannels : PaUtil_SetOutputChannels;
+    unsigned char *buffer;
     int i;
     unsigned long framesAvail;
 
-    /* This _must_ be called before mmap_begin */
-    PA_ENSURE( PaAlsaStreamComponent_GetAvailableFrames( self, &framesAvail, xrun ) );
-    if( *xrun )
+    /* This _must_ be called before mmap_begin, unless done since waiting. Successive calls to mmap_begin take the
+     * frames committed in the meantime into account */
+    if( !self->availFresh )
     {
-        *numFrames = 0;
-        goto end;
+        PA_ENSURE( PaAlsaStreamComponent_GetAvailableFrames( self, &framesAvail, xrun ) );
+        if( *xrun )
+        {
+            *numFrames = 0;
+            goto end;
+        }
     }
 
     if( self->canMmap )
     {
         ENSURE_( alsa_snd_pcm_mmap_begin( self->pcm, &areas, &self->offset, numFrames ), paUnanticipatedHostError );
+        /* The area layout only changes with the areas themselves, which are normally handed out once */
+        if( areas != self->channelAreas && !self->hostInterleaved )
+            self->areasUniform = GetAreaSpacing( areas, self->numUserChannels, self->nativeFormat,
+                    &self->areaSpacing );
         /* @concern ChannelAdaption Buffer address is recorded so we can do some channel adaption later */
         self->channelAreas = (snd_pcm_channel_area_t *)areas;
     }
@@ -3978,21 +5755,30 @@ static PaError PaAlsaStreamComponent_RegisterChannels( PaAlsaStreamComponent* se
         }
     }
 
-    if( self->hostInterleaved )
+    if( self->zeroCopy && self->hostInterleaved )
+    {
+        /* The buffer processor hands this region straight to the callback */
+        buffer = ExtractAddress( areas, self->offset );
+        if( StreamDirection_In == self->streamDir )
+            PaUtil_SetInterleavedInputChannels( bp, 0, buffer, self->numUserChannels );
+        else
+            PaUtil_SetInterleavedOutputChannels( bp, 0, buffer, self->numUserChannels );
+    }
+    else if( self->hostInterleaved )
     {
         int swidth = alsa_snd_pcm_format_size( self->nativeFormat, 1 );
 
-        p = buffer = self->canMmap ? ExtractAddress( areas, self->offset ) : self->nonMmapBuffer;
-        for( i = 0; i < self->numUserChannels; ++i )
-        {
-            /* We're setting the channels up to userChannels, but the stride will be hostChannels samples */
-            setChannel( bp, i, p, self->numHostChannels );
-            p += swidth;
-        }
+        buffer = self->canMmap ? ExtractAddress( areas, self->offset ) : self->nonMmapBuffer;
+        /* We're setting the channels up to userChannels, but the stride will be hostChannels samples */
+        setChannels( bp, 0, buffer, self->numUserChannels, swidth, self->numHostChannels );
     }
     else
     {
-        if( self->canMmap )
+        if( self->canMmap && self->areasUniform )
+        {
+            setChannels( bp, 0, ExtractAddress( areas, self->offset ), self->numUserChannels, self->areaSpacing, 1 );
+        }
+        else if( self->canMmap )
         {
             for( i = 0; i < self->numUserChannels; ++i )
             {
@@ -4004,12 +5790,7 @@ static PaError PaAlsaStreamComponent_RegisterChannels( PaAlsaStreamComponent* se
         else
         {
             unsigned int buf_per_ch_size = self->nonMmapBufferSize / self->numHostChannels;
-            buffer = self->nonMmapBuffer;
-            for( i = 0; i < self->numUserChannels; ++i )
-            {
-                setChannel( bp, i, buffer, 1 );
-                buffer += buf_per_ch_size;
-            }
+            setChannels( bp, 0, self->nonMmapBuffer, self->numUserChannels, buf_per_ch_size, 1 );
         }
     }
 
@@ -4156,6 +5937,72 @@ error:
     return result;
 }
 
+/** Fill the playback buffer from the stream callback before the pcms are started.
+ *
+ * The playback pcm is prepared and as many whole periods as are available are requested from the callback, flagged
+ * with paPrimingOutput. Input is not running yet, so the callback is told of an input underflow and receives no
+ * input. The frames written are counted as transferred, so that output timing accounts for them once the stream
+ * runs.
+ *
+ * @param callbackResult Return the callback's verdict, priming stops early if the callback wants to finish
+ */
+static PaError PaAlsaStream_PrimeOutput( PaAlsaStream *self, int *callbackResult )
+{
+    PaError result = paNoError;
+    PaAlsaStreamComponent *playback = &self->playback;
+    PaStreamCallbackTimeInfo timeInfo = {0, 0, 0};
+    PaStreamCallbackFlags cbFlags = paPrimingOutput | ( self->capture.pcm ? paInputUnderflow : 0 );
+    double sampleRate = self->streamRepresentation.streamInfo.sampleRate;
+    snd_pcm_sframes_t avail;
+    unsigned long framesToPrime, framesGot;
+    int xrun = 0;
+
+    ENSURE_( alsa_snd_pcm_prepare( playback->pcm ), paUnanticipatedHostError );
+    PaAlsaStreamComponent_ResetTiming( playback );
+
+    /* We can't be certain that the whole ring buffer is available for priming, but there should be
+     * at least one period */
+    ENSURE_( avail = alsa_snd_pcm_avail_update( playback->pcm ), paUnanticipatedHostError );
+    framesToPrime = avail - ( avail % playback->framesPerPeriod );
+    PA_DEBUG(( "%s: Priming %lu frames\n", __FUNCTION__, framesToPrime ));
+
+    playback->ready = 1;
+    while( framesToPrime > 0 && paContinue == *callbackResult )
+    {
+        framesGot = PA_MIN( framesToPrime, self->maxFramesPerHostBuffer );
+        if( paUtilFixedHostBufferSize == self->bufferProcessor.hostBufferSizeMode &&
+                framesGot < self->maxFramesPerHostBuffer )
+            break;
+
+        /* Nothing is playing yet, the first primed frame is heard as soon as the pcm is started */
+        timeInfo.currentTime = GetMonotonicTime();
+        timeInfo.inputBufferAdcTime = timeInfo.currentTime;
+        timeInfo.outputBufferDacTime = timeInfo.currentTime + playback->framesTransferred / sampleRate;
+        PaUtil_BeginBufferProcessing( &self->bufferProcessor, &timeInfo, cbFlags );
+        PaUtil_BeginCpuLoadMeasurement( &self->cpuLoadMeasurer );
+
+        PA_ENSURE( PaAlsaStreamComponent_RegisterChannels( playback, &self->bufferProcessor, &framesGot, &xrun ) );
+        PA_UNLESS( !xrun, paUnanticipatedHostError );
+        if( self->capture.pcm )
+            PaUtil_SetNoInput( &self->bufferProcessor );
+        PaUtil_SetOutputFrameCount( &self->bufferProcessor, framesGot );
+        PaUtil_EndBufferProcessing( &self->bufferProcessor, callbackResult );
+
+        if( !playback->zeroCopy && playback->numHostChannels > playback->numUserChannels )
+        {
+            PA_ENSURE( PaAlsaStreamComponent_DoChannelAdaption( playback, &self->bufferProcessor, framesGot ) );
+        }
+        PA_ENSURE( PaAlsaStreamComponent_EndProcessing( playback, framesGot, &xrun ) );
+        PA_UNLESS( !xrun, paUnanticipatedHostError );
+        PaUtil_EndCpuLoadMeasurement( &self->cpuLoadMeasurer, framesGot );
+
+        framesToPrime -= PA_MIN( framesToPrime, framesGot );
+    }
+
+error:
+    return result;
+}
+
 /** Callback thread's function.
  *
  * Roughly, the workflow can be described in the following way: The number of available frames that can be processed
@@ -4169,45 +6016,46 @@ static void *CallbackThreadFunc( void *userData )
     PaError result = paNoError;
     PaAlsaStream *stream = (PaAlsaStream*) userData;
     PaStreamCallbackTimeInfo timeInfo = {0, 0, 0};
-    snd_pcm_sframes_t startThreshold = 0;
     int callbackResult = paContinue;
     PaStreamCallbackFlags cbFlags = 0;  /* We might want to keep state across iterations */
     int streamStarted = 0;
+    int parked;
 
     assert( stream );
 
+    /* Read before the parent is notified, which may start the stream */
+    parked = stream->isPrepared;
+
     /* Execute OnExit when exiting */
     pthread_cleanup_push( &OnExit, stream );
 
-    /* Not implemented */
-    assert( !stream->primeBuffers );
-
-    /* @concern StreamStart If the output is being primed the output pcm needs to be prepared, otherwise the
-     * stream is started immediately. The latter involves signaling the waiting main thread.
+    /* @concern StreamStart If the output is being primed the output buffer is filled by the callback before the
+     * pcms are started, otherwise it is zeroed and the stream is started immediately. Either way the waiting main
+     * thread is signaled once the pcms are running.
      */
+    PA_ENSURE( PaUnixThread_PrepareNotify( &stream->thread ) );
     if( stream->primeBuffers )
     {
-        snd_pcm_sframes_t avail;
-
-        if( stream->playback.pcm )
-            ENSURE_( alsa_snd_pcm_prepare( stream->playback.pcm ), paUnanticipatedHostError );
-        if( stream->capture.pcm && !stream->pcmsSynced )
-            ENSURE_( alsa_snd_pcm_prepare( stream->capture.pcm ), paUnanticipatedHostError );
-
-        /* We can't be certain that the whole ring buffer is available for priming, but there should be
-         * at least one period */
-        avail = alsa_snd_pcm_avail_update( stream->playback.pcm );
-        startThreshold = avail - (avail % stream->playback.framesPerPeriod);
-        assert( startThreshold >= stream->playback.framesPerPeriod );
+        PA_ENSURE( PaAlsaStream_PrimeOutput( stream, &callbackResult ) );
+        PA_ENSURE( AlsaStart( stream, 1 ) );
     }
     else
     {
-        PA_ENSURE( PaUnixThread_PrepareNotify( &stream->thread ) );
         /* Buffer will be zeroed */
         PA_ENSURE( AlsaStart( stream, 0 ) );
-        PA_ENSURE( PaUnixThread_NotifyParent( &stream->thread ) );
+    }
+    if( parked )
+        PaAlsa_PrefaultStack();
+    PA_ENSURE( PaUnixThread_NotifyParent( &stream->thread ) );
+    streamStarted = 1;
 
-        streamStarted = 1;
+    /* A prepared stream's thread waits here until the pcms have been started, or the stream is closed */
+    if( parked )
+    {
+        while( sem_wait( &stream->releaseSem ) != 0 && errno == EINTR )
+            ;
+        if( stream->unparkToExit )
+            goto end;
     }
 
     while( 1 )
@@ -4224,8 +6072,9 @@ static void *CallbackThreadFunc( void *userData )
          */
         if( PaUnixThread_StopRequested( &stream->thread ) && paContinue == callbackResult )
         {
-            PA_DEBUG(( "Setting callbackResult to paComplete\n" ));
-            callbackResult = paComplete;
+            /* The stream is aborted without cancelling the thread when it can be woken */
+            callbackResult = stream->callbackAbort ? paAbort : paComplete;
+            PA_DEBUG(( "Setting callbackResult to %s\n", stream->callbackAbort ? "paAbort" : "paComplete" ));
         }
 
         if( paContinue != callbackResult )
@@ -4357,6 +6206,79 @@ error:
 
 /* Blocking interface */
 
+/* Align a blocking stream that has just been started on when: silence is queued for playback up to when, and the
+ * frames captured before when are marked to be dropped */
+static PaError PaAlsaStream_AlignStart( PaAlsaStream *self, PaTime when )
+{
+    PaError result = paNoError;
+    double sampleRate = self->streamRepresentation.streamInfo.sampleRate;
+    double offset = (when - GetMonotonicTime()) * sampleRate;
+    unsigned long frames = offset > 0. ? (unsigned long)(offset + .5) : 0;
+    snd_pcm_t *save = self->capture.pcm;
+
+    /* The start can't lie further ahead than the silence the playback buffer can hold */
+    if( self->playback.pcm )
+        frames = PA_MIN( frames, self->playback.alsaBufferSize - self->playback.framesPerPeriod );
+    if( self->capture.pcm )
+        self->captureSkipFrames = frames;
+
+    if( self->playback.pcm )
+    {
+        /* Disregard capture */
+        self->capture.pcm = NULL;
+        while( frames > 0 )
+        {
+            unsigned long framesGot;
+            int xrun = 0;
+
+            PA_ENSURE( PaAlsaStream_WaitForFrames( self, &framesGot, &xrun ) );
+            framesGot = PA_MIN( framesGot, frames );
+
+            PA_ENSURE( PaAlsaStream_SetUpBuffers( self, &framesGot, &xrun ) );
+            if( framesGot > 0 )
+            {
+                framesGot = PaUtil_ZeroOutput( &self->bufferProcessor, framesGot );
+                PA_ENSURE( PaAlsaStream_EndProcessing( self, framesGot, &xrun ) );
+                frames -= framesGot;
+            }
+        }
+
+        /* Less than a period of silence doesn't reach the start threshold */
+        if( alsa_snd_pcm_state( self->playback.pcm ) == SND_PCM_STATE_PREPARED )
+        {
+            ENSURE_( alsa_snd_pcm_start( self->playback.pcm ), paUnanticipatedHostError );
+        }
+    }
+
+end:
+    self->capture.pcm = save;
+    return result;
+error:
+    goto end;
+}
+
+/* Drop the frames captured before a blocking stream's scheduled start, as far as they have arrived */
+static PaError PaAlsaStream_DropCapturedFrames( PaAlsaStream *self )
+{
+    PaError result = paNoError;
+    snd_pcm_sframes_t avail, dropped;
+
+    if( self->captureSkipFrames == 0 )
+        return paNoError;
+
+    /* Xruns are left to the caller */
+    if( (avail = alsa_snd_pcm_avail_update( self->capture.pcm )) <= 0 )
+        return paNoError;
+
+    ENSURE_( dropped = alsa_snd_pcm_forward( self->capture.pcm,
+                PA_MIN( (snd_pcm_uframes_t)avail, self->captureSkipFrames ) ), paUnanticipatedHostError );
+    self->captureSkipFrames -= dropped;
+    self->capture.framesTransferred += dropped;
+
+error:
+    return result;
+}
+
 static PaError ReadStream( PaStream* s, void *buffer, unsigned long frames )
 {
     PaError result = paNoError;
@@ -4399,6 +6321,13 @@ static PaError ReadStream( PaStream* s, void *buffer, unsigned long frames )
     {
         int xrun = 0;
         PA_ENSURE( PaAlsaStream_WaitForFrames( stream, &framesAvail, &xrun ) );
+
+        /* The frames before a scheduled start are not the user's */
+        if( stream->captureSkipFrames > 0 )
+        {
+            PA_ENSURE( PaAlsaStream_DropCapturedFrames( stream ) );
+            continue;
+        }
         framesGot = PA_MIN( framesAvail, frames );
 
         PA_ENSURE( PaAlsaStream_SetUpBuffers( stream, &framesGot, &xrun ) );
@@ -4492,6 +6421,7 @@ static signed long GetStreamReadAvailable( PaStream* s )
     unsigned long avail;
     int xrun;
 
+    PA_ENSURE( PaAlsaStream_DropCapturedFrames( stream ) );
     PA_ENSURE( PaAlsaStreamComponent_GetAvailableFrames( &stream->capture, &avail, &xrun ) );
     if( xrun )
     {
@@ -4534,6 +6464,293 @@ error:
     return result;
 }
 
+/* The playback mmap area can be written to directly if it holds samples just as the user would write them */
+static int PaAlsaStream_CanWriteDirect( PaAlsaStream *self )
+{
+    PaAlsaStreamComponent *playback = &self->playback;
+
+    return playback->canMmap && self->bufferProcessor.userOutputSampleFormatIsEqualToHost &&
+        playback->numHostChannels == playback->numUserChannels &&
+        playback->hostInterleaved == playback->userInterleaved;
+}
+
+/* Hand out the playback mmap area, or a staging buffer if the samples need converting */
+static PaError GetStreamWriteBuffer( PaStream* s, void **buffer, unsigned long *frames )
+{
+    PaError result = paNoError;
+    PaAlsaStream *stream = (PaAlsaStream*)s;
+    PaAlsaStreamComponent *playback = &stream->playback;
+    const snd_pcm_channel_area_t *areas;
+    snd_pcm_uframes_t framesGot;
+    unsigned long framesAvail = 0;
+    snd_pcm_t *save = stream->capture.pcm;
+    int i;
+
+    PA_UNLESS( playback->pcm, paCanNotWriteToAnInputOnlyStream );
+
+    stream->directWrite = PaAlsaStream_CanWriteDirect( stream );
+    if( !stream->directWrite )
+        return PaUtil_DefaultGetWriteBuffer( s, buffer, frames );
+
+    /* Disregard capture */
+    stream->capture.pcm = NULL;
+
+    while( 0 == framesAvail )
+    {
+        int xrun = 0;
+        PA_ENSURE( PaAlsaStream_WaitForFrames( stream, &framesAvail, &xrun ) );
+    }
+
+    /* Available frames were just queried, as mmap_begin wants */
+    framesGot = PA_MIN( framesAvail, *frames );
+    ENSURE_( alsa_snd_pcm_mmap_begin( playback->pcm, &areas, &playback->offset, &framesGot ),
+            paUnanticipatedHostError );
+
+    if( playback->userInterleaved )
+    {
+        *buffer = ExtractAddress( areas, playback->offset );
+    }
+    else
+    {
+        for( i = 0; i < playback->numUserChannels; ++i )
+            playback->userBuffers[i] = ExtractAddress( areas + i, playback->offset );
+        *buffer = playback->userBuffers;
+    }
+    *frames = framesGot;
+
+end:
+    stream->capture.pcm = save;
+    return result;
+error:
+    goto end;
+}
+
+static PaError CommitStreamWriteBuffer( PaStream* s, unsigned long frames )
+{
+    PaError result = paNoError;
+    signed long err;
+    PaAlsaStream *stream = (PaAlsaStream*)s;
+    snd_pcm_t *save = stream->capture.pcm;
+    int xrun = 0;
+
+    if( !stream->directWrite )
+        return PaUtil_DefaultCommitWriteBuffer( s, frames );
+
+    /* Disregard capture */
+    stream->capture.pcm = NULL;
+
+    if( stream->underrun > 0. )
+    {
+        result = paOutputUnderflowed;
+        stream->underrun = 0.0;
+    }
+
+    /* An xrun in the meantime is dealt with by GetStreamWriteAvailable */
+    PA_ENSURE( PaAlsaStreamComponent_EndProcessing( &stream->playback, frames, &xrun ) );
+
+    /* Start stream after one period of samples worth, like WriteStream */
+    PA_ENSURE( err = GetStreamWriteAvailable( stream ) );
+    if( alsa_snd_pcm_state( stream->playback.pcm ) == SND_PCM_STATE_PREPARED &&
+            stream->playback.alsaBufferSize - err >= stream->playback.framesPerPeriod )
+    {
+        ENSURE_( alsa_snd_pcm_start( stream->playback.pcm ), paUnanticipatedHostError );
+    }
+
+end:
+    stream->capture.pcm = save;
+    return result;
+error:
+    goto end;
+}
+
+/* Point into a user buffer at a frame offset. Non-interleaved buffers are arrays of channel pointers, the offset
+ * pointers are stored in channels */
+static void *OffsetUserBuffer( const void *buffer, int interleaved, int numChannels, unsigned int bytesPerSample,
+        unsigned long offset, void **channels )
+{
+    int i;
+
+    if( interleaved )
+        return (unsigned char *)buffer + offset * numChannels * bytesPerSample;
+
+    for( i = 0; i < numChannels; ++i )
+        channels[i] = ((unsigned char **)buffer)[i] + offset * bytesPerSample;
+    return channels;
+}
+
+/** Wait for a component to become ready, for no longer than timeout seconds.
+ *
+ * The descriptors of a plugin may signal without the pcm being ready, which snd_pcm_poll_descriptors_revents
+ * tells apart, so these wake-ups are waited through. An xrun ends the wait as well, the caller looks at the
+ * available frames afterwards.
+ */
+static PaError PaAlsaStreamComponent_WaitTimeout( PaAlsaStreamComponent *self, PaTime timeout )
+{
+    PaError result = paNoError;
+    struct pollfd pfds[self->nfds];
+    PaTime deadline = PaUtil_GetTime() + timeout, remaining = timeout;
+    int shouldPoll = 1, xrun = 0, ret;
+
+    while( shouldPoll && remaining > 0. )
+    {
+        PA_ENSURE( PaAlsaStreamComponent_BeginPolling( self, pfds ) );
+        /* Long timeouts are cut short rather than overflowing, the caller waits again */
+        ret = poll( pfds, self->nfds, (int)PA_MIN( ceil( remaining * 1000. ), (double)INT_MAX ) );
+        if( ret < 0 && errno != EINTR )
+            PA_ENSURE( paInternalError );
+        if( ret > 0 )
+            PA_ENSURE( PaAlsaStreamComponent_EndPolling( self, pfds, &shouldPoll, &xrun ) );
+        remaining = deadline - PaUtil_GetTime();
+    }
+
+error:
+    return result;
+}
+
+/* Read what is available, then wait on the capture descriptors for more until the deadline */
+static PaError ReadStreamTimeout( PaStream* s, void *buffer, unsigned long *frames, PaTime timeout )
+{
+    PaError result = paNoError, readResult;
+    PaAlsaStream *stream = (PaAlsaStream*)s;
+    PaAlsaStreamComponent *capture = &stream->capture;
+    PaTime deadline = PaUtil_GetTime() + timeout, remaining;
+    unsigned long framesDone = 0, framesGot;
+    signed long avail;
+    int overflowed = 0;
+
+    PA_UNLESS( capture->pcm, paCanNotReadFromAnOutputOnlyStream );
+
+    /* Start stream if in prepared state, there would be nothing to wait for otherwise */
+    if( alsa_snd_pcm_state( capture->pcm ) == SND_PCM_STATE_PREPARED )
+    {
+        ENSURE_( alsa_snd_pcm_start( capture->pcm ), paUnanticipatedHostError );
+    }
+
+    for( ;; )
+    {
+        PA_ENSURE( avail = GetStreamReadAvailable( s ) );
+        if( avail > 0 )
+        {
+            void *channels[capture->numUserChannels];
+
+            /* Reading no more than is available won't block */
+            framesGot = PA_MIN( (unsigned long)avail, *frames - framesDone );
+            readResult = ReadStream( s, OffsetUserBuffer( buffer, capture->userInterleaved,
+                        capture->numUserChannels, stream->bufferProcessor.bytesPerUserInputSample, framesDone,
+                        channels ), framesGot );
+            if( paInputOverflowed == readResult )
+                overflowed = 1;
+            else
+                PA_ENSURE( readResult );
+            framesDone += framesGot;
+        }
+
+        if( framesDone == *frames || (remaining = deadline - PaUtil_GetTime()) <= 0. )
+            break;
+        PA_ENSURE( PaAlsaStreamComponent_WaitTimeout( capture, remaining ) );
+    }
+
+end:
+    *frames = framesDone;
+    return paNoError == result && overflowed ? paInputOverflowed : result;
+error:
+    goto end;
+}
+
+/* Write what fits, then wait on the playback descriptors for more room until the deadline */
+static PaError WriteStreamTimeout( PaStream* s, const void *buffer, unsigned long *frames, PaTime timeout )
+{
+    PaError result = paNoError, writeResult;
+    PaAlsaStream *stream = (PaAlsaStream*)s;
+    PaAlsaStreamComponent *playback = &stream->playback;
+    PaTime deadline = PaUtil_GetTime() + timeout, remaining;
+    unsigned long framesDone = 0, framesGot;
+    signed long avail;
+    int underflowed = 0;
+
+    PA_UNLESS( playback->pcm, paCanNotWriteToAnInputOnlyStream );
+
+    for( ;; )
+    {
+        PA_ENSURE( avail = GetStreamWriteAvailable( s ) );
+        if( avail > 0 )
+        {
+            void *channels[playback->numUserChannels];
+
+            /* Writing no more than there is room for won't block, WriteStream starts the pcm once a period is
+             * queued */
+            framesGot = PA_MIN( (unsigned long)avail, *frames - framesDone );
+            writeResult = WriteStream( s, OffsetUserBuffer( buffer, playback->userInterleaved,
+                        playback->numUserChannels, stream->bufferProcessor.bytesPerUserOutputSample, framesDone,
+                        channels ), framesGot );
+            if( paOutputUnderflowed == writeResult )
+                underflowed = 1;
+            else
+                PA_ENSURE( writeResult );
+            framesDone += framesGot;
+        }
+
+        if( framesDone == *frames || (remaining = deadline - PaUtil_GetTime()) <= 0. )
+            break;
+        PA_ENSURE( PaAlsaStreamComponent_WaitTimeout( playback, remaining ) );
+    }
+
+end:
+    *frames = framesDone;
+    return paNoError == result && underflowed ? paOutputUnderflowed : result;
+error:
+    goto end;
+}
+
+/** Hand out an epoll set of the PCMs' descriptors.
+ *
+ * It is separate from the stream's own epoll set, in which descriptors are disabled as the stream sees fit. Being
+ * level triggered, the set stays readable for as long as any of the descriptors signals.
+ */
+static PaError GetStreamPollDescriptor( PaStream* s, int *fd )
+{
+    PaError result = paNoError;
+    PaAlsaStream *stream = (PaAlsaStream*)s;
+    struct pollfd pfds[stream->capture.nfds + stream->playback.nfds];
+    struct epoll_event ev;
+    unsigned int numFds = 0, i;
+    int readyFd = -1;
+
+    if( stream->readyFd < 0 )
+    {
+        if( stream->capture.pcm )
+        {
+            PA_UNLESS( alsa_snd_pcm_poll_descriptors( stream->capture.pcm, pfds, stream->capture.nfds ) ==
+                    stream->capture.nfds, paInternalError );
+            numFds += stream->capture.nfds;
+        }
+        if( stream->playback.pcm )
+        {
+            PA_UNLESS( alsa_snd_pcm_poll_descriptors( stream->playback.pcm, pfds + numFds, stream->playback.nfds ) ==
+                    stream->playback.nfds, paInternalError );
+            numFds += stream->playback.nfds;
+        }
+
+        PA_ENSURE_SYSTEM( (readyFd = epoll_create1( EPOLL_CLOEXEC )) >= 0 ? 0 : errno, 0 );
+        for( i = 0; i < numFds; ++i )
+        {
+            memset( &ev, 0, sizeof (ev) );
+            ev.events = pfds[i].events;
+            ev.data.u32 = i;
+            PA_ENSURE_SYSTEM( epoll_ctl( readyFd, EPOLL_CTL_ADD, pfds[i].fd, &ev ) == 0 ? 0 : errno, 0 );
+        }
+        stream->readyFd = readyFd;
+    }
+
+    *fd = stream->readyFd;
+    return result;
+
+error:
+    if( readyFd >= 0 )
+        close( readyFd );
+    return result;
+}
+
 /* Extensions */
 
 void PaAlsa_InitializeStreamInfo( PaAlsaStreamInfo *info )
@@ -4615,6 +6832,21 @@ error:
     return result;
 }
 
+PaError PaAlsa_GetStreamXrunStats( PaStream *s, PaAlsaStreamXrunStats *stats )
+{
+    PaAlsaStream *stream;
+    PaError result = paNoError;
+
+    PA_ENSURE( GetAlsaStreamPointer( s, &stream ) );
+
+    PA_ENSURE( PaUnixMutex_Lock( &stream->stateMtx ) );
+    *stats = stream->xrunStats;
+    PA_ENSURE( PaUnixMutex_Unlock( &stream->stateMtx ) );
+
+error:
+    return result;
+}
+
 PaError PaAlsa_SetRetriesBusy( int retries )
 {
     busyRetries_ = retries;
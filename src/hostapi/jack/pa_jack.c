@@ -48,7 +48,6 @@
 */
 
 #include <string.h>
-#include <regex.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
@@ -57,7 +56,9 @@
 #include <errno.h>  /* EBUSY */
 #include <signal.h> /* sig_atomic_t */
 #include <math.h>
+#include <time.h>
 #include <semaphore.h>
+#include <sys/eventfd.h>
 
 #include <jack/types.h>
 #include <jack/jack.h>
@@ -69,7 +70,10 @@
 #include "pa_allocation.h"
 #include "pa_cpuload.h"
 #include "pa_ringbuffer.h"
+#include "pa_blockingadapter.h"
+#include "pa_memorybarrier.h"
 #include "pa_debugprint.h"
+#include "pa_jack.h"
 
 static pthread_t mainThread_;
 static char *jackErr_ = NULL;
@@ -138,8 +142,12 @@ static PaError OpenStream( struct PaUtilHostApiRepresentation *hostApi,
                            void *userData );
 static PaError CloseStream( PaStream* stream );
 static PaError StartStream( PaStream *stream );
+static PaError StartStreamAt( PaStream *stream, PaTime when );
 static PaError StopStream( PaStream *stream );
 static PaError AbortStream( PaStream *stream );
+static PaError StartStreams( PaStream **streams, int count );
+static PaError StopStreams( PaStream **streams, int count );
+static PaError PrepareStream( PaStream *stream );
 static PaError IsStreamStopped( PaStream *s );
 static PaError IsStreamActive( PaStream *stream );
 /*static PaTime GetStreamInputLatency( PaStream *stream );*/
@@ -154,30 +162,81 @@ static double GetStreamCpuLoad( PaStream* stream );
 
 struct PaJackStream;
 
+/* The streams processed by the JACK callback. A list is never modified once published, adding or removing a stream
+ * replaces it as a whole so that the process thread can pick it up without locking */
 typedef struct
+{
+    int numStreams;
+    struct PaJackStream **streams;
+}
+PaJackProcessList;
+
+/* The audio ports of a JACK client, which is presented as a device */
+typedef struct
+{
+    const char **outputPorts;   /* The ports we can capture from */
+    int numOutputPorts;
+    const char **inputPorts;    /* The ports we can play back to */
+    int numInputPorts;
+}
+PaJackClientPorts;
+
+struct PaJackHostApiRepresentation;
+
+/* A thread that helps the JACK process thread with processing streams, see PA_JACK_WORKER_THREADS */
+typedef struct
+{
+    struct PaJackHostApiRepresentation *hostApi;
+    jack_native_thread_t thread;
+    sem_t wakeSem;      /* Posted by the process thread when there is work in the current cycle */
+}
+PaJackWorker;
+
+typedef struct PaJackHostApiRepresentation
 {
     PaUtilHostApiRepresentation commonHostApiRep;
     PaUtilStreamInterface callbackStreamInterface;
     PaUtilStreamInterface blockingStreamInterface;
 
     PaUtilAllocationGroup *deviceInfoMemory;
+    PaJackClientPorts *clientPorts;     /* Per device, found when building the device list */
 
     jack_client_t *jack_client;
     int jack_buffer_size;
     PaHostApiIndex hostApiIndex;
 
-    pthread_mutex_t mtx;
-    pthread_cond_t cond;
+    pthread_mutex_t mtx;    /* Serializes replacing the process list, never taken by the process thread */
+    sem_t processSem;       /* Posted by the process thread when it has picked up a new process list */
     unsigned long inputBase, outputBase;
 
     /* For dealing with the process thread */
     volatile int xrun;     /* Received xrun notification from JACK? */
-    struct PaJackStream * volatile toAdd, * volatile toRemove;
-    struct PaJackStream *processQueue;
+    PaJackProcessList * volatile processList;      /* Published by the main thread, NULL if there are no streams */
+    PaJackProcessList * volatile rtProcessList;    /* The list the process thread is working with */
+    volatile jack_nframes_t sampleRate;            /* Updated from the sample rate callback */
+    volatile int latencyGeneration;                /* Incremented by the latency callback */
     volatile sig_atomic_t jackIsDown;
+    volatile sig_atomic_t releaseHeld;  /* Set when the requests of held streams are to be acted on, see UpdateQueue */
+
+    /* Worker threads processing streams in parallel within a cycle, none by default */
+    PaJackWorker *workers;
+    int numWorkers;
+    volatile int quitWorkers;
+    sem_t workDoneSem;      /* Posted by each worker woken for a cycle once it runs out of streams to process */
+
+    /* The work of the current cycle, shared with the workers */
+    PaJackProcessList *cycleList;
+    jack_nframes_t cycleFrames;
+    double cycleSampleRate;
+    int cycleXrun;
+    volatile int nextStream;    /* Index of the next stream in cycleList to be claimed */
+    volatile int cycleFailed;
 }
 PaJackHostApiRepresentation;
 
+static void StartWorkers( PaJackHostApiRepresentation *hostApi, int numWorkers );
+static void StopWorkers( PaJackHostApiRepresentation *hostApi );
+
 /* PaJackStream - a stream data structure specifically for this implementation */
 
 typedef struct PaJackStream
@@ -207,9 +266,17 @@ typedef struct PaJackStream
     volatile sig_atomic_t is_active;
     /* Used to signal processing thread that stream should start or stop, respectively */
     volatile sig_atomic_t doStart, doStop, doAbort;
+    volatile sig_atomic_t isHeld;   /* The process thread leaves the above be until the stream's group is released */
+    int isPrepared;                 /* PrepareStream has connected the ports ahead of the start */
+    sem_t stateSem;     /* Posted by the process thread once it has acted on doStart, doStop or doAbort */
 
     jack_nframes_t t0;
 
+    /* Latency ranges of our connections, in frames. Refreshed by the process thread when JACK has reported a change
+     * through the latency callback */
+    jack_latency_range_t captureLatency, playbackLatency;
+    int latencyGeneration;
+
     PaUtilAllocationGroup *stream_memory;
 
     /* These are useful in the process callback */
@@ -221,14 +288,12 @@ typedef struct PaJackStream
     /* These are useful for the blocking API */
 
     int                     isBlockingStream;
-    PaUtilRingBuffer        inFIFO;
-    PaUtilRingBuffer        outFIFO;
-    volatile sig_atomic_t   data_available;
-    sem_t                   data_semaphore;
-    int                     bytesPerFrame;
-    int                     samplesPerFrame;
-
-    struct PaJackStream *next;
+    PaUtilBlockingAdapter   blockingAdapter;    /* Interleaved float frames, exchanged with the process thread */
+    PaTime                  blockingStartTime;  /* Scheduled start, see BlockingScheduleStart, or 0 */
+    unsigned long           blockingInputDelay, blockingOutputDelay;    /* Frames to pass over before the start */
+    sem_t                   readSem, writeSem;
+    volatile int            readyFd;    /* eventfd signalled once a cycle has made frames transferable, or -1 */
+    volatile sig_atomic_t   readySignalled; /* readyFd has been signalled since it was last reset */
 }
 PaJackStream;
 
@@ -239,11 +304,23 @@ PaJackStream;
 #define TRUE 1
 #define FALSE 0
 
+/* How long to wait for the process thread to act on a request, and how often to check whether JACK has gone away
+ * in the meantime */
+#define PA_JACK_WAIT_TIMEOUT_ (10 * 60)
+#define PA_JACK_WAIT_SLICE_NS_ 100000000
+
+#define PA_JACK_MAX_WORKER_THREADS_ 32
+
+#define PA_JACK_MAX_( a, b ) ( (a) > (b) ? (a) : (b) )
+#define PA_JACK_MIN_( a, b ) ( (a) < (b) ? (a) : (b) )
+
 /*
  * Functions specific to this API
  */
 
 static int JackCallback( jack_nframes_t frames, void *userData );
+static PaTime GetCycleTime( PaJackStream *stream, double sampleRate );
+static PaError WaitForProcessThread( sem_t *sem, PaTime deadline );
 
 
 /*
@@ -254,184 +331,280 @@ static int JackCallback( jack_nframes_t frames, void *userData );
 
 /* ---- blocking emulation layer ---- */
 
-/* Allocate buffer. */
-static PaError BlockingInitFIFO( PaUtilRingBuffer *rbuf, long numFrames, long bytesPerFrame )
+/* The blocking streams exchange interleaved float frames with the process thread through a PaUtilBlockingAdapter,
+ * the process thread only interleaves the port buffers into its ring buffers or out of them. A thread that has to
+ * wait for the adapter sleeps on a semaphore per direction, which the process thread posts once the frames the
+ * thread needs are there.
+ *
+ * Threads multiplexing streams through Pa_GetStreamPollDescriptor wait on an eventfd instead, which the process
+ * thread signals in the first cycle after it has been reset. It is reset whenever the stream is read or written,
+ * so the process thread makes no system call in the cycles in between.
+ */
+
+static PaError BlockingWaitHook( void *waitData, int output, PaTime deadline )
 {
-    long numBytes = numFrames * bytesPerFrame;
-    char *buffer = (char *) malloc( numBytes );
-    if( buffer == NULL ) return paInsufficientMemory;
-    memset( buffer, 0, numBytes );
-    return (PaError) PaUtil_InitializeRingBuffer( rbuf, 1, numBytes, buffer );
+    PaError result = paNoError;
+    PaJackStream *stream = (PaJackStream *)waitData;
+
+    UNLESS( !stream->hostApi->jackIsDown, paDeviceUnavailable );
+    UNLESS( stream->is_active, paStreamIsStopped );
+    result = WaitForProcessThread( output ? &stream->writeSem : &stream->readSem, deadline );
+
+error:
+    return result;
 }
 
-/* Free buffer. */
-static PaError BlockingTermFIFO( PaUtilRingBuffer *rbuf )
+static void BlockingWakeHook( void *waitData, int output )
 {
-    if( rbuf->buffer ) free( rbuf->buffer );
-    rbuf->buffer = NULL;
-    return paNoError;
+    PaJackStream *stream = (PaJackStream *)waitData;
+    sem_post( output ? &stream->writeSem : &stream->readSem );
 }
 
-static int
-BlockingCallback( const void                      *inputBuffer,
-                  void                            *outputBuffer,
-		  unsigned long                    framesPerBuffer,
-		  const PaStreamCallbackTimeInfo*  timeInfo,
-		  PaStreamCallbackFlags            statusFlags,
-		  void                             *userData )
+/* Work out how many frames each direction passes over before a scheduled start, in the cycle the stream is
+ * activated. Input is taken from the frame captured at the start time on. The output FIFO holds silence from being
+ * reset, so the first frame written comes out after it: output is delayed by what the silence doesn't cover, or
+ * else the surplus silence is dropped. */
+static void BlockingScheduleStart( PaJackStream *stream, double sampleRate )
 {
-    struct PaJackStream *stream = (PaJackStream *)userData;
-    long numBytes = stream->bytesPerFrame * framesPerBuffer;
+    PaUtilRingBuffer *outputFifo = &stream->blockingAdapter.outputFifo;
+    double delay;
+
+    stream->blockingInputDelay = stream->blockingOutputDelay = 0;
+    if( stream->blockingStartTime <= 0. )
+        return;
 
-    /* This may get called with NULL inputBuffer during initial setup. */
-    if( inputBuffer != NULL )
+    if( stream->num_incoming_connections > 0 )
     {
-        PaUtil_WriteRingBuffer( &stream->inFIFO, inputBuffer, numBytes );
+        delay = ( stream->blockingStartTime - GetCycleTime( stream, sampleRate ) ) * sampleRate
+            + stream->captureLatency.max;
+        stream->blockingInputDelay = delay > 0. ? (unsigned long)(delay + .5) : 0;
     }
-    if( outputBuffer != NULL )
+    if( stream->num_outgoing_connections > 0 )
     {
-        int numRead = PaUtil_ReadRingBuffer( &stream->outFIFO, outputBuffer, numBytes );
-        /* Zero out remainder of buffer if we run out of data. */
-        memset( (char *)outputBuffer + numRead, 0, numBytes - numRead );
+        delay = ( stream->blockingStartTime - GetCycleTime( stream, sampleRate ) ) * sampleRate
+            - stream->playbackLatency.max - PaUtil_GetRingBufferReadAvailable( outputFifo );
+        if( delay >= 0. )
+            stream->blockingOutputDelay = (unsigned long)(delay + .5);
+        else
+            PaUtil_AdvanceRingBufferReadIndex( outputFifo, PA_JACK_MIN_( (ring_buffer_size_t)(-delay + .5),
+                        PaUtil_GetRingBufferReadAvailable( outputFifo ) ) );
     }
 
-    if( !stream->data_available )
-    {
-        stream->data_available = 1;
-        sem_post( &stream->data_semaphore );
-    }
-    return paContinue;
+    stream->blockingStartTime = 0.;
 }
 
-static PaError
-BlockingBegin( PaJackStream *stream, int minimum_buffer_size )
+/* Exchange one cycle's worth of frames between the port buffers and the adapter, in the process thread */
+static void BlockingProcess( PaJackStream *stream, jack_nframes_t frames )
 {
-    long    doRead = 0;
-    long    doWrite = 0;
-    PaError result = paNoError;
-    long    numFrames;
-
-    doRead = stream->local_input_ports != NULL;
-    doWrite = stream->local_output_ports != NULL;
-    /* <FIXME> */
-    stream->samplesPerFrame = 2;
-    stream->bytesPerFrame = sizeof(float) * stream->samplesPerFrame;
-    /* </FIXME> */
-    numFrames = 32;
-    while (numFrames < minimum_buffer_size)
-        numFrames *= 2;
+    PaUtilBlockingAdapter *adapter = &stream->blockingAdapter;
+    void *data[2];
+    ring_buffer_size_t size[2];
+    ring_buffer_size_t done;
+    jack_nframes_t skip;
+    int r, chn, numChannels;
+    long i;
 
-    if( doRead )
+    if( stream->num_incoming_connections > 0 )
     {
-        ENSURE_PA( BlockingInitFIFO( &stream->inFIFO, numFrames, stream->bytesPerFrame ) );
+        /* Frames captured before a scheduled start are passed over */
+        skip = PA_JACK_MIN_( stream->blockingInputDelay, frames );
+        stream->blockingInputDelay -= skip;
+
+        numChannels = stream->num_incoming_connections;
+        PaUtil_GetRingBufferWriteRegions( &adapter->inputFifo, frames - skip, &data[0], &size[0], &data[1], &size[1] );
+        for( r = 0, done = 0; r < 2; done += size[r++] )
+        {
+            for( chn = 0; chn < numChannels; ++chn )
+            {
+                const jack_default_audio_sample_t *src = (jack_default_audio_sample_t *)jack_port_get_buffer(
+                        stream->local_input_ports[chn], frames ) + skip + done;
+                float *dst = (float *)data[r] + chn;
+
+                for( i = 0; i < size[r]; ++i )
+                    dst[i * numChannels] = src[i];
+            }
+        }
+        PaUtil_AdvanceBlockingAdapterInput( adapter, done, frames - skip );
     }
-    if( doWrite )
+
+    if( stream->num_outgoing_connections > 0 )
     {
-        long numBytes;
+        /* Silence leads up to a scheduled start */
+        skip = PA_JACK_MIN_( stream->blockingOutputDelay, frames );
+        stream->blockingOutputDelay -= skip;
+
+        numChannels = stream->num_outgoing_connections;
+        PaUtil_GetRingBufferReadRegions( &adapter->outputFifo, frames - skip, &data[0], &size[0], &data[1], &size[1] );
+        done = size[0] + size[1];
+        for( chn = 0; chn < numChannels; ++chn )
+        {
+            jack_default_audio_sample_t *dst = (jack_default_audio_sample_t *)jack_port_get_buffer(
+                    stream->local_output_ports[chn], frames );
 
-        ENSURE_PA( BlockingInitFIFO( &stream->outFIFO, numFrames, stream->bytesPerFrame ) );
+            memset( dst, 0, sizeof (jack_default_audio_sample_t) * skip );
+            dst += skip;
+            for( r = 0; r < 2; dst += size[r++] )
+            {
+                const float *src = (float *)data[r] + chn;
 
-        /* Make Write FIFO appear full initially. */
-        numBytes = PaUtil_GetRingBufferWriteAvailable( &stream->outFIFO );
-        PaUtil_AdvanceRingBufferWriteIndex( &stream->outFIFO, numBytes );
+                for( i = 0; i < size[r]; ++i )
+                    dst[i] = src[i * numChannels];
+            }
+            /* Zero out remainder of buffer if we run out of data. */
+            memset( dst, 0, sizeof (jack_default_audio_sample_t) * (frames - skip - done) );
+        }
+        PaUtil_AdvanceBlockingAdapterOutput( adapter, done, frames - skip );
     }
 
-    stream->data_available = 0;
-    sem_init( &stream->data_semaphore, 0, 0 );
+    if( stream->readyFd >= 0 && !stream->readySignalled )
+    {
+        uint64_t one = 1;
+        stream->readySignalled = 1;
+        if( write( stream->readyFd, &one, sizeof (one) ) < 0 )
+            PA_DEBUG(( "%s: Failed signalling eventfd\n", __FUNCTION__ ));
+    }
+}
 
-error:
-    return result;
+/* Reset the eventfd before transferring frames, the next cycle signals it again. The flag is only cleared once the
+ * eventfd has been read, so a signal can't be read away unnoticed */
+static void BlockingResetReady( PaJackStream *stream )
+{
+    uint64_t count;
+
+    if( stream->readyFd < 0 )
+        return;
+
+    if( read( stream->readyFd, &count, sizeof (count) ) < 0 && errno != EAGAIN )
+        PA_DEBUG(( "%s: Failed resetting eventfd\n", __FUNCTION__ ));
+    PaUtil_WriteMemoryBarrier();
+    stream->readySignalled = 0;
+}
+
+/* Set up the blocking adapter, once the buffer processor has been initialized */
+static PaError
+BlockingBegin( PaJackStream *stream, int minimum_buffer_size )
+{
+    sem_init( &stream->readSem, 0, 0 );
+    sem_init( &stream->writeSem, 0, 0 );
+
+    return PaUtil_InitializeBlockingAdapter( &stream->blockingAdapter, &stream->bufferProcessor,
+            minimum_buffer_size, stream->hostApi->jack_buffer_size, BlockingWaitHook, BlockingWakeHook, stream );
 }
 
 static void
 BlockingEnd( PaJackStream *stream )
 {
-    BlockingTermFIFO( &stream->inFIFO );
-    BlockingTermFIFO( &stream->outFIFO );
+    PaUtil_TerminateBlockingAdapter( &stream->blockingAdapter );
+
+    sem_destroy( &stream->readSem );
+    sem_destroy( &stream->writeSem );
 
-    sem_destroy( &stream->data_semaphore );
+    if( stream->readyFd >= 0 )
+        close( stream->readyFd );
+    stream->readyFd = -1;
+}
+
+/* Read *numFrames frames, or as many as arrive by deadline, in which case paTimedOut is returned. *numFrames returns
+ * the number of frames read. */
+static PaError BlockingRead( PaJackStream *stream, void *data, unsigned long *numFrames, PaTime deadline )
+{
+    BlockingResetReady( stream );
+    return PaUtil_ReadBlockingAdapter( &stream->blockingAdapter, data, numFrames, deadline );
+}
+
+/* Write *numFrames frames, or as many as there is room for by deadline, in which case paTimedOut is returned.
+ * *numFrames returns the number of frames written. */
+static PaError BlockingWrite( PaJackStream *stream, const void *data, unsigned long *numFrames, PaTime deadline )
+{
+    BlockingResetReady( stream );
+    return PaUtil_WriteBlockingAdapter( &stream->blockingAdapter, data, numFrames, deadline );
 }
 
 static PaError BlockingReadStream( PaStream* s, void *data, unsigned long numFrames )
+{
+    return BlockingRead( (PaJackStream *)s, data, &numFrames, PaUtil_GetTime() + PA_JACK_WAIT_TIMEOUT_ );
+}
+
+static PaError BlockingWriteStream( PaStream* s, const void *data, unsigned long numFrames )
+{
+    return BlockingWrite( (PaJackStream *)s, data, &numFrames, PaUtil_GetTime() + PA_JACK_WAIT_TIMEOUT_ );
+}
+
+static PaError BlockingReadStreamTimeout( PaStream* s, void *data, unsigned long *numFrames, PaTime timeout )
+{
+    PaError result = BlockingRead( (PaJackStream *)s, data, numFrames, PaUtil_GetTime() + timeout );
+    return result == paTimedOut ? paNoError : result;
+}
+
+static PaError BlockingWriteStreamTimeout( PaStream* s, const void *data, unsigned long *numFrames, PaTime timeout )
+{
+    PaError result = BlockingWrite( (PaJackStream *)s, data, numFrames, PaUtil_GetTime() + timeout );
+    return result == paTimedOut ? paNoError : result;
+}
+
+static PaError BlockingGetStreamPollDescriptor( PaStream* s, int *fd )
 {
     PaError result = paNoError;
     PaJackStream *stream = (PaJackStream *)s;
+    int readyFd;
 
-    long bytesRead;
-    char *p = (char *) data;
-    long numBytes = stream->bytesPerFrame * numFrames;
-    while( numBytes > 0 )
+    if( stream->readyFd < 0 )
     {
-        bytesRead = PaUtil_ReadRingBuffer( &stream->inFIFO, p, numBytes );
-        numBytes -= bytesRead;
-        p += bytesRead;
-        if( numBytes > 0 )
-        {
-            /* see write for an explanation */
-            if( stream->data_available )
-                stream->data_available = 0;
-            else
-                sem_wait( &stream->data_semaphore );
-        }
+        UNLESS( (readyFd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC )) >= 0, paInsufficientMemory );
+        /* The process thread may pick this up at once */
+        PaUtil_WriteMemoryBarrier();
+        stream->readyFd = readyFd;
     }
+    *fd = stream->readyFd;
 
+error:
     return result;
 }
 
-static PaError BlockingWriteStream( PaStream* s, const void *data, unsigned long numFrames )
+/* Interleaved float output is written straight into the FIFO, anything else is staged and converted */
+static int BlockingCanWriteDirect( PaJackStream *stream )
+{
+    return stream->bufferProcessor.userOutputSampleFormatIsEqualToHost &&
+        stream->bufferProcessor.userOutputIsInterleaved;
+}
+
+static PaError BlockingGetStreamWriteBuffer( PaStream* s, void **buffer, unsigned long *numFrames )
 {
-    PaError result = paNoError;
     PaJackStream *stream = (PaJackStream *)s;
-    long bytesWritten;
-    char *p = (char *) data;
-    long numBytes = stream->bytesPerFrame * numFrames;
-    while( numBytes > 0 )
-    {
-        bytesWritten = PaUtil_WriteRingBuffer( &stream->outFIFO, p, numBytes );
-        numBytes -= bytesWritten;
-        p += bytesWritten;
-        if( numBytes > 0 )
-        {
-            /* we use the following algorithm:
-             *   (1) write data
-             *   (2) if some data didn't fit into the ringbuffer, set data_available to 0
-             *       to indicate to the audio that if space becomes available, we want to know
-             *   (3) retry to write data (because it might be that between (1) and (2)
-             *       new space in the buffer became available)
-             *   (4) if this failed, we are sure that the buffer is really empty and
-             *       we will definitely receive a notification when it becomes available
-             *       thus we can safely sleep
-             *
-             * if the algorithm bailed out in step (3) before, it leaks a count of 1
-             * on the semaphore; however, it doesn't matter, because if we block in (4),
-             * we also do it in a loop
-             */
-            if( stream->data_available )
-                stream->data_available = 0;
-            else
-                sem_wait( &stream->data_semaphore );
-        }
-    }
 
-    return result;
+    if( stream->num_outgoing_connections == 0 )
+        return paCanNotWriteToAnInputOnlyStream;
+    if( !BlockingCanWriteDirect( stream ) )
+        return PaUtil_DefaultGetWriteBuffer( s, buffer, numFrames );
+
+    BlockingResetReady( stream );
+    return PaUtil_GetBlockingAdapterWriteBuffer( &stream->blockingAdapter, buffer, numFrames,
+            PaUtil_GetTime() + PA_JACK_WAIT_TIMEOUT_ );
+}
+
+static PaError BlockingCommitStreamWriteBuffer( PaStream* s, unsigned long numFrames )
+{
+    PaJackStream *stream = (PaJackStream *)s;
+
+    if( !BlockingCanWriteDirect( stream ) )
+        return PaUtil_DefaultCommitWriteBuffer( s, numFrames );
+
+    PaUtil_CommitBlockingAdapterWriteBuffer( &stream->blockingAdapter, numFrames );
+    return paNoError;
 }
 
 static signed long
 BlockingGetStreamReadAvailable( PaStream* s )
 {
     PaJackStream *stream = (PaJackStream *)s;
-
-    int bytesFull = PaUtil_GetRingBufferReadAvailable( &stream->inFIFO );
-    return bytesFull / stream->bytesPerFrame;
+    return PaUtil_GetBlockingAdapterReadAvailable( &stream->blockingAdapter );
 }
 
 static signed long
 BlockingGetStreamWriteAvailable( PaStream* s )
 {
     PaJackStream *stream = (PaJackStream *)s;
-
-    int bytesEmpty = PaUtil_GetRingBufferWriteAvailable( &stream->outFIFO );
-    return bytesEmpty / stream->bytesPerFrame;
+    return PaUtil_GetBlockingAdapterWriteAvailable( &stream->blockingAdapter );
 }
 
 static PaError
@@ -439,15 +612,104 @@ BlockingWaitEmpty( PaStream *s )
 {
     PaJackStream *stream = (PaJackStream *)s;
 
-    while( PaUtil_GetRingBufferReadAvailable( &stream->outFIFO ) > 0 )
+    if( stream->num_outgoing_connections == 0 )
+        return paNoError;
+    return PaUtil_WaitForBlockingAdapter( &stream->blockingAdapter, 1, stream->blockingAdapter.outputFifo.bufferSize,
+            PaUtil_GetTime() + PA_JACK_WAIT_TIMEOUT_ );
+}
+
+/* ---- jack driver ---- */
+
+/* Look up the client that portName belongs to in table, an open addressing hash table of indices into clientNames
+ * keyed on the part of the port name up to the colon.
+ *
+ * Returns the client index, or -1 with *slot set to where the client should be inserted.
+ */
+static int FindClient( const int *table, unsigned long tableMask, char * const *clientNames, const char *portName,
+        unsigned long *slot )
+{
+    size_t length = strcspn( portName, ":" );
+    unsigned long hash = 2166136261UL;   /* FNV-1a */
+    size_t i;
+
+    for( i = 0; i < length; ++i )
+        hash = ((hash ^ (unsigned char)portName[i]) * 16777619UL) & 0xffffffffUL;
+
+    for( *slot = hash & tableMask; table[*slot] >= 0; *slot = (*slot + 1) & tableMask )
     {
-        stream->data_available = 0;
-        sem_wait( &stream->data_semaphore );
+        const char *name = clientNames[table[*slot]];
+        if( strncmp( name, portName, length ) == 0 && name[length] == '\0' )
+            return table[*slot];
     }
-    return 0;
+    return -1;
 }
 
-/* ---- jack driver ---- */
+/* Sort the ports flowing in direction (JackPortIsInput or JackPortIsOutput) into the clients they belong to */
+static PaError GroupClientPorts( PaJackHostApiRepresentation *jackApi, const int *table, unsigned long tableMask,
+        char * const *clientNames, unsigned long numClients, unsigned long direction )
+{
+    PaError result = paNoError;
+    const char **jack_ports = NULL;
+    unsigned long slot;
+    int port_index, client_index;
+
+    /* A: If jack_get_ports returns NULL, there's nothing for us to do */
+    UNLESS( jack_ports = jack_get_ports( jackApi->jack_client, "", JACK_PORT_TYPE_FILTER, direction ), paNoError );
+
+    /* Count the ports of each client first, so that the lists can be allocated in one go */
+    for( port_index = 0; jack_ports[port_index]; ++port_index )
+    {
+        /* Ports of a client that appeared in the meantime are of no interest */
+        if( (client_index = FindClient( table, tableMask, clientNames, jack_ports[port_index], &slot )) < 0 )
+            continue;
+        if( direction == JackPortIsOutput )
+            ++jackApi->clientPorts[client_index].numOutputPorts;
+        else
+            ++jackApi->clientPorts[client_index].numInputPorts;
+    }
+
+    for( client_index = 0; client_index < numClients; ++client_index )
+    {
+        PaJackClientPorts *ports = &jackApi->clientPorts[client_index];
+        int numPorts = direction == JackPortIsOutput ? ports->numOutputPorts : ports->numInputPorts;
+        const char **names;
+
+        if( numPorts == 0 )
+            continue;
+        UNLESS( names = (const char **)PaUtil_GroupAllocateMemory( jackApi->deviceInfoMemory,
+                    numPorts * sizeof (const char *) ), paInsufficientMemory );
+        if( direction == JackPortIsOutput )
+        {
+            ports->outputPorts = names;
+            ports->numOutputPorts = 0;
+        }
+        else
+        {
+            ports->inputPorts = names;
+            ports->numInputPorts = 0;
+        }
+    }
+
+    for( port_index = 0; jack_ports[port_index]; ++port_index )
+    {
+        const char *port = jack_ports[port_index];
+        char *name;
+
+        if( (client_index = FindClient( table, tableMask, clientNames, port, &slot )) < 0 )
+            continue;
+        UNLESS( name = (char *)PaUtil_GroupAllocateMemory( jackApi->deviceInfoMemory, strlen( port ) + 1 ),
+                paInsufficientMemory );
+        strcpy( name, port );
+        if( direction == JackPortIsOutput )
+            jackApi->clientPorts[client_index].outputPorts[jackApi->clientPorts[client_index].numOutputPorts++] = name;
+        else
+            jackApi->clientPorts[client_index].inputPorts[jackApi->clientPorts[client_index].numInputPorts++] = name;
+    }
+
+error:
+    free( jack_ports );
+    return result;
+}
 
 /* BuildDeviceList():
  *
@@ -458,8 +720,6 @@ BlockingWaitEmpty( PaStream *s )
 
 static PaError BuildDeviceList( PaJackHostApiRepresentation *jackApi )
 {
-    /* Utility macros for the repetitive process of allocating memory */
-
     /* JACK has no concept of a device.  To JACK, there are clients
      * which have an arbitrary number of ports.  To make this
      * intelligible to PortAudio clients, we will group each JACK client
@@ -470,26 +730,20 @@ static PaError BuildDeviceList( PaJackHostApiRepresentation *jackApi )
 
     const char **jack_ports = NULL;
     char **client_names = NULL;
-    char *regex_pattern = NULL;
-    int port_index, client_index, i;
+    int *client_table = NULL;
+    unsigned long tableMask, slot;
+    int port_index, client_index;
     double globalSampleRate;
-    regex_t port_regex;
     unsigned long numClients = 0, numPorts = 0;
-    char *tmp_client_name = NULL;
 
     commonApi->info.defaultInputDevice = paNoDevice;
     commonApi->info.defaultOutputDevice = paNoDevice;
     commonApi->info.deviceCount = 0;
 
-    /* Parse the list of ports, using a regex to grab the client names */
-    ASSERT_CALL( regcomp( &port_regex, "^[^:]*", REG_EXTENDED ), 0 );
-
     /* since we are rebuilding the list of devices, free all memory
      * associated with the previous list */
     PaUtil_FreeAllAllocations( jackApi->deviceInfoMemory );
-
-    regex_pattern = PaUtil_GroupAllocateMemory( jackApi->deviceInfoMemory, jack_client_name_size() + 3 );
-    tmp_client_name = PaUtil_GroupAllocateMemory( jackApi->deviceInfoMemory, jack_client_name_size() );
+    jackApi->clientPorts = NULL;
 
     /* We can only retrieve the list of clients indirectly, by first
      * asking for a list of all ports, then parsing the port names
@@ -504,50 +758,49 @@ static PaError BuildDeviceList( PaJackHostApiRepresentation *jackApi )
     UNLESS( client_names = PaUtil_GroupAllocateMemory( jackApi->deviceInfoMemory, numPorts *
                 sizeof (char *) ), paInsufficientMemory );
 
-    /* Build a list of clients from the list of ports */
-    for( numClients = 0, port_index = 0; jack_ports[port_index] != NULL; port_index++ )
+    /* Clients are looked up by name in a hash table that is at most half full */
+    for( tableMask = 1; tableMask < 2 * numPorts; tableMask <<= 1 )
+        ;
+    UNLESS( client_table = (int *)PaUtil_AllocateMemory( tableMask * sizeof (int) ), paInsufficientMemory );
+    memset( client_table, -1, tableMask * sizeof (int) );
+    --tableMask;
+
+    /* Build a list of clients from the list of ports, in order of appearance */
+    for( port_index = 0; jack_ports[port_index] != NULL; port_index++ )
     {
-        int client_seen = FALSE;
-        regmatch_t match_info;
         const char *port = jack_ports[port_index];
-
-        /* extract the client name from the port name, using a regex
-         * that parses the clientname:portname syntax */
-        UNLESS( !regexec( &port_regex, port, 1, &match_info, 0 ), paInternalError );
-        assert(match_info.rm_eo - match_info.rm_so < jack_client_name_size());
-        memcpy( tmp_client_name, port + match_info.rm_so,
-                match_info.rm_eo - match_info.rm_so );
-        tmp_client_name[match_info.rm_eo - match_info.rm_so] = '\0';
+        size_t length = strcspn( port, ":" );
 
         /* do we know about this port's client yet? */
-        for( i = 0; i < numClients; i++ )
-        {
-            if( strcmp( tmp_client_name, client_names[i] ) == 0 )
-                client_seen = TRUE;
-        }
-
-        if (client_seen)
+        if( FindClient( client_table, tableMask, client_names, port, &slot ) >= 0 )
             continue;   /* A: Nothing to see here, move along */
 
+        assert( length < jack_client_name_size() );
         UNLESS( client_names[numClients] = (char*)PaUtil_GroupAllocateMemory( jackApi->deviceInfoMemory,
-                    strlen(tmp_client_name) + 1), paInsufficientMemory );
+                    length + 1 ), paInsufficientMemory );
+        memcpy( client_names[numClients], port, length );
+        client_names[numClients][length] = '\0';
+        client_table[slot] = numClients++;
+    }
 
-        /* The alsa_pcm client should go in spot 0.  If this
-         * is the alsa_pcm client AND we are NOT about to put
-         * it in spot 0 put it in spot 0 and move whatever
-         * was already in spot 0 to the end. */
-        if( strcmp( "alsa_pcm", tmp_client_name ) == 0 && numClients > 0 )
-        {
-            /* alsa_pcm goes in spot 0 */
-            strcpy( client_names[ numClients ], client_names[0] );
-            strcpy( client_names[0], tmp_client_name );
-        }
-        else
-        {
-            /* put the new client at the end of the client list */
-            strcpy( client_names[ numClients ], tmp_client_name );
-        }
-        ++numClients;
+    /* Sort every port into its client, one query per direction */
+    UNLESS( jackApi->clientPorts = (PaJackClientPorts *)PaUtil_GroupAllocateMemory( jackApi->deviceInfoMemory,
+                numClients * sizeof (PaJackClientPorts) ), paInsufficientMemory );
+    memset( jackApi->clientPorts, 0, numClients * sizeof (PaJackClientPorts) );
+    ENSURE_PA( GroupClientPorts( jackApi, client_table, tableMask, client_names, numClients, JackPortIsOutput ) );
+    ENSURE_PA( GroupClientPorts( jackApi, client_table, tableMask, client_names, numClients, JackPortIsInput ) );
+
+    /* The alsa_pcm client should go in spot 0, whatever was in spot 0
+     * takes its place. */
+    if( (client_index = FindClient( client_table, tableMask, client_names, "alsa_pcm:", &slot )) > 0 )
+    {
+        char *name = client_names[client_index];
+        PaJackClientPorts ports = jackApi->clientPorts[client_index];
+
+        client_names[client_index] = client_names[0];
+        jackApi->clientPorts[client_index] = jackApi->clientPorts[0];
+        client_names[0] = name;
+        jackApi->clientPorts[0] = ports;
     }
 
     /* Now we have a list of clients, which will become the list of
@@ -565,13 +818,11 @@ static PaError BuildDeviceList( PaJackHostApiRepresentation *jackApi )
     for( client_index = 0; client_index < numClients; client_index++ )
     {
         PaDeviceInfo *curDevInfo;
-        const char **clientPorts = NULL;
+        const PaJackClientPorts *clientPorts = &jackApi->clientPorts[client_index];
 
         UNLESS( curDevInfo = (PaDeviceInfo*)PaUtil_GroupAllocateMemory( jackApi->deviceInfoMemory,
                     sizeof(PaDeviceInfo) ), paInsufficientMemory );
-        UNLESS( curDevInfo->name = (char*)PaUtil_GroupAllocateMemory( jackApi->deviceInfoMemory,
-                    strlen(client_names[client_index]) + 1 ), paInsufficientMemory );
-        strcpy( (char *)curDevInfo->name, client_names[client_index] );
+        curDevInfo->name = client_names[client_index];
 
         curDevInfo->structVersion = 2;
         curDevInfo->hostApi = jackApi->hostApiIndex;
@@ -580,51 +831,38 @@ static PaError BuildDeviceList( PaJackHostApiRepresentation *jackApi )
          * system must run at, and all clients must speak IEEE float. */
         curDevInfo->defaultSampleRate = globalSampleRate;
 
-        /* To determine how many input and output channels are available,
-         * we re-query jackd with more specific parameters. */
-
-        sprintf( regex_pattern, "%s:.*", client_names[client_index] );
-
-        /* ... what are your output ports (that we could input from)? */
-        clientPorts = jack_get_ports( jackApi->jack_client, regex_pattern,
-                                     JACK_PORT_TYPE_FILTER, JackPortIsOutput);
-        curDevInfo->maxInputChannels = 0;
+        /* The number of output ports is the number of input channels,
+         * and vice versa. We don't care what they are, we just care how many */
+        curDevInfo->maxInputChannels = clientPorts->numOutputPorts;
         curDevInfo->defaultLowInputLatency = 0.;
         curDevInfo->defaultHighInputLatency = 0.;
-        if( clientPorts )
+        if( clientPorts->numOutputPorts > 0 )
         {
-            jack_port_t *p = jack_port_by_name( jackApi->jack_client, clientPorts[0] );
-            curDevInfo->defaultLowInputLatency = curDevInfo->defaultHighInputLatency =
-                jack_port_get_latency( p ) / globalSampleRate;
+            jack_port_t *p = jack_port_by_name( jackApi->jack_client, clientPorts->outputPorts[0] );
+            jack_latency_range_t range;
 
-            for( i = 0; clientPorts[i] != NULL; i++)
+            if( p )
             {
-                /* The number of ports returned is the number of output channels.
-                 * We don't care what they are, we just care how many */
-                curDevInfo->maxInputChannels++;
+                jack_port_get_latency_range( p, JackCaptureLatency, &range );
+                curDevInfo->defaultLowInputLatency = range.min / globalSampleRate;
+                curDevInfo->defaultHighInputLatency = range.max / globalSampleRate;
             }
-            free(clientPorts);
         }
 
-        /* ... what are your input ports (that we could output to)? */
-        clientPorts = jack_get_ports( jackApi->jack_client, regex_pattern,
-                                     JACK_PORT_TYPE_FILTER, JackPortIsInput);
-        curDevInfo->maxOutputChannels = 0;
+        curDevInfo->maxOutputChannels = clientPorts->numInputPorts;
         curDevInfo->defaultLowOutputLatency = 0.;
         curDevInfo->defaultHighOutputLatency = 0.;
-        if( clientPorts )
+        if( clientPorts->numInputPorts > 0 )
         {
-            jack_port_t *p = jack_port_by_name( jackApi->jack_client, clientPorts[0] );
-            curDevInfo->defaultLowOutputLatency = curDevInfo->defaultHighOutputLatency =
-                jack_port_get_latency( p ) / globalSampleRate;
+            jack_port_t *p = jack_port_by_name( jackApi->jack_client, clientPorts->inputPorts[0] );
+            jack_latency_range_t range;
 
-            for( i = 0; clientPorts[i] != NULL; i++)
+            if( p )
             {
-                /* The number of ports returned is the number of input channels.
-                 * We don't care what they are, we just care how many */
-                curDevInfo->maxOutputChannels++;
+                jack_port_get_latency_range( p, JackPlaybackLatency, &range );
+                curDevInfo->defaultLowOutputLatency = range.min / globalSampleRate;
+                curDevInfo->defaultHighOutputLatency = range.max / globalSampleRate;
             }
-            free(clientPorts);
         }
 
         /* Add this client to the list of devices */
@@ -637,7 +875,7 @@ static PaError BuildDeviceList( PaJackHostApiRepresentation *jackApi )
     }
 
 error:
-    regfree( &port_regex );
+    PaUtil_FreeMemory( client_table );
     free( jack_ports );
     return result;
 }
@@ -662,40 +900,83 @@ static void JackErrorCallback( const char *msg )
 static void JackOnShutdown( void *arg )
 {
     PaJackHostApiRepresentation *jackApi = (PaJackHostApiRepresentation *)arg;
-    PaJackStream *stream = jackApi->processQueue;
 
     PA_DEBUG(( "%s: JACK server is shutting down\n", __FUNCTION__ ));
-    for( ; stream; stream = stream->next )
-    {
-        stream->is_active = 0;
-    }
 
-    /* Make sure that the main thread doesn't get stuck waiting on the condition */
-    ASSERT_CALL( pthread_mutex_lock( &jackApi->mtx ), 0 );
+    /* Streams are no longer active from here on. Threads waiting on the process thread notice within a wait
+     * slice, the one replacing the process list is woken right away */
     jackApi->jackIsDown = 1;
-    ASSERT_CALL( pthread_cond_signal( &jackApi->cond ), 0 );
-    ASSERT_CALL( pthread_mutex_unlock( &jackApi->mtx ), 0 );
-
+    sem_post( &jackApi->processSem );
 }
 
 static int JackSrCb( jack_nframes_t nframes, void *arg )
 {
     PaJackHostApiRepresentation *jackApi = (PaJackHostApiRepresentation *)arg;
-    double sampleRate = (double)nframes;
-    PaJackStream *stream = jackApi->processQueue;
 
-    /* Update all streams in process queue */
-    PA_DEBUG(( "%s: Acting on change in JACK samplerate: %f\n", __FUNCTION__, sampleRate ));
-    for( ; stream; stream = stream->next )
+    /* The streams are updated by the process thread, which owns their timing state */
+    PA_DEBUG(( "%s: Acting on change in JACK samplerate: %lu\n", __FUNCTION__, (unsigned long)nframes ));
+    jackApi->sampleRate = nframes;
+
+    return 0;
+}
+
+static void JackLatencyCb( jack_latency_callback_mode_t mode, void *arg )
+{
+    PaJackHostApiRepresentation *jackApi = (PaJackHostApiRepresentation *)arg;
+
+    /* Depending on the JACK implementation we may be called from the process thread, so leave querying the new
+     * latencies to the streams themselves */
+    PA_DEBUG(( "%s: JACK %s latencies changed\n", __FUNCTION__, mode == JackCaptureLatency ? "capture" : "playback" ));
+    ++jackApi->latencyGeneration;
+}
+
+/* The combined latency range of ports in the direction of mode */
+static void GetLatencyRange( jack_port_t **ports, int numPorts, jack_latency_callback_mode_t mode,
+        jack_latency_range_t *range )
+{
+    jack_latency_range_t portRange;
+    int i;
+
+    range->min = range->max = 0;
+    for( i = 0; i < numPorts; ++i )
     {
-        if( stream->streamRepresentation.streamInfo.sampleRate != sampleRate )
-        {
-            PA_DEBUG(( "%s: Updating samplerate\n", __FUNCTION__ ));
-            UpdateSampleRate( stream, sampleRate );
-        }
+        jack_port_get_latency_range( ports[i], mode, &portRange );
+        if( i == 0 || portRange.min < range->min )
+            range->min = portRange.min;
+        if( portRange.max > range->max )
+            range->max = portRange.max;
     }
+}
 
-    return 0;
+/* Refresh the latency ranges of the stream's connections, and the latencies reported in its stream info.
+ *
+ * This only reads port state that JACK keeps in the client, no request is made to the server.
+ */
+static void UpdateStreamLatency( PaJackStream *stream )
+{
+    PaStreamInfo *info = &stream->streamRepresentation.streamInfo;
+    const double bufferSize = jack_get_buffer_size( stream->jack_client );
+    const double sampleRate = info->sampleRate;
+
+    stream->latencyGeneration = stream->hostApi->latencyGeneration;
+
+    /* One buffer is not counted as latency */
+    if( stream->num_incoming_connections > 0 )
+    {
+        GetLatencyRange( stream->remote_output_ports, stream->num_incoming_connections, JackCaptureLatency,
+                &stream->captureLatency );
+        info->inputLatency = ( PA_JACK_MAX_( stream->captureLatency.max - bufferSize, 0. )
+            + PaUtil_GetBufferProcessorInputLatencyFrames( &stream->bufferProcessor )
+            + PaUtil_GetBlockingAdapterLatencyFrames( &stream->blockingAdapter, 0 ) ) / sampleRate;
+    }
+    if( stream->num_outgoing_connections > 0 )
+    {
+        GetLatencyRange( stream->remote_input_ports, stream->num_outgoing_connections, JackPlaybackLatency,
+                &stream->playbackLatency );
+        info->outputLatency = ( PA_JACK_MAX_( stream->playbackLatency.max - bufferSize, 0. )
+            + PaUtil_GetBufferProcessorOutputLatencyFrames( &stream->bufferProcessor )
+            + PaUtil_GetBlockingAdapterLatencyFrames( &stream->blockingAdapter, 1 ) ) / sampleRate;
+    }
 }
 
 static int JackXRunCb(void *arg) {
@@ -713,15 +994,20 @@ PaError PaJack_Initialize( PaUtilHostApiRepresentation **hostApi,
     PaJackHostApiRepresentation *jackHostApi;
     int activated = 0;
     jack_status_t jackStatus = 0;
+    const char *workerThreads = getenv( "PA_JACK_WORKER_THREADS" );
     *hostApi = NULL;    /* Initialize to NULL */
 
     UNLESS( jackHostApi = (PaJackHostApiRepresentation*)
         PaUtil_AllocateMemory( sizeof(PaJackHostApiRepresentation) ), paInsufficientMemory );
+    jackHostApi->jack_client = NULL;
+    jackHostApi->workers = NULL;
+    jackHostApi->numWorkers = 0;
     UNLESS( jackHostApi->deviceInfoMemory = PaUtil_CreateAllocationGroup(), paInsufficientMemory );
 
     mainThread_ = pthread_self();
     ASSERT_CALL( pthread_mutex_init( &jackHostApi->mtx, NULL ), 0 );
-    ASSERT_CALL( pthread_cond_init( &jackHostApi->cond, NULL ), 0 );
+    ASSERT_CALL( sem_init( &jackHostApi->processSem, 0, 0 ), 0 );
+    ASSERT_CALL( sem_init( &jackHostApi->workDoneSem, 0, 0 ), 0 );
 
     /* Try to become a client of the JACK server.  If we cannot do
      * this, then this API cannot be used.
@@ -756,6 +1042,7 @@ PaError PaJack_Initialize( PaUtilHostApiRepresentation **hostApi,
     (*hostApi)->Terminate = Terminate;
     (*hostApi)->OpenStream = OpenStream;
     (*hostApi)->IsFormatSupported = IsFormatSupported;
+    (*hostApi)->UpdateDeviceInfo = NULL;
 
     PaUtil_InitializeStreamInterface( &jackHostApi->callbackStreamInterface,
                                       CloseStream, StartStream,
@@ -771,20 +1058,41 @@ PaError PaJack_Initialize( PaUtilHostApiRepresentation **hostApi,
                                       GetStreamTime, PaUtil_DummyGetCpuLoad,
                                       BlockingReadStream, BlockingWriteStream,
                                       BlockingGetStreamReadAvailable, BlockingGetStreamWriteAvailable );
+    jackHostApi->blockingStreamInterface.GetWriteBuffer = BlockingGetStreamWriteBuffer;
+    jackHostApi->blockingStreamInterface.CommitWriteBuffer = BlockingCommitStreamWriteBuffer;
+    jackHostApi->blockingStreamInterface.ReadTimeout = BlockingReadStreamTimeout;
+    jackHostApi->blockingStreamInterface.WriteTimeout = BlockingWriteStreamTimeout;
+    jackHostApi->blockingStreamInterface.GetPollDescriptor = BlockingGetStreamPollDescriptor;
+    jackHostApi->callbackStreamInterface.StartAt = StartStreamAt;
+    jackHostApi->callbackStreamInterface.StartGroup = StartStreams;
+    jackHostApi->callbackStreamInterface.StopGroup = StopStreams;
+    jackHostApi->blockingStreamInterface.StartAt = StartStreamAt;
+    jackHostApi->blockingStreamInterface.StartGroup = StartStreams;
+    jackHostApi->blockingStreamInterface.StopGroup = StopStreams;
+    jackHostApi->callbackStreamInterface.Prepare = PrepareStream;
+    jackHostApi->blockingStreamInterface.Prepare = PrepareStream;
 
     jackHostApi->inputBase = jackHostApi->outputBase = 0;
     jackHostApi->xrun = 0;
-    jackHostApi->toAdd = jackHostApi->toRemove = NULL;
-    jackHostApi->processQueue = NULL;
+    jackHostApi->processList = jackHostApi->rtProcessList = NULL;
     jackHostApi->jackIsDown = 0;
 
     jack_on_shutdown( jackHostApi->jack_client, JackOnShutdown, jackHostApi );
     jack_set_error_function( JackErrorCallback );
     jackHostApi->jack_buffer_size = jack_get_buffer_size ( jackHostApi->jack_client );
+    jackHostApi->sampleRate = jack_get_sample_rate( jackHostApi->jack_client );
     /* Don't check for error, may not be supported (deprecated in at least jackdmp) */
     jack_set_sample_rate_callback( jackHostApi->jack_client, JackSrCb, jackHostApi );
+    jackHostApi->latencyGeneration = 0;
+    /* Don't check for error, not supported by older servers */
+    jack_set_latency_callback( jackHostApi->jack_client, JackLatencyCb, jackHostApi );
     UNLESS( !jack_set_xrun_callback( jackHostApi->jack_client, JackXRunCb, jackHostApi ), paUnanticipatedHostError );
     UNLESS( !jack_set_process_callback( jackHostApi->jack_client, JackCallback, jackHostApi ), paUnanticipatedHostError );
+
+    /* Independent streams can be spread over several cores, at the cost of waking the workers each cycle */
+    if( workerThreads && atoi( workerThreads ) > 0 )
+        StartWorkers( jackHostApi, atoi( workerThreads ) );
+
     UNLESS( !jack_activate( jackHostApi->jack_client ), paUnanticipatedHostError );
     activated = 1;
 
@@ -796,6 +1104,7 @@ error:
 
     if( jackHostApi )
     {
+        StopWorkers( jackHostApi );
         if( jackHostApi->jack_client )
             ASSERT_CALL( jack_client_close( jackHostApi->jack_client ), 0 );
 
@@ -818,9 +1127,13 @@ static void Terminate( struct PaUtilHostApiRepresentation *hostApi )
     /* note: this automatically disconnects all ports, since a deactivated
      * client is not allowed to have any ports connected */
     ASSERT_CALL( jack_deactivate( jackHostApi->jack_client ), 0 );
+    StopWorkers( jackHostApi );
 
     ASSERT_CALL( pthread_mutex_destroy( &jackHostApi->mtx ), 0 );
-    ASSERT_CALL( pthread_cond_destroy( &jackHostApi->cond ), 0 );
+    ASSERT_CALL( sem_destroy( &jackHostApi->processSem ), 0 );
+    ASSERT_CALL( sem_destroy( &jackHostApi->workDoneSem ), 0 );
+    /* All streams have been closed, but the process thread is gone anyway */
+    PaUtil_FreeMemory( jackHostApi->processList );
 
     ASSERT_CALL( jack_client_close( jackHostApi->jack_client ), 0 );
 
@@ -930,9 +1243,11 @@ static PaError InitializeStream( PaJackStream *stream, PaJackHostApiRepresentati
     assert( stream );
 
     memset( stream, 0, sizeof (PaJackStream) );
+    ASSERT_CALL( sem_init( &stream->stateSem, 0, 0 ), 0 );
     UNLESS( stream->stream_memory = PaUtil_CreateAllocationGroup(), paInsufficientMemory );
     stream->jack_client = hostApi->jack_client;
     stream->hostApi = hostApi;
+    stream->readyFd = -1;
 
     if( numInputChannels > 0 )
     {
@@ -998,43 +1313,108 @@ static void CleanUpStream( PaJackStream *stream, int terminateStreamRepresentati
         PaUtil_FreeAllAllocations( stream->stream_memory );
         PaUtil_DestroyAllocationGroup( stream->stream_memory );
     }
+    ASSERT_CALL( sem_destroy( &stream->stateSem ), 0 );
     PaUtil_FreeMemory( stream );
 }
 
-static PaError WaitCondition( PaJackHostApiRepresentation *hostApi )
+/* Wait for the process thread to post sem, for at most one wait slice.
+ *
+ * The caller re-checks what it is waiting for after each slice, which also lets it notice that JACK has gone away.
+ * paTimedOut is returned once deadline, in terms of PaUtil_GetTime, has passed.
+ */
+static PaError WaitForProcessThread( sem_t *sem, PaTime deadline )
 {
     PaError result = paNoError;
-    int err = 0;
-    PaTime pt = PaUtil_GetTime();
     struct timespec ts;
+    PaTime remaining = deadline - PaUtil_GetTime();
+    int err;
 
-    ts.tv_sec = (time_t) floor( pt + 10 * 60 /* 10 minutes */ );
-    ts.tv_nsec = (long) ((pt - floor( pt )) * 1000000000);
-    /* XXX: Best enclose in loop, in case of spurious wakeups? */
-    err = pthread_cond_timedwait( &hostApi->cond, &hostApi->mtx, &ts );
+    /* Quietly, as running out of time is expected of the timed blocking calls */
+    if( remaining <= 0. )
+        return paTimedOut;
 
-    /* Make sure we didn't time out */
-    UNLESS( err != ETIMEDOUT, paTimedOut );
-    UNLESS( !err, paInternalError );
+    ASSERT_CALL( clock_gettime( CLOCK_REALTIME, &ts ), 0 );
+    ts.tv_nsec += remaining * 1e9 < PA_JACK_WAIT_SLICE_NS_ ? (long)(remaining * 1e9) : PA_JACK_WAIT_SLICE_NS_;
+    if( ts.tv_nsec >= 1000000000 )
+    {
+        ++ts.tv_sec;
+        ts.tv_nsec -= 1000000000;
+    }
+    while( (err = sem_timedwait( sem, &ts )) != 0 && errno == EINTR )
+        ;
+    UNLESS( !err || errno == ETIMEDOUT, paInternalError );
 
 error:
     return result;
 }
 
-static PaError AddStream( PaJackStream *stream )
+/* Replace the process list, adding stream to it or removing it.
+ *
+ * The new list is published with a single pointer store, and the process thread picks it up at the start of its
+ * next cycle. The old list is freed once the process thread has acknowledged this, so a change takes effect within
+ * one JACK cycle. The process thread never waits on the main thread.
+ */
+static PaError ReplaceProcessList( PaJackHostApiRepresentation *hostApi, PaJackStream *stream, int add )
 {
     PaError result = paNoError;
-    PaJackHostApiRepresentation *hostApi = stream->hostApi;
-    /* Add to queue of streams that should be processed */
+    PaJackProcessList *oldList, *newList = NULL;
+    int numStreams, i, j;
+    PaTime deadline = PaUtil_GetTime() + PA_JACK_WAIT_TIMEOUT_;
+
     ASSERT_CALL( pthread_mutex_lock( &hostApi->mtx ), 0 );
-    if( !hostApi->jackIsDown )
+
+    oldList = hostApi->processList;
+    numStreams = ( oldList ? oldList->numStreams : 0 ) + ( add ? 1 : -1 );
+    if( numStreams > 0 )
+    {
+        UNLESS( newList = (PaJackProcessList *)PaUtil_AllocateMemory( sizeof (PaJackProcessList) +
+                    numStreams * sizeof (PaJackStream *) ), paInsufficientMemory );
+        newList->streams = (PaJackStream **)( newList + 1 );
+        for( i = 0, j = 0; oldList && i < oldList->numStreams; ++i )
+        {
+            if( oldList->streams[i] != stream )
+                newList->streams[j++] = oldList->streams[i];
+        }
+        if( add )
+            newList->streams[j++] = stream;
+        UNLESS( j == numStreams, paInternalError );
+        newList->numStreams = numStreams;
+    }
+
+    /* The list has to be complete before the process thread can see it */
+    PaUtil_WriteMemoryBarrier();
+    hostApi->processList = newList;
+    newList = NULL;
+
+    while( hostApi->rtProcessList != hostApi->processList && !hostApi->jackIsDown )
     {
-        hostApi->toAdd = stream;
-        /* Unlock mutex and await signal from processing thread */
-        result = WaitCondition( stream->hostApi );
+        result = WaitForProcessThread( &hostApi->processSem, deadline );
+        if( result != paNoError )
+        {
+            /* The process thread may still be using the old list, let it leak */
+            oldList = NULL;
+            break;
+        }
     }
+    PaUtil_FreeMemory( oldList );
+
+error:
     ASSERT_CALL( pthread_mutex_unlock( &hostApi->mtx ), 0 );
-    ENSURE_PA( result );
+    PaUtil_FreeMemory( newList );
+    return result;
+}
+
+static PaError AddStream( PaJackStream *stream )
+{
+    PaError result = paNoError;
+    PaJackHostApiRepresentation *hostApi = stream->hostApi;
+
+    UNLESS( !hostApi->jackIsDown, paDeviceUnavailable );
+    if( stream->streamRepresentation.streamInfo.sampleRate != hostApi->sampleRate )
+        UpdateSampleRate( stream, hostApi->sampleRate );
+
+    /* Add to list of streams that should be processed */
+    ENSURE_PA( ReplaceProcessList( hostApi, stream, 1 ) );
 
     UNLESS( !hostApi->jackIsDown, paDeviceUnavailable );
 
@@ -1046,18 +1426,8 @@ error:
 static PaError RemoveStream( PaJackStream *stream )
 {
     PaError result = paNoError;
-    PaJackHostApiRepresentation *hostApi = stream->hostApi;
 
-    /* Add to queue over streams that should be processed */
-    ASSERT_CALL( pthread_mutex_lock( &hostApi->mtx ), 0 );
-    if( !hostApi->jackIsDown )
-    {
-        hostApi->toRemove = stream;
-        /* Unlock mutex and await signal from processing thread */
-        result = WaitCondition( stream->hostApi );
-    }
-    ASSERT_CALL( pthread_mutex_unlock( &hostApi->mtx ), 0 );
-    ENSURE_PA( result );
+    ENSURE_PA( ReplaceProcessList( stream->hostApi, stream, 0 ) );
 
 error:
     return result;
@@ -1078,15 +1448,13 @@ static PaError OpenStream( struct PaUtilHostApiRepresentation *hostApi,
     PaJackHostApiRepresentation *jackHostApi = (PaJackHostApiRepresentation*)hostApi;
     PaJackStream *stream = NULL;
     char *port_string = PaUtil_GroupAllocateMemory( jackHostApi->deviceInfoMemory, jack_port_name_size() );
-    unsigned long regexSz = jack_client_name_size() + 3;
-    char *regex_pattern = PaUtil_GroupAllocateMemory( jackHostApi->deviceInfoMemory, regexSz );
-    const char **jack_ports = NULL;
     /* int jack_max_buffer_size = jack_get_buffer_size( jackHostApi->jack_client ); */
     int i;
     int inputChannelCount, outputChannelCount;
     const double jackSr = jack_get_sample_rate( jackHostApi->jack_client );
     PaSampleFormat inputSampleFormat = 0, outputSampleFormat = 0;
     int bpInitialized = 0, srInitialized = 0;   /* Initialized buffer processor and stream representation? */
+    int minimum_buffer_frames = 0;  /* Of the blocking emulation */
     unsigned long ofs;
 
     /* validate platform specific flags */
@@ -1170,7 +1538,6 @@ static PaError OpenStream( struct PaUtilHostApiRepresentation *hostApi,
     if( stream->isBlockingStream )
     {
         float latency = 0.001; /* 1ms is the absolute minimum we support */
-        int   minimum_buffer_frames = 0;
 
         if( inputParameters && inputParameters->suggestedLatency > latency )
             latency = inputParameters->suggestedLatency;
@@ -1184,13 +1551,6 @@ static PaError OpenStream( struct PaUtilHostApiRepresentation *hostApi,
         if( jackHostApi->jack_buffer_size * 3 > minimum_buffer_frames )
             minimum_buffer_frames = jackHostApi->jack_buffer_size * 3;
 
-        /* setup blocking API data structures (FIXME: can fail) */
-        BlockingBegin( stream, minimum_buffer_frames );
-
-        /* install our own callback for the blocking API */
-        streamCallback = BlockingCallback;
-        userData = stream;
-
         PaUtil_InitializeStreamRepresentation( &stream->streamRepresentation,
                                                &jackHostApi->blockingStreamInterface, streamCallback, userData );
     }
@@ -1234,60 +1594,41 @@ static PaError OpenStream( struct PaUtilHostApiRepresentation *hostApi,
 
     if( inputChannelCount > 0 )
     {
-        int err = 0;
+        /* Output ports of our capture device, as found when building the device list */
+        const PaJackClientPorts *clientPorts = &jackHostApi->clientPorts[ inputParameters->device ];
 
-        /* Get output ports of our capture device */
-        snprintf( regex_pattern, regexSz, "%s:.*", hostApi->deviceInfos[ inputParameters->device ]->name );
-        UNLESS( jack_ports = jack_get_ports( jackHostApi->jack_client, regex_pattern,
-                                     JACK_PORT_TYPE_FILTER, JackPortIsOutput ), paUnanticipatedHostError );
-        for( i = 0; i < inputChannelCount && jack_ports[i]; i++ )
+        /* Fewer ports than expected? */
+        UNLESS( clientPorts->numOutputPorts >= inputChannelCount, paInternalError );
+        for( i = 0; i < inputChannelCount; i++ )
         {
-            if( (stream->remote_output_ports[i] = jack_port_by_name(
-                 jackHostApi->jack_client, jack_ports[i] )) == NULL )
-            {
-                err = 1;
-                break;
-            }
+            /* The port may have gone away since */
+            UNLESS( stream->remote_output_ports[i] = jack_port_by_name(
+                        jackHostApi->jack_client, clientPorts->outputPorts[i] ), paDeviceUnavailable );
         }
-        free( jack_ports );
-        UNLESS( !err, paInsufficientMemory );
-
-        /* Fewer ports than expected? */
-        UNLESS( i == inputChannelCount, paInternalError );
     }
 
     if( outputChannelCount > 0 )
     {
-        int err = 0;
+        /* Input ports of our playback device */
+        const PaJackClientPorts *clientPorts = &jackHostApi->clientPorts[ outputParameters->device ];
 
-        /* Get input ports of our playback device */
-        snprintf( regex_pattern, regexSz, "%s:.*", hostApi->deviceInfos[ outputParameters->device ]->name );
-        UNLESS( jack_ports = jack_get_ports( jackHostApi->jack_client, regex_pattern,
-                                     JACK_PORT_TYPE_FILTER, JackPortIsInput ), paUnanticipatedHostError );
-        for( i = 0; i < outputChannelCount && jack_ports[i]; i++ )
+        UNLESS( clientPorts->numInputPorts >= outputChannelCount, paInternalError );
+        for( i = 0; i < outputChannelCount; i++ )
         {
-            if( (stream->remote_input_ports[i] = jack_port_by_name(
-                 jackHostApi->jack_client, jack_ports[i] )) == 0 )
-            {
-                err = 1;
-                break;
-            }
+            UNLESS( stream->remote_input_ports[i] = jack_port_by_name(
+                        jackHostApi->jack_client, clientPorts->inputPorts[i] ), paDeviceUnavailable );
         }
-        free( jack_ports );
-        UNLESS( !err , paInsufficientMemory );
-
-        /* Fewer ports than expected? */
-        UNLESS( i == outputChannelCount, paInternalError );
     }
 
     ENSURE_PA( PaUtil_InitializeBufferProcessor(
                   &stream->bufferProcessor,
                   inputChannelCount,
                   inputSampleFormat,
-                  paFloat32 | paNonInterleaved, /* hostInputSampleFormat */
+                  /* Blocking streams convert between the user's buffers and their interleaved FIFOs */
+                  stream->isBlockingStream ? paFloat32 : paFloat32 | paNonInterleaved, /* hostInputSampleFormat */
                   outputChannelCount,
                   outputSampleFormat,
-                  paFloat32 | paNonInterleaved, /* hostOutputSampleFormat */
+                  stream->isBlockingStream ? paFloat32 : paFloat32 | paNonInterleaved, /* hostOutputSampleFormat */
                   jackSr,
                   streamFlags,
                   framesPerBuffer,
@@ -1297,16 +1638,12 @@ static PaError OpenStream( struct PaUtilHostApiRepresentation *hostApi,
                   userData ) );
     bpInitialized = 1;
 
-    if( stream->num_incoming_connections > 0 )
-        stream->streamRepresentation.streamInfo.inputLatency = (jack_port_get_latency( stream->remote_output_ports[0] )
-                - jack_get_buffer_size( jackHostApi->jack_client )  /* One buffer is not counted as latency */
-            + PaUtil_GetBufferProcessorInputLatencyFrames( &stream->bufferProcessor )) / sampleRate;
-    if( stream->num_outgoing_connections > 0 )
-        stream->streamRepresentation.streamInfo.outputLatency = (jack_port_get_latency( stream->remote_input_ports[0] )
-                - jack_get_buffer_size( jackHostApi->jack_client )  /* One buffer is not counted as latency */
-            + PaUtil_GetBufferProcessorOutputLatencyFrames( &stream->bufferProcessor )) / sampleRate;
+    /* setup blocking API data structures */
+    if( stream->isBlockingStream )
+        ENSURE_PA( BlockingBegin( stream, minimum_buffer_frames ) );
 
     stream->streamRepresentation.streamInfo.sampleRate = jackSr;
+    UpdateStreamLatency( stream );
     stream->t0 = jack_frame_time( jackHostApi->jack_client );   /* A: Time should run from Pa_OpenStream */
 
     /* Add to queue of opened streams */
@@ -1346,13 +1683,14 @@ static PaError RealProcess( PaJackStream *stream, jack_nframes_t frames )
     PaStreamCallbackTimeInfo timeInfo = {0,0,0};
     int chn;
     int framesProcessed;
-    const double sr = jack_get_sample_rate( stream->jack_client );    /* Shouldn't change during the process callback */
+    const double sr = stream->streamRepresentation.streamInfo.sampleRate;  /* Kept up to date by the process thread */
     PaStreamCallbackFlags cbFlags = 0;
 
     /* If the user has returned !paContinue from the callback we'll want to flush the internal buffers,
-     * when these are empty we can finally mark the stream as inactive */
+     * when these are empty we can finally mark the stream as inactive. The buffer processor of a blocking stream
+     * belongs to the user's thread, its FIFO has been drained before stopping. */
     if( stream->callbackResult != paContinue &&
-            PaUtil_IsBufferProcessorOutputEmpty( &stream->bufferProcessor ) )
+            (stream->isBlockingStream || PaUtil_IsBufferProcessorOutputEmpty( &stream->bufferProcessor )) )
     {
         stream->is_active = 0;
         if( stream->streamRepresentation.streamFinishedCallback )
@@ -1362,13 +1700,22 @@ static PaError RealProcess( PaJackStream *stream, jack_nframes_t frames )
         goto end;
     }
 
+    /* Blocking streams report latencies in their stream info too */
+    if( stream->latencyGeneration != stream->hostApi->latencyGeneration )
+        UpdateStreamLatency( stream );
+
+    if( stream->isBlockingStream )
+    {
+        BlockingProcess( stream, frames );
+        goto end;
+    }
+
+    /* Use the upper end of the latency ranges, which is what the slowest connection sees */
     timeInfo.currentTime = (jack_frame_time( stream->jack_client ) - stream->t0) / sr;
     if( stream->num_incoming_connections > 0 )
-        timeInfo.inputBufferAdcTime = timeInfo.currentTime - jack_port_get_latency( stream->remote_output_ports[0] )
-            / sr;
+        timeInfo.inputBufferAdcTime = GetCycleTime( stream, sr ) - stream->captureLatency.max / sr;
     if( stream->num_outgoing_connections > 0 )
-        timeInfo.outputBufferDacTime = timeInfo.currentTime + jack_port_get_latency( stream->remote_input_ports[0] )
-            / sr;
+        timeInfo.outputBufferDacTime = GetCycleTime( stream, sr ) + stream->playbackLatency.max / sr;
 
     PaUtil_BeginCpuLoadMeasurement( &stream->cpuLoadMeasurer );
 
@@ -1419,188 +1766,276 @@ end:
     return result;
 }
 
-/* Update the JACK callback's stream processing queue. */
-static PaError UpdateQueue( PaJackHostApiRepresentation *hostApi )
+/* Pick up the process list most recently published by the main thread.
+ *
+ * Once the process thread has moved on to a new list it no longer references the previous one, which the main
+ * thread is then told it can free.
+ *
+ * Held streams are released here as well, before any stream is processed, so that a group started or stopped by
+ * StartStreams or StopStreams changes state within the same cycle.
+ */
+static PaJackProcessList *UpdateQueue( PaJackHostApiRepresentation *hostApi )
+{
+    PaJackProcessList *list = hostApi->processList;
+    int i;
+
+    /* Make sure the list's contents are read after the pointer */
+    PaUtil_ReadMemoryBarrier();
+    if( list != hostApi->rtProcessList )
+    {
+        hostApi->rtProcessList = list;
+        sem_post( &hostApi->processSem );
+    }
+
+    if( hostApi->releaseHeld )
+    {
+        /* Pairs with the barrier before releaseHeld is set */
+        PaUtil_ReadMemoryBarrier();
+        for( i = 0; list && i < list->numStreams; ++i )
+            list->streams[i]->isHeld = 0;
+        hostApi->releaseHeld = 0;
+    }
+
+    return list;
+}
+
+/* Carry out one cycle's worth of work for stream.
+ *
+ * Streams share no state during processing, so this may be called for different streams concurrently.
+ */
+static PaError ProcessStream( PaJackStream *stream, jack_nframes_t frames, double sampleRate, int xrun )
 {
     PaError result = paNoError;
-    int queueModified = 0;
-    const double jackSr = jack_get_sample_rate( hostApi->jack_client );
-    int err;
+    int isHeld = 0;
 
-    if( (err = pthread_mutex_trylock( &hostApi->mtx )) != 0 )
+    if( xrun )  /* Don't override if already set */
+        stream->xrun = 1;
+
+    if( stream->streamRepresentation.streamInfo.sampleRate != sampleRate )
     {
-        assert( err == EBUSY );
-        return paNoError;
+        PA_DEBUG(( "%s: Updating samplerate\n", __FUNCTION__ ));
+        UpdateSampleRate( stream, sampleRate );
     }
 
-    if( hostApi->toAdd )
+    /* A request is made after isHeld has been set, see StartStreams */
+    if( stream->doStart || stream->doStop || stream->doAbort )
     {
-        if( hostApi->processQueue )
+        PaUtil_ReadMemoryBarrier();
+        isHeld = stream->isHeld;
+    }
+
+    /* See if this stream is to be started */
+    if( stream->doStart && !isHeld )
+    {
+        if( stream->isBlockingStream )
+            BlockingScheduleStart( stream, sampleRate );
+        stream->is_active = 1;
+        stream->callbackResult = paContinue;
+        stream->isSilenced = 0;
+        PA_DEBUG(( "%s: Starting stream\n", __FUNCTION__ ));
+
+        /* The stream state has to be visible before the main thread sees the request carried out */
+        PaUtil_WriteMemoryBarrier();
+        stream->doStart = 0;
+        sem_post( &stream->stateSem );
+    }
+    else if( (stream->doStop || stream->doAbort) && !isHeld )  /* Should we stop/abort stream? */
+    {
+        if( stream->callbackResult == paContinue )     /* Ok, make it stop */
         {
-            PaJackStream *node = hostApi->processQueue;
-            /* Advance to end of queue */
-            while( node->next )
-                node = node->next;
+            PA_DEBUG(( "%s: Stopping stream\n", __FUNCTION__ ));
+            stream->callbackResult = stream->doStop ? paComplete : paAbort;
+        }
+    }
 
-            node->next = hostApi->toAdd;
+    if( stream->is_active )
+        ENSURE_PA( RealProcess( stream, frames ) );
+    /* If we have just entered inactive state, silence output */
+    if( !stream->is_active && !stream->isSilenced )
+    {
+        int i;
+
+        /* Silence buffer after entering inactive state */
+        PA_DEBUG(( "Silencing the output\n" ));
+        for( i = 0; i < stream->num_outgoing_connections; ++i )
+        {
+            jack_default_audio_sample_t *buffer = jack_port_get_buffer( stream->local_output_ports[i], frames );
+            memset( buffer, 0, sizeof (jack_default_audio_sample_t) * frames );
         }
-        else
+
+        stream->isSilenced = 1;
+    }
+
+    if( (stream->doStop || stream->doAbort) && !isHeld )
+    {
+        /* See if RealProcess has acted on the request */
+        if( !stream->is_active )   /* Ok, signal to the main thread that we've carried out the operation */
         {
-            /* The only queue entry. */
-            hostApi->processQueue = (PaJackStream *)hostApi->toAdd;
+            PaUtil_WriteMemoryBarrier();
+            stream->doStop = stream->doAbort = 0;
+            sem_post( &stream->stateSem );
         }
+    }
 
-        /* If necessary, update stream state */
-        if( hostApi->toAdd->streamRepresentation.streamInfo.sampleRate != jackSr )
-            UpdateSampleRate( hostApi->toAdd, jackSr );
+error:
+    return result;
+}
 
-        hostApi->toAdd = NULL;
-        queueModified = 1;
+/* Process streams of the current cycle until there are none left to claim.
+ *
+ * Called by the process thread and the workers woken for the cycle alike, each stream is claimed by exactly one of
+ * them.
+ */
+static void ProcessClaimedStreams( PaJackHostApiRepresentation *hostApi )
+{
+    PaJackProcessList *list = hostApi->cycleList;
+    int i;
+
+    while( (i = __sync_fetch_and_add( &hostApi->nextStream, 1 )) < list->numStreams )
+    {
+        if( ProcessStream( list->streams[i], hostApi->cycleFrames, hostApi->cycleSampleRate,
+                    hostApi->cycleXrun ) != paNoError )
+            hostApi->cycleFailed = 1;
     }
-    if( hostApi->toRemove )
+}
+
+static void *WorkerThreadFunc( void *userData )
+{
+    PaJackWorker *worker = (PaJackWorker *)userData;
+    PaJackHostApiRepresentation *hostApi = worker->hostApi;
+
+    for( ;; )
     {
-        int removed = 0;
-        PaJackStream *node = hostApi->processQueue, *prev = NULL;
-        assert( hostApi->processQueue );
+        /* Parked until the process thread has work for us */
+        while( sem_wait( &worker->wakeSem ) != 0 && errno == EINTR )
+            ;
+        if( hostApi->quitWorkers )
+            break;
+
+        PaUtil_ReadMemoryBarrier();
+        ProcessClaimedStreams( hostApi );
+        sem_post( &hostApi->workDoneSem );
+    }
 
-        while( node )
-        {
-            if( node == hostApi->toRemove )
-            {
-                if( prev )
-                    prev->next = node->next;
-                else
-                    hostApi->processQueue = (PaJackStream *)node->next;
+    return NULL;
+}
 
-                removed = 1;
-                break;
-            }
+/* Start the worker threads, with the same scheduling as the JACK process thread.
+ *
+ * Workers that cannot be created are done without, the process thread takes on their share.
+ */
+static void StartWorkers( PaJackHostApiRepresentation *hostApi, int numWorkers )
+{
+    int i;
+
+    numWorkers = numWorkers < PA_JACK_MAX_WORKER_THREADS_ ? numWorkers : PA_JACK_MAX_WORKER_THREADS_;
+    hostApi->quitWorkers = 0;
+    if( !(hostApi->workers = (PaJackWorker *)PaUtil_AllocateMemory( numWorkers * sizeof (PaJackWorker) )) )
+        return;
+
+    for( i = 0; i < numWorkers; ++i )
+    {
+        PaJackWorker *worker = &hostApi->workers[i];
 
-            prev = node;
-            node = node->next;
+        worker->hostApi = hostApi;
+        ASSERT_CALL( sem_init( &worker->wakeSem, 0, 0 ), 0 );
+        if( jack_client_create_thread( hostApi->jack_client, &worker->thread,
+                    jack_client_real_time_priority( hostApi->jack_client ), jack_is_realtime( hostApi->jack_client ),
+                    WorkerThreadFunc, worker ) != 0 )
+        {
+            PA_DEBUG(( "%s: Failed to create worker thread %d\n", __FUNCTION__, i ));
+            ASSERT_CALL( sem_destroy( &worker->wakeSem ), 0 );
+            break;
         }
-        UNLESS( removed, paInternalError );
-        hostApi->toRemove = NULL;
-        PA_DEBUG(( "%s: Removed stream from processing queue\n", __FUNCTION__ ));
-        queueModified = 1;
     }
+    hostApi->numWorkers = i;
+    PA_DEBUG(( "%s: Started %d worker threads\n", __FUNCTION__, i ));
+}
+
+static void StopWorkers( PaJackHostApiRepresentation *hostApi )
+{
+    int i;
 
-    if( queueModified )
+    hostApi->quitWorkers = 1;
+    PaUtil_WriteMemoryBarrier();
+    for( i = 0; i < hostApi->numWorkers; ++i )
+        sem_post( &hostApi->workers[i].wakeSem );
+    for( i = 0; i < hostApi->numWorkers; ++i )
     {
-        /* Signal that we've done what was asked of us */
-        ASSERT_CALL( pthread_cond_signal( &hostApi->cond ), 0 );
+        ASSERT_CALL( pthread_join( hostApi->workers[i].thread, NULL ), 0 );
+        ASSERT_CALL( sem_destroy( &hostApi->workers[i].wakeSem ), 0 );
     }
 
-error:
-    ASSERT_CALL( pthread_mutex_unlock( &hostApi->mtx ), 0 );
-
-    return result;
+    PaUtil_FreeMemory( hostApi->workers );
+    hostApi->workers = NULL;
+    hostApi->numWorkers = 0;
 }
 
 /* Audio processing callback invoked periodically from JACK. */
 static int JackCallback( jack_nframes_t frames, void *userData )
 {
-    PaError result = paNoError;
     PaJackHostApiRepresentation *hostApi = (PaJackHostApiRepresentation *)userData;
-    PaJackStream *stream = NULL;
+    PaJackProcessList *list;
+    const double sampleRate = hostApi->sampleRate;
     int xrun = hostApi->xrun;
+    int i, numWoken;
     hostApi->xrun = 0;
 
     assert( hostApi );
 
-    ENSURE_PA( UpdateQueue( hostApi ) );
+    list = UpdateQueue( hostApi );
+    if( !list )
+        return 0;
 
-    /* Process each stream */
-    stream = hostApi->processQueue;
-    for( ; stream; stream = stream->next )
+    if( hostApi->numWorkers == 0 || list->numStreams == 1 )
     {
-        if( xrun )  /* Don't override if already set */
-            stream->xrun = 1;
-
-        /* See if this stream is to be started */
-        if( stream->doStart )
-        {
-            /* If we can't obtain a lock, we'll try next time */
-            int err = pthread_mutex_trylock( &stream->hostApi->mtx );
-            if( !err )
-            {
-                if( stream->doStart )   /* Could potentially change before obtaining the lock */
-                {
-                    stream->is_active = 1;
-                    stream->doStart = 0;
-                    PA_DEBUG(( "%s: Starting stream\n", __FUNCTION__ ));
-                    ASSERT_CALL( pthread_cond_signal( &stream->hostApi->cond ), 0 );
-                    stream->callbackResult = paContinue;
-                    stream->isSilenced = 0;
-                }
-
-                ASSERT_CALL( pthread_mutex_unlock( &stream->hostApi->mtx ), 0 );
-            }
-            else
-                assert( err == EBUSY );
-        }
-        else if( stream->doStop || stream->doAbort )    /* Should we stop/abort stream? */
+        /* Process each stream */
+        for( i = 0; i < list->numStreams; ++i )
         {
-            if( stream->callbackResult == paContinue )     /* Ok, make it stop */
-            {
-                PA_DEBUG(( "%s: Stopping stream\n", __FUNCTION__ ));
-                stream->callbackResult = stream->doStop ? paComplete : paAbort;
-            }
-        }
-
-        if( stream->is_active )
-            ENSURE_PA( RealProcess( stream, frames ) );
-        /* If we have just entered inactive state, silence output */
-        if( !stream->is_active && !stream->isSilenced )
-        {
-            int i;
-
-            /* Silence buffer after entering inactive state */
-            PA_DEBUG(( "Silencing the output\n" ));
-            for( i = 0; i < stream->num_outgoing_connections; ++i )
-            {
-                jack_default_audio_sample_t *buffer = jack_port_get_buffer( stream->local_output_ports[i], frames );
-                memset( buffer, 0, sizeof (jack_default_audio_sample_t) * frames );
-            }
-
-            stream->isSilenced = 1;
+            if( ProcessStream( list->streams[i], frames, sampleRate, xrun ) != paNoError )
+                return -1;
         }
+        return 0;
+    }
 
-        if( stream->doStop || stream->doAbort )
-        {
-            /* See if RealProcess has acted on the request */
-            if( !stream->is_active )   /* Ok, signal to the main thread that we've carried out the operation */
-            {
-                /* If we can't obtain a lock, we'll try next time */
-                int err = pthread_mutex_trylock( &stream->hostApi->mtx );
-                if( !err )
-                {
-                    stream->doStop = stream->doAbort = 0;
-                    ASSERT_CALL( pthread_cond_signal( &stream->hostApi->cond ), 0 );
-                    ASSERT_CALL( pthread_mutex_unlock( &stream->hostApi->mtx ), 0 );
-                }
-                else
-                    assert( err == EBUSY );
-            }
-        }
+    /* Let as many workers as there are streams beyond our own help out, and wait for all of them to finish before
+     * returning to JACK */
+    hostApi->cycleList = list;
+    hostApi->cycleFrames = frames;
+    hostApi->cycleSampleRate = sampleRate;
+    hostApi->cycleXrun = xrun;
+    hostApi->nextStream = 0;
+    hostApi->cycleFailed = 0;
+    PaUtil_WriteMemoryBarrier();
+
+    numWoken = list->numStreams - 1 < hostApi->numWorkers ? list->numStreams - 1 : hostApi->numWorkers;
+    for( i = 0; i < numWoken; ++i )
+        sem_post( &hostApi->workers[i].wakeSem );
+    ProcessClaimedStreams( hostApi );
+    for( i = 0; i < numWoken; ++i )
+    {
+        while( sem_wait( &hostApi->workDoneSem ) != 0 && errno == EINTR )
+            ;
     }
+    PaUtil_ReadMemoryBarrier();
 
-    return 0;
-error:
-    return -1;
+    return hostApi->cycleFailed ? -1 : 0;
 }
 
 static PaError StartStream( PaStream *s )
+{
+    return StartStreamAt( s, 0. );
+}
+
+/* Connect the stream's ports to those of the client we are connecting to. Each connection is a request to the
+ * JACK server */
+static PaError ConnectPorts( PaJackStream *stream )
 {
     PaError result = paNoError;
-    PaJackStream *stream = (PaJackStream*)s;
     int i;
 
-    /* Ready the processor */
-    PaUtil_ResetBufferProcessor( &stream->bufferProcessor );
-
-    /* Connect the ports. Note that the ports may already have been connected by someone else in
-     * the meantime, in which case JACK returns EEXIST. */
+    /* Note that the ports may already have been connected by someone else in the meantime, in which case JACK
+     * returns EEXIST. */
 
     if( stream->num_incoming_connections > 0 )
     {
@@ -1622,29 +2057,78 @@ static PaError StartStream( PaStream *s )
         }
     }
 
+error:
+    return result;
+}
+
+/* Connect the ports of a stopped stream ahead of its start, so that the start is left with a single cycle of the
+ * process thread. The ports of an inactive stream carry silence. They are disconnected again when the stream is
+ * stopped, or unregistered when it is closed */
+static PaError PrepareStream( PaStream *s )
+{
+    PaError result = paNoError;
+    PaJackStream *stream = (PaJackStream*)s;
+
+    if( stream->isPrepared )
+        goto error;
+
+    ENSURE_PA( ConnectPorts( stream ) );
+    stream->isPrepared = 1;
+
+error:
+    return result;
+}
+
+/* Ready a stream to be started at when and connect its ports unless PrepareStream has, the start is requested by
+ * setting doStart.
+ *
+ * The buffer processor of a callback stream outputs silence until when, a blocking stream works out its delays in
+ * the process thread, see BlockingScheduleStart. when is 0 for an immediate start */
+static PaError PrepareStart( PaJackStream *stream, PaTime when )
+{
+    PaError result = paNoError;
+
+    /* Ready the processor */
+    PaUtil_ResetBufferProcessor( &stream->bufferProcessor );
+    if( stream->isBlockingStream )
+    {
+        PaUtil_ResetBlockingAdapter( &stream->blockingAdapter );
+        stream->blockingStartTime = when;
+    }
+    else if( when > 0. )
+    {
+        PaUtil_SetBufferProcessorStartTime( &stream->bufferProcessor, when );
+    }
+
+    if( !stream->isPrepared )
+        ENSURE_PA( ConnectPorts( stream ) );
+    stream->isPrepared = 0;
+
     stream->xrun = FALSE;
 
-    /* Enable processing */
+error:
+    return result;
+}
 
-    ASSERT_CALL( pthread_mutex_lock( &stream->hostApi->mtx ), 0 );
-    stream->doStart = 1;
+/* Wait for the process thread to act on doStart */
+static PaError FinishStart( PaJackStream *stream, PaTime deadline )
+{
+    PaError result = paNoError;
 
-    /* Wait for stream to be started */
-    result = WaitCondition( stream->hostApi );
-    /*
-    do
+    while( stream->doStart && !stream->hostApi->jackIsDown )
     {
-        err = pthread_cond_timedwait( &stream->hostApi->cond, &stream->hostApi->mtx, &ts );
-    } while( !stream->is_active && !err );
-    */
-    if( result != paNoError )   /* Something went wrong, call off the stream start */
+        if( (result = WaitForProcessThread( &stream->stateSem, deadline )) != paNoError )
+            break;
+    }
+    if( result != paNoError || stream->hostApi->jackIsDown )   /* Something went wrong, call off the stream start */
     {
         stream->doStart = 0;
+        stream->isHeld = 0;
         stream->is_active = 0;  /* Cancel any processing */
     }
-    ASSERT_CALL( pthread_mutex_unlock( &stream->hostApi->mtx ), 0 );
 
     ENSURE_PA( result );
+    UNLESS( !stream->hostApi->jackIsDown, paDeviceUnavailable );
 
     stream->is_running = TRUE;
     PA_DEBUG(( "%s: Stream started\n", __FUNCTION__ ));
@@ -1653,25 +2137,38 @@ error:
     return result;
 }
 
-static PaError RealStop( PaJackStream *stream, int abort )
+static PaError StartStreamAt( PaStream *s, PaTime when )
 {
     PaError result = paNoError;
-    int i;
+    PaJackStream *stream = (PaJackStream*)s;
+    PaTime deadline;
 
-    if( stream->isBlockingStream )
-        BlockingWaitEmpty ( stream );
+    ENSURE_PA( PrepareStart( stream, when ) );
 
-    ASSERT_CALL( pthread_mutex_lock( &stream->hostApi->mtx ), 0 );
-    if( abort )
-        stream->doAbort = 1;
-    else
-        stream->doStop = 1;
+    /* Enable processing, the process thread acts on this in its next cycle */
+    deadline = PaUtil_GetTime() + PA_JACK_WAIT_TIMEOUT_;
+    stream->doStart = 1;
+    ENSURE_PA( FinishStart( stream, deadline ) );
 
-    /* Wait for stream to be stopped */
-    result = WaitCondition( stream->hostApi );
-    ASSERT_CALL( pthread_mutex_unlock( &stream->hostApi->mtx ), 0 );
-    ENSURE_PA( result );
+error:
+    return result;
+}
+
+/* Wait for the process thread to act on doStop or doAbort, then disconnect the stream's ports */
+static PaError FinishStop( PaJackStream *stream, PaTime deadline )
+{
+    PaError result = paNoError;
+    int i;
+
+    while( (stream->doStop || stream->doAbort) && !stream->hostApi->jackIsDown )
+        ENSURE_PA( WaitForProcessThread( &stream->stateSem, deadline ) );
 
+    if( stream->hostApi->jackIsDown )
+    {
+        /* Nothing is being processed anymore */
+        stream->doStop = stream->doAbort = 0;
+        stream->is_active = 0;
+    }
     UNLESS( !stream->is_active, paInternalError );
 
     PA_DEBUG(( "%s: Stream stopped\n", __FUNCTION__ ));
@@ -1704,6 +2201,22 @@ error:
     return result;
 }
 
+static PaError RealStop( PaJackStream *stream, int abort )
+{
+    PaTime deadline;
+
+    if( stream->isBlockingStream )
+        BlockingWaitEmpty ( stream );
+
+    deadline = PaUtil_GetTime() + PA_JACK_WAIT_TIMEOUT_;
+    if( abort )
+        stream->doAbort = 1;
+    else
+        stream->doStop = 1;
+
+    return FinishStop( stream, deadline );
+}
+
 static PaError StopStream( PaStream *s )
 {
     assert(s);
@@ -1716,6 +2229,91 @@ static PaError AbortStream( PaStream *s )
     return RealStop( (PaJackStream *)s, 1 );
 }
 
+/* Start a group of streams in the same cycle. Their requests are held back until all have been made, to be
+ * released together by UpdateQueue. One group is dealt with at a time */
+static PaError StartStreams( PaStream **s, int count )
+{
+    PaError result = paNoError, error;
+    PaJackStream **streams = (PaJackStream **)s;
+    PaJackHostApiRepresentation *hostApi = streams[0]->hostApi;
+    PaTime deadline;
+    int i;
+
+    for( i = 0; i < count; ++i )
+        ENSURE_PA( PrepareStart( streams[i], 0. ) );
+
+    ASSERT_CALL( pthread_mutex_lock( &hostApi->mtx ), 0 );
+
+    /* Every stream is held before any request is made, or the process thread could act on a request while the rest
+     * of the group is still being set up */
+    deadline = PaUtil_GetTime() + PA_JACK_WAIT_TIMEOUT_;
+    for( i = 0; i < count; ++i )
+        streams[i]->isHeld = 1;
+    PaUtil_WriteMemoryBarrier();
+    for( i = 0; i < count; ++i )
+        streams[i]->doStart = 1;
+    PaUtil_WriteMemoryBarrier();
+    hostApi->releaseHeld = 1;
+
+    for( i = 0; i < count; ++i )
+    {
+        error = FinishStart( streams[i], deadline );
+        if( result == paNoError )
+            result = error;
+    }
+
+    ASSERT_CALL( pthread_mutex_unlock( &hostApi->mtx ), 0 );
+
+    /* Take back a partial start */
+    for( i = 0; result != paNoError && i < count; ++i )
+    {
+        if( streams[i]->is_running )
+            RealStop( streams[i], 1 );
+    }
+
+error:
+    return result;
+}
+
+/* Stop a group of streams in the same cycle, see StartStreams. Blocking streams play out what has been written to
+ * them first */
+static PaError StopStreams( PaStream **s, int count )
+{
+    PaError result = paNoError, error;
+    PaJackStream **streams = (PaJackStream **)s;
+    PaJackHostApiRepresentation *hostApi = streams[0]->hostApi;
+    PaTime deadline;
+    int i;
+
+    for( i = 0; i < count; ++i )
+    {
+        if( streams[i]->isBlockingStream )
+            BlockingWaitEmpty( streams[i] );
+    }
+
+    ASSERT_CALL( pthread_mutex_lock( &hostApi->mtx ), 0 );
+
+    deadline = PaUtil_GetTime() + PA_JACK_WAIT_TIMEOUT_;
+    for( i = 0; i < count; ++i )
+        streams[i]->isHeld = 1;
+    PaUtil_WriteMemoryBarrier();
+    for( i = 0; i < count; ++i )
+        streams[i]->doStop = 1;
+    PaUtil_WriteMemoryBarrier();
+    hostApi->releaseHeld = 1;
+
+    for( i = 0; i < count; ++i )
+    {
+        error = FinishStop( streams[i], deadline );
+        if( result == paNoError )
+            result = error;
+    }
+
+    ASSERT_CALL( pthread_mutex_unlock( &hostApi->mtx ), 0 );
+
+    return result;
+}
+
 static PaError IsStreamStopped( PaStream *s )
 {
     PaJackStream *stream = (PaJackStream*)s;
@@ -1726,10 +2324,17 @@ static PaError IsStreamStopped( PaStream *s )
 static PaError IsStreamActive( PaStream *s )
 {
     PaJackStream *stream = (PaJackStream*)s;
-    return stream->is_active;
+    return stream->is_active && !stream->hostApi->jackIsDown;
 }
 
 
+/* Time of the first frame of the current cycle, in terms of GetStreamTime. Unlike the time GetStreamTime
+ * estimates, this is exact, so frames of the cycle can be told apart by their time */
+static PaTime GetCycleTime( PaJackStream *stream, double sampleRate )
+{
+    return (jack_last_frame_time( stream->jack_client ) - stream->t0) / sampleRate;
+}
+
 static PaTime GetStreamTime( PaStream *s )
 {
     PaJackStream *stream = (PaJackStream*)s;
@@ -1756,6 +2361,30 @@ PaError PaJack_SetClientName( const char* name )
     return paNoError;
 }
 
+PaError PaJack_GetStreamLatencyRanges( PaStream *s, PaJackStreamLatencyRanges *ranges )
+{
+    PaError result = paNoError;
+    PaJackHostApiRepresentation* jackHostApi = NULL;
+    PaJackHostApiRepresentation** ref = &jackHostApi;
+    PaJackStream *stream = (PaJackStream *)s;
+    double sampleRate;
+
+    ENSURE_PA( PaUtil_ValidateStreamPointer( s ) );
+    ENSURE_PA( PaUtil_GetHostApiRepresentation( (PaUtilHostApiRepresentation**)ref, paJACK ) );
+    UNLESS( PA_STREAM_REP( s )->streamInterface == &jackHostApi->callbackStreamInterface
+            || PA_STREAM_REP( s )->streamInterface == &jackHostApi->blockingStreamInterface,
+            paIncompatibleStreamHostApi );
+
+    sampleRate = stream->streamRepresentation.streamInfo.sampleRate;
+    ranges->inputMin = stream->captureLatency.min / sampleRate;
+    ranges->inputMax = stream->captureLatency.max / sampleRate;
+    ranges->outputMin = stream->playbackLatency.min / sampleRate;
+    ranges->outputMax = stream->playbackLatency.max / sampleRate;
+
+error:
+    return result;
+}
+
 PaError PaJack_GetClientName(const char** clientName)
 {
     PaError result = paNoError;
@@ -60,8 +60,12 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/poll.h>
+#include <sys/mman.h>
 #include <limits.h>
 #include <semaphore.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
 
 #ifdef HAVE_SYS_SOUNDCARD_H
 # include <sys/soundcard.h>
@@ -157,6 +161,13 @@ typedef struct
     double latency;
     unsigned long hostFrames, numBufs;
     void **userBuffers; /* For non-interleaved blocking */
+
+    /* The device's DMA buffer, if mapped into our address space (see PaOssStreamComponent_Map). The host buffer
+     * then points into it, and dmaPos counts the bytes we have consumed or produced since dmaBase, wrapping in the
+     * same way as the byte counts reported by SNDCTL_DSP_GETIPTR/GETOPTR */
+    void *dmaBuffer;
+    unsigned long dmaBytes;
+    unsigned int dmaBase, dmaPos;
 } PaOssStreamComponent;
 
 /** Implementation specific representation of a PaStream.
@@ -177,9 +188,6 @@ typedef struct PaOssStream
     int isActive;
     int isStopped;
 
-    int lastPosPtr;
-    double lastStreamBytes;
-
     int framesProcessed;
 
     double sampleRate;
@@ -188,7 +196,10 @@ typedef struct PaOssStream
     volatile int callbackStop, callbackAbort;
 
     PaOssStreamComponent *capture, *playback;
+    PaOssStreamComponent *mmapComponent;   /* The component of a half-duplex callback stream doing mmap I/O, if any */
+    PaStreamCallbackFlags xrunFlags;        /* Xruns detected from the DMA pointers, for the next callback */
     unsigned long pollTimeout;
+    int readyFd;    /* epoll set of the device descriptors handed out by GetStreamPollDescriptor, or -1 */
     sem_t semaphore;
 }
 PaOssStream;
@@ -226,6 +237,9 @@ static PaError ReadStream( PaStream* stream, void *buffer, unsigned long frames
 static PaError WriteStream( PaStream* stream, const void *buffer, unsigned long frames );
 static signed long GetStreamReadAvailable( PaStream* stream );
 static signed long GetStreamWriteAvailable( PaStream* stream );
+static PaError ReadStreamTimeout( PaStream* stream, void *buffer, unsigned long *frames, PaTime timeout );
+static PaError WriteStreamTimeout( PaStream* stream, const void *buffer, unsigned long *frames, PaTime timeout );
+static PaError GetStreamPollDescriptor( PaStream* stream, int *fd );
 static PaError BuildDeviceList( PaOSSHostApiRepresentation *hostApi );
 
 
@@ -256,6 +270,7 @@ PaError PaOSS_Initialize( PaUtilHostApiRepresentation **hostApi, PaHostApiIndex
     (*hostApi)->Terminate = Terminate;
     (*hostApi)->OpenStream = OpenStream;
     (*hostApi)->IsFormatSupported = IsFormatSupported;
+    (*hostApi)->UpdateDeviceInfo = NULL;
 
     PA_ENSURE( BuildDeviceList( ossHostApi ) );
 
@@ -270,6 +285,9 @@ PaError PaOSS_Initialize( PaUtilHostApiRepresentation **hostApi, PaHostApiIndex
                                       StopStream, AbortStream, IsStreamStopped, IsStreamActive,
                                       GetStreamTime, PaUtil_DummyGetCpuLoad,
                                       ReadStream, WriteStream, GetStreamReadAvailable, GetStreamWriteAvailable );
+    ossHostApi->blockingStreamInterface.ReadTimeout = ReadStreamTimeout;
+    ossHostApi->blockingStreamInterface.WriteTimeout = WriteStreamTimeout;
+    ossHostApi->blockingStreamInterface.GetPollDescriptor = GetStreamPollDescriptor;
 
     mainThread_ = pthread_self();
 
@@ -325,6 +343,15 @@ static int CalcHigherLogTwo( int n )
     return log2;
 }
 
+/* Exponent of the power of two closest to n */
+static int CalcNearestLogTwo( int n )
+{
+    int log2 = CalcHigherLogTwo( n );
+    if( log2 > 0 && (1 << log2) - n > n - (1 << (log2 - 1)) )
+        --log2;
+    return log2;
+}
+
 static PaError QueryDirection( const char *deviceName, StreamMode mode, double *defaultSampleRate, int *maxChannelCount,
         double *defaultLowLatency, double *defaultHighLatency )
 {
@@ -774,9 +801,12 @@ static void PaOssStreamComponent_Terminate( PaOssStreamComponent *component )
 {
     assert( component );
 
+    if( component->dmaBuffer )
+        munmap( component->dmaBuffer, component->dmaBytes );
     if( component->fd >= 0 )
         close( component->fd );
-    if( component->buffer )
+    /* Of a mapped component, the host buffer points into the DMA buffer */
+    if( component->buffer && !component->dmaBuffer )
         PaUtil_FreeMemory( component->buffer );
 
     if( component->userBuffers )
@@ -862,6 +892,7 @@ static PaError PaOssStream_Initialize( PaOssStream *stream, const PaStreamParame
 
     memset( stream, 0, sizeof (PaOssStream) );
     stream->isStopped = 1;
+    stream->readyFd = -1;
 
     PA_ENSURE( PaUtil_InitializeThreading( &stream->threading ) );
 
@@ -916,6 +947,8 @@ static void PaOssStream_Terminate( PaOssStream *stream )
         PaOssStreamComponent_Terminate( stream->capture );
     if( stream->playback )
         PaOssStreamComponent_Terminate( stream->playback );
+    if( stream->readyFd >= 0 )
+        close( stream->readyFd );
 
     sem_destroy( &stream->semaphore );
 
@@ -996,7 +1029,7 @@ static PaError PaOssStreamComponent_Configure( PaOssStreamComponent *component,
     int frgmt;
     int numBufs;
     int bytesPerBuf;
-    unsigned long bufSz;
+    unsigned long latencyFrames;
     unsigned long fragSz;
     audio_buf_info bufInfo;
 
@@ -1007,24 +1040,28 @@ static PaError PaOssStreamComponent_Configure( PaOssStreamComponent *component,
         /* Aspect BufferSettings: If framesPerBuffer is unspecified we have to infer a suitable fragment size.
          * The hardware need not respect the requested fragment size, so we may have to adapt.
          */
+        latencyFrames = (unsigned long)(component->latency * sampleRate + .5);
         if( framesPerBuffer == paFramesPerBufferUnspecified )
         {
-            /* Aim for 4 fragments in the complete buffer; the latency comes from 3 of these */
-            fragSz = (unsigned long)(component->latency * sampleRate / 3);
-            bufSz = fragSz * 4;
+            /* Aim for the latency to come from 3 fragments */
+            fragSz = PA_MAX( latencyFrames / 3, 1 );
         }
         else
         {
             fragSz = framesPerBuffer;
-            bufSz = (unsigned long)(component->latency * sampleRate) + fragSz; /* Latency + 1 buffer */
         }
 
         PA_ENSURE( GetAvailableFormats( component, &availableFormats ) );
         hostFormat = PaUtil_SelectClosestAvailableFormat( availableFormats, component->userFormat );
 
-        /* OSS demands at least 2 buffers, and 16 bytes per buffer */
-        numBufs = (int)PA_MAX( bufSz / fragSz, 2 );
-        bytesPerBuf = PA_MAX( fragSz * Pa_GetSampleSize( hostFormat ) * chans, 16 );
+        /* Fragments are a power of two bytes, take the one closest to what we want rather than the next larger so
+         * that the latency doesn't grow by up to a factor of two. OSS demands at least 16 bytes per fragment. */
+        bytesPerBuf = 1 << CalcNearestLogTwo( PA_MAX( fragSz * Pa_GetSampleSize( hostFormat ) * chans, 16 ) );
+        fragSz = PA_MAX( bytesPerBuf / (Pa_GetSampleSize( hostFormat ) * chans), 1 );
+
+        /* Playback latency comes from all fragments but the one being refilled, so with the fragment size settled
+         * pick the number of fragments that brings it closest to the suggested latency. OSS demands at least 2. */
+        numBufs = (int)PA_MIN( PA_MAX( (latencyFrames + fragSz / 2) / fragSz + 1, 2 ), 0x7fff );
 
         /* The fragment parameters are encoded like this:
          * Most significant byte: number of fragments
@@ -1111,6 +1148,91 @@ error:
     return result;
 }
 
+/** Map the DMA buffer of a configured component, so that the buffer processor can work on it directly.
+ *
+ * Mapping requires the mmap and trigger capabilities, and a buffer consisting of whole host buffers. If any of this
+ * isn't met the component is left to do read/write I/O.
+ * @return Whether the buffer was mapped.
+ */
+static int PaOssStreamComponent_Map( PaOssStreamComponent *component, StreamMode streamMode )
+{
+    int caps = 0;
+    audio_buf_info bufInfo;
+    unsigned long fragBytes = component->hostFrames * PaOssStreamComponent_FrameSize( component );
+    void *dmaBuffer;
+
+    if( ioctl( component->fd, SNDCTL_DSP_GETCAPS, &caps ) < 0 || !(caps & DSP_CAP_MMAP) || !(caps & DSP_CAP_TRIGGER) )
+        return 0;
+    if( ioctl( component->fd, streamMode == StreamMode_In ? SNDCTL_DSP_GETISPACE : SNDCTL_DSP_GETOSPACE, &bufInfo ) < 0
+            || bufInfo.fragsize <= 0 || (unsigned long)bufInfo.fragsize != fragBytes || bufInfo.fragstotal < 2 )
+        return 0;
+
+    /* The protection selects which of the device's buffers is mapped */
+    dmaBuffer = mmap( NULL, bufInfo.fragstotal * fragBytes, streamMode == StreamMode_In ? PROT_READ : PROT_WRITE,
+            MAP_SHARED, component->fd, 0 );
+    if( dmaBuffer == MAP_FAILED )
+    {
+        PA_DEBUG(( "%s: Failed to map DMA buffer of %s: %s\n", __FUNCTION__, component->devName, strerror( errno ) ));
+        return 0;
+    }
+
+    PaUtil_FreeMemory( component->buffer );
+    component->buffer = component->dmaBuffer = dmaBuffer;
+    component->dmaBytes = bufInfo.fragstotal * fragBytes;
+    return 1;
+}
+
+/** Get the number of frames that can be processed through the DMA buffer of a mapped component, and point the host
+ * buffer at them.
+ *
+ * The frames are limited to the part of the buffer before it wraps around. If the device has overtaken us we skip to
+ * where it is, recording the xrun in xrunFlags.
+ */
+static PaError PaOssStreamComponent_GetMmapAvail( PaOssStreamComponent *component, StreamMode streamMode,
+        unsigned long *frames, PaStreamCallbackFlags *xrunFlags )
+{
+    PaError result = paNoError;
+    count_info info;
+    unsigned int frameSize = PaOssStreamComponent_FrameSize( component );
+    unsigned int fragBytes = component->hostFrames * frameSize;
+    unsigned int hwPos, avail, offset;
+
+    ENSURE_( ioctl( component->fd, streamMode == StreamMode_In ? SNDCTL_DSP_GETIPTR : SNDCTL_DSP_GETOPTR, &info ),
+            paUnanticipatedHostError );
+    hwPos = (unsigned int)info.bytes;
+
+    if( streamMode == StreamMode_In )
+    {
+        avail = hwPos - component->dmaPos;
+        if( avail > component->dmaBytes )
+        {
+            /* Overrun, continue from the fragment the device is filling */
+            component->dmaPos = hwPos - (hwPos - component->dmaBase) % fragBytes;
+            avail = hwPos - component->dmaPos;
+            *xrunFlags |= paInputOverflow;
+        }
+    }
+    else
+    {
+        unsigned int queued = component->dmaPos - hwPos;
+        if( queued > component->dmaBytes )
+        {
+            /* Underrun, continue after the fragment the device is playing */
+            component->dmaPos = hwPos + fragBytes - (hwPos - component->dmaBase) % fragBytes;
+            queued = component->dmaPos - hwPos;
+            *xrunFlags |= paOutputUnderflow;
+        }
+        avail = component->dmaBytes - queued;
+    }
+
+    offset = (component->dmaPos - component->dmaBase) % component->dmaBytes;
+    component->buffer = (char *)component->dmaBuffer + offset;
+    *frames = PA_MIN( avail, component->dmaBytes - offset ) / frameSize;
+
+error:
+    return result;
+}
+
 /** Configure the stream according to input/output parameters.
  *
  * Aspect StreamChannels: The minimum number of channels supported by the device may exceed that requested by
@@ -1136,7 +1258,8 @@ static PaError PaOssStream_Configure( PaOssStream *stream, double sampleRate, un
         assert( component->hostChannelCount > 0 );
         assert( component->hostFrames > 0 );
 
-        *inputLatency = (component->hostFrames * (component->numBufs - 1)) / sampleRate;
+        /* Captured frames are picked up as soon as a fragment is complete */
+        *inputLatency = component->hostFrames / sampleRate;
     }
     if( stream->playback )
     {
@@ -1147,6 +1270,7 @@ static PaError PaOssStream_Configure( PaOssStream *stream, double sampleRate, un
         assert( component->hostChannelCount > 0 );
         assert( component->hostFrames > 0 );
 
+        /* The buffer is refilled as soon as a fragment has been played */
         *outputLatency = (component->hostFrames * (component->numBufs - 1)) / sampleRate;
     }
 
@@ -1160,6 +1284,18 @@ static PaError PaOssStream_Configure( PaOssStream *stream, double sampleRate, un
     stream->framesPerHostBuffer = framesPerHostBuffer;
     stream->pollTimeout = (int) ceil( 1e6 * framesPerHostBuffer / sampleRate );    /* Period in usecs, rounded up */
 
+    /* Callback streams in one direction can have the buffer processor work on the DMA buffer directly. Both directions
+     * of a full-duplex stream are served by the same open file, which can't map both of its buffers. */
+    if( stream->callbackMode && !duplex && !(getenv( "PA_OSS_MMAP" ) && !atoi( getenv( "PA_OSS_MMAP" ) )) )
+    {
+        PaOssStreamComponent *component = stream->capture ? stream->capture : stream->playback;
+        if( PaOssStreamComponent_Map( component, stream->capture ? StreamMode_In : StreamMode_Out ) )
+        {
+            PA_DEBUG(( "%s: Using mmap I/O\n", __FUNCTION__ ));
+            stream->mmapComponent = component;
+        }
+    }
+
     stream->sampleRate = stream->streamRepresentation.streamInfo.sampleRate = sampleRate;
 
 error:
@@ -1253,17 +1389,9 @@ static PaError OpenStream( struct PaUtilHostApiRepresentation *hostApi,
     PaUtil_InitializeCpuLoadMeasurer( &stream->cpuLoadMeasurer, sampleRate );
 
     if( inputParameters )
-    {
         inputHostFormat = stream->capture->hostFormat;
-        stream->streamRepresentation.streamInfo.inputLatency = inLatency +
-            PaUtil_GetBufferProcessorInputLatencyFrames( &stream->bufferProcessor ) / sampleRate;
-    }
     if( outputParameters )
-    {
         outputHostFormat = stream->playback->hostFormat;
-        stream->streamRepresentation.streamInfo.outputLatency = outLatency +
-            PaUtil_GetBufferProcessorOutputLatencyFrames( &stream->bufferProcessor ) / sampleRate;
-    }
 
     /* Initialize buffer processor with fixed host buffer size.
      * Aspect StreamSampleFormat: Here we commit the user and host sample formats, PA infrastructure will
@@ -1275,6 +1403,14 @@ static PaError OpenStream( struct PaUtilHostApiRepresentation *hostApi,
               paUtilFixedHostBufferSize, streamCallback, userData ) );
     bpInitialized = 1;
 
+    /* The buffer processor adds its own latency when adapting between user and host buffer sizes */
+    if( inputParameters )
+        stream->streamRepresentation.streamInfo.inputLatency = inLatency +
+            PaUtil_GetBufferProcessorInputLatencyFrames( &stream->bufferProcessor ) / sampleRate;
+    if( outputParameters )
+        stream->streamRepresentation.streamInfo.outputLatency = outLatency +
+            PaUtil_GetBufferProcessorOutputLatencyFrames( &stream->bufferProcessor ) / sampleRate;
+
     *s = (PaStream*)stream;
 
     return result;
@@ -1288,6 +1424,47 @@ error:
     return result;
 }
 
+/** Wait for a host buffer's worth of frames in the DMA buffer of a mapped stream.
+ *
+ * The progress of the device is followed through SNDCTL_DSP_GETIPTR/GETOPTR, in between we sleep for about as long as
+ * it takes the device to get to the next host buffer.
+ */
+static PaError PaOssStream_WaitForMmapFrames( PaOssStream *stream, unsigned long *frames )
+{
+    PaError result = paNoError;
+    PaOssStreamComponent *component = stream->mmapComponent;
+    StreamMode streamMode = component == stream->capture ? StreamMode_In : StreamMode_Out;
+    unsigned long avail;
+
+    while( 1 )
+    {
+        struct timeval selectTimeval = {0, 0};
+
+#ifdef PTHREAD_CANCELED
+        pthread_testcancel();
+#else
+        /* avoid indefinite waiting on thread not supporting cancelation */
+        if( stream->callbackStop || stream->callbackAbort )
+        {
+            PA_DEBUG(( "Cancelling PaOssStream_WaitForMmapFrames\n" ));
+            (*frames) = 0;
+            return paNoError;
+        }
+#endif
+        PA_ENSURE( PaOssStreamComponent_GetMmapAvail( component, streamMode, &avail, &stream->xrunFlags ) );
+        if( avail >= stream->framesPerHostBuffer )
+            break;
+
+        selectTimeval.tv_usec = (long)ceil( 1e6 * (stream->framesPerHostBuffer - avail) / stream->sampleRate );
+        ENSURE_( select( 0, NULL, NULL, NULL, &selectTimeval ), paUnanticipatedHostError );
+    }
+
+    *frames = avail - avail % stream->framesPerHostBuffer;
+
+error:
+    return result;
+}
+
 /*! Poll on I/O filedescriptors.
 
   Poll till we've determined there's data for read or write. In the full-duplex case,
@@ -1314,6 +1491,9 @@ static PaError PaOssStream_WaitForFrames( PaOssStream *stream, unsigned long *fr
     assert( stream );
     assert( frames );
 
+    if( stream->mmapComponent )
+        return PaOssStream_WaitForMmapFrames( stream, frames );
+
     if( stream->capture )
     {
         pollCapture = 1;
@@ -1466,6 +1646,33 @@ static PaError PaOssStream_Prepare( PaOssStream *stream )
     if( stream->triggered )
         return result;
 
+    if( stream->mmapComponent )
+    {
+        PaOssStreamComponent *component = stream->mmapComponent;
+        count_info info;
+
+        ENSURE_( ioctl( component->fd, SNDCTL_DSP_SETTRIGGER, &enableBits ), paUnanticipatedHostError );
+
+        /* Processing starts at the beginning of the DMA buffer, for playback the device first goes through a buffer
+         * full of silence */
+        ENSURE_( ioctl( component->fd, component == stream->capture ? SNDCTL_DSP_GETIPTR : SNDCTL_DSP_GETOPTR, &info ),
+                paUnanticipatedHostError );
+        component->dmaBase = (unsigned int)info.bytes - info.ptr;
+        component->dmaPos = component->dmaBase;
+        if( component == stream->playback )
+        {
+            memset( component->dmaBuffer, 0, component->dmaBytes );
+            component->dmaPos += component->dmaBytes;
+        }
+        stream->xrunFlags = 0;
+
+        enableBits = component == stream->capture ? PCM_ENABLE_INPUT : PCM_ENABLE_OUTPUT;
+        ENSURE_( ioctl( component->fd, SNDCTL_DSP_SETTRIGGER, &enableBits ), paUnanticipatedHostError );
+        stream->triggered = 1;
+
+        return result;
+    }
+
     /* The OSS reference instructs us to clear direction bits before setting them.*/
     if( stream->playback )
         ENSURE_( ioctl( stream->playback->fd, SNDCTL_DSP_SETTRIGGER, &enableBits ), paUnanticipatedHostError );
@@ -1525,6 +1732,42 @@ static PaError PaOssStream_Stop( PaOssStream *stream, int abort )
      * Also disable capture/playback till the stream is started again.
      */
     int captureErr = 0, playbackErr = 0;
+
+    if( stream->mmapComponent )
+    {
+        PaOssStreamComponent *component = stream->mmapComponent;
+        int enableBits = 0;
+        count_info info;
+
+        /* The device keeps cycling through the DMA buffer, so silence what has been played already and let the rest
+         * play out before disabling it */
+        if( !abort && component == stream->playback &&
+                ioctl( component->fd, SNDCTL_DSP_GETOPTR, &info ) >= 0 )
+        {
+            unsigned int queued = component->dmaPos - (unsigned int)info.bytes;
+            if( queued < component->dmaBytes )
+            {
+                unsigned int offset = (component->dmaPos - component->dmaBase) % component->dmaBytes;
+                unsigned int silent = component->dmaBytes - queued;
+                unsigned int frameSize = PaOssStreamComponent_FrameSize( component );
+                unsigned int head = PA_MIN( silent, component->dmaBytes - offset );
+
+                memset( (char *)component->dmaBuffer + offset, 0, head );
+                memset( component->dmaBuffer, 0, silent - head );
+                Pa_Sleep( (long)ceil( 1e3 * queued / frameSize / stream->sampleRate ) );
+            }
+        }
+
+        /* Prepare from scratch when started again */
+        stream->triggered = 0;
+        if( ioctl( component->fd, SNDCTL_DSP_SETTRIGGER, &enableBits ) < 0 )
+        {
+            PA_DEBUG(( "%s: Failed to stop device\n", __FUNCTION__ ));
+            result = paUnanticipatedHostError;
+        }
+        return result;
+    }
+
     if( stream->capture )
     {
         if( (captureErr = ioctl( stream->capture->fd, SNDCTL_DSP_POST, 0 )) < 0 )
@@ -1591,6 +1834,69 @@ static PaError SetUpBuffers( PaOssStream *stream, unsigned long framesAvail )
     return result;
 }
 
+/** Compute the time info for the host buffers about to be processed.
+ *
+ * The ADC time is derived from how many frames have been captured but not yet read, and the DAC time from how many
+ * are queued for playback before what we are about to write (SNDCTL_DSP_GETODELAY). Of a mapped component the DMA
+ * pointers tell the same.
+ */
+static void PaOssStream_GetTimeInfo( PaOssStream *stream, PaStreamCallbackTimeInfo *timeInfo )
+{
+    PaOssStreamComponent *component;
+    count_info info;
+
+    timeInfo->currentTime = PaUtil_GetTime();
+
+    if( (component = stream->capture) )
+    {
+        audio_buf_info bufInfo;
+        unsigned int captured;
+
+        if( component == stream->mmapComponent )
+        {
+            if( ioctl( component->fd, SNDCTL_DSP_GETIPTR, &info ) < 0 )
+                return;
+            captured = (unsigned int)info.bytes - component->dmaPos;
+        }
+        else
+        {
+            if( ioctl( component->fd, SNDCTL_DSP_GETISPACE, &bufInfo ) < 0 )
+                return;
+            captured = bufInfo.bytes;
+        }
+        timeInfo->inputBufferAdcTime = timeInfo->currentTime -
+            captured / PaOssStreamComponent_FrameSize( component ) / stream->sampleRate;
+    }
+
+    if( (component = stream->playback) )
+    {
+        unsigned int queued;
+
+        if( component == stream->mmapComponent )
+        {
+            if( ioctl( component->fd, SNDCTL_DSP_GETOPTR, &info ) < 0 )
+                return;
+            queued = component->dmaPos - (unsigned int)info.bytes;
+        }
+        else
+        {
+#ifdef SNDCTL_DSP_GETODELAY
+            int delay = 0;
+            if( ioctl( component->fd, SNDCTL_DSP_GETODELAY, &delay ) < 0 )
+                return;
+            queued = delay;
+#else
+            audio_buf_info bufInfo;
+            if( ioctl( component->fd, SNDCTL_DSP_GETOSPACE, &bufInfo ) < 0 )
+                return;
+            queued = PaOssStreamComponent_BufferSize( component ) - bufInfo.bytes;
+#endif
+        }
+        timeInfo->outputBufferDacTime = timeInfo->currentTime +
+            queued / PaOssStreamComponent_FrameSize( component ) / stream->sampleRate;
+    }
+}
+
 /** Thread procedure for callback processing.
  *
  * Aspect StreamState: StartStream will wait on this to initiate audio processing, useful in case the
@@ -1607,7 +1913,7 @@ static void *PaOSS_AudioThreadProc( void *userData )
     int triggered = stream->triggered;  /* See if SNDCTL_DSP_TRIGGER has been issued already */
     int initiateProcessing = triggered;    /* Already triggered? */
     PaStreamCallbackFlags cbFlags = 0;  /* We might want to keep state across iterations */
-    PaStreamCallbackTimeInfo timeInfo = {0,0,0}; /* TODO: IMPLEMENT ME */
+    PaStreamCallbackTimeInfo timeInfo = {0,0,0};
 
     /*
 #if ( SOUND_VERSION > 0x030904 )
@@ -1689,8 +1995,16 @@ static void *PaOSS_AudioThreadProc( void *userData )
 #endif
             PaUtil_BeginCpuLoadMeasurement( &stream->cpuLoadMeasurer );
 
-            /* Read data */
-            if ( stream->capture )
+            /* Before reading, while the frames are still accounted for by the device */
+            PaOssStream_GetTimeInfo( stream, &timeInfo );
+
+            /* Read data, unless the buffer processor works on the DMA buffer directly */
+            if( stream->mmapComponent )
+            {
+                cbFlags |= stream->xrunFlags;
+                stream->xrunFlags = 0;
+            }
+            else if ( stream->capture )
             {
                 PA_ENSURE( PaOssStreamComponent_Read( stream->capture, &frames ) );
                 if( frames < framesAvail )
@@ -1728,7 +2042,11 @@ static void *PaOSS_AudioThreadProc( void *userData )
             assert( framesProcessed == framesAvail );
             PaUtil_EndCpuLoadMeasurement( &stream->cpuLoadMeasurer, framesProcessed );
 
-            if ( stream->playback )
+            if( stream->mmapComponent )
+            {
+                stream->mmapComponent->dmaPos += framesProcessed * PaOssStreamComponent_FrameSize( stream->mmapComponent );
+            }
+            else if ( stream->playback )
             {
                 frames = framesAvail;
 
@@ -1802,8 +2120,6 @@ static PaError StartStream( PaStream *s )
 
     stream->isActive = 1;
     stream->isStopped = 0;
-    stream->lastPosPtr = 0;
-    stream->lastStreamBytes = 0;
     stream->framesProcessed = 0;
 
     /* only use the thread for callback streams */
@@ -1884,28 +2200,15 @@ static PaError IsStreamActive( PaStream *s )
     return (stream->isActive);
 }
 
+/** Get the stream time.
+ *
+ * This is the timebase of the time info passed to the callback.
+ */
 static PaTime GetStreamTime( PaStream *s )
 {
-    PaOssStream *stream = (PaOssStream*)s;
-    count_info info;
-    int delta;
+    (void) s; /* unused parameter */
 
-    if( stream->playback ) {
-        if( ioctl( stream->playback->fd, SNDCTL_DSP_GETOPTR, &info) == 0 ) {
-            delta = ( info.bytes - stream->lastPosPtr ) /* & 0x000FFFFF*/;
-            return (float)(stream->lastStreamBytes + delta) / PaOssStreamComponent_FrameSize( stream->playback ) / stream->sampleRate;
-        }
-    }
-    else {
-        if (ioctl( stream->capture->fd, SNDCTL_DSP_GETIPTR, &info) == 0) {
-            delta = (info.bytes - stream->lastPosPtr) /*& 0x000FFFFF*/;
-            return (float)(stream->lastStreamBytes + delta) / PaOssStreamComponent_FrameSize( stream->capture ) / stream->sampleRate;
-        }
-    }
-
-    /* the ioctl failed, but we can still give a coarse estimate */
-
-    return stream->framesProcessed / stream->sampleRate;
+    return PaUtil_GetTime();
 }
 
 
@@ -2043,3 +2346,129 @@ error:
 #endif
 }
 
+/* Poll timeouts are in msecs, a long timeout is cut short rather than overflowing */
+static int PollTimeoutMsecs( PaTime timeout )
+{
+    return timeout > 0. ? (int)PA_MIN( ceil( timeout * 1000. ), (double)INT_MAX ) : 0;
+}
+
+/** Wait for frames to be available in one direction, no longer than timeout.
+ *
+ * The device becomes ready once a fragment can be transferred, which may be fewer frames than waited for. The time
+ * the missing frames take to arrive is then slept off rather than polling the device again right away.
+ *
+ * @return The frames available, or an error.
+ */
+static signed long WaitForAvailable( PaOssStream *stream, StreamMode streamMode, unsigned long frames,
+        PaTime timeout )
+{
+    PaError result = paNoError;
+    PaTime deadline = PaUtil_GetTime() + timeout, remaining;
+    struct pollfd pfd;
+    signed long available;
+
+    pfd.fd = StreamMode_In == streamMode ? stream->capture->fd : stream->playback->fd;
+    pfd.events = StreamMode_In == streamMode ? POLLIN : POLLOUT;
+
+    while( (available = StreamMode_In == streamMode ? GetStreamReadAvailable( stream )
+                : GetStreamWriteAvailable( stream )) >= 0 && (unsigned long)available < frames
+            && (remaining = deadline - PaUtil_GetTime()) > 0. )
+    {
+        int res;
+
+        if( available == 0 )
+            res = poll( &pfd, 1, PollTimeoutMsecs( remaining ) );
+        else
+            res = poll( NULL, 0, PollTimeoutMsecs( PA_MIN( remaining,
+                            (frames - available) / stream->sampleRate ) ) );
+        if( res < 0 && errno != EINTR )
+            ENSURE_( res, paUnanticipatedHostError );
+    }
+
+    return available;
+
+error:
+    return result;
+}
+
+static PaError ReadStreamTimeout( PaStream* s, void *buffer, unsigned long *frames, PaTime timeout )
+{
+    PaOssStream *stream = (PaOssStream*)s;
+    signed long available = WaitForAvailable( stream, StreamMode_In, *frames, timeout );
+
+    if( available < 0 )
+        return available;
+    if( (unsigned long)available < *frames )
+        *frames = available;
+    if( *frames == 0 )
+        return paNoError;
+
+    return ReadStream( s, buffer, *frames );
+}
+
+static PaError WriteStreamTimeout( PaStream* s, const void *buffer, unsigned long *frames, PaTime timeout )
+{
+    PaOssStream *stream = (PaOssStream*)s;
+    signed long available = WaitForAvailable( stream, StreamMode_Out, *frames, timeout );
+
+    if( available < 0 )
+        return available;
+    if( (unsigned long)available < *frames )
+        *frames = available;
+    if( *frames == 0 )
+        return paNoError;
+
+    return WriteStream( s, buffer, *frames );
+}
+
+/** The capture descriptor of an input only stream is handed out as is. Otherwise the device is ready for
+ * playback when its descriptor is writable, which is turned into readability by an epoll set where available.
+ */
+static PaError GetStreamPollDescriptor( PaStream* s, int *fd )
+{
+    PaError result = paNoError;
+    PaOssStream *stream = (PaOssStream*)s;
+#ifdef __linux__
+    struct epoll_event ev;
+    int readyFd = -1;
+#endif
+
+    if( !stream->playback )
+    {
+        *fd = stream->capture->fd;
+        return paNoError;
+    }
+
+#ifdef __linux__
+    if( stream->readyFd < 0 )
+    {
+        ENSURE_( readyFd = epoll_create1( EPOLL_CLOEXEC ), paUnanticipatedHostError );
+
+        memset( &ev, 0, sizeof (ev) );
+        ev.events = EPOLLOUT;
+        /* The shared device of a full duplex stream has a single descriptor */
+        if( stream->capture && stream->capture->fd == stream->playback->fd )
+            ev.events |= EPOLLIN;
+        ENSURE_( epoll_ctl( readyFd, EPOLL_CTL_ADD, stream->playback->fd, &ev ), paUnanticipatedHostError );
+        if( stream->capture && stream->capture->fd != stream->playback->fd )
+        {
+            memset( &ev, 0, sizeof (ev) );
+            ev.events = EPOLLIN;
+            ENSURE_( epoll_ctl( readyFd, EPOLL_CTL_ADD, stream->capture->fd, &ev ), paUnanticipatedHostError );
+        }
+        stream->readyFd = readyFd;
+    }
+
+    *fd = stream->readyFd;
+    return result;
+
+error:
+    if( readyFd >= 0 )
+        close( readyFd );
+    return result;
+#else
+    (void)result; /* unused variable */
+    return paIncompatibleStreamHostApi;
+#endif
+}
+
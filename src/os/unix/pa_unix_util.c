@@ -497,6 +497,11 @@ int PaUnixThread_StopRequested( PaUnixThread* self )
     return self->stopRequested;
 }
 
+void PaUnixThread_RequestStop( PaUnixThread* self )
+{
+    self->stopRequested = 1;
+}
+
 PaError PaUnixMutex_Initialize( PaUnixMutex* self )
 {
     PaError result = paNoError;
@@ -218,6 +218,13 @@ PaError PaUnixThread_NotifyParent( PaUnixThread* self );
  */
 int PaUnixThread_StopRequested( PaUnixThread* self );
 
+/** Request the thread to stop, ahead of PaUnixThread_Terminate.
+ *
+ * The thread finds out through PaUnixThread_StopRequested. This allows the parent to wake the thread before
+ * joining it, or to have several threads wind down at the same time.
+ */
+void PaUnixThread_RequestStop( PaUnixThread* self );
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
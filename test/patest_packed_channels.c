@@ -0,0 +1,183 @@
+/** @file patest_packed_channels.c
+	@ingroup test_src
+	@brief Benchmark the buffer processor converting packed host buffers, which
+	are converted with one converter call per direction, against registering the
+	same buffers channel by channel, which converts one channel at a time. Runs
+	full duplex Int16 host buffers to and from an interleaved Float32 callback
+	for several channel counts, checks that both ways produce the same output,
+	and prints the best time per host buffer out of a number of alternating
+	runs. No audio device is needed.
+*/
+/*
+ * $Id$
+ *
+ * This program uses the PortAudio Portable Audio Library.
+ * For more information see: http://www.portaudio.com/
+ * Copyright (c) 1999-2000 Ross Bencina and Phil Burk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The text above constitutes the entire PortAudio license; however,
+ * the PortAudio community also makes the following non-binding requests:
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version. It is also
+ * requested that these non-binding requests be included along with the
+ * license above.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portaudio.h"
+#include "pa_process.h"
+#include "pa_util.h"
+
+#define SAMPLE_RATE         (48000)
+#define FRAMES_PER_BUFFER   (256)
+#define NUM_BUFFERS         (2000)
+#define MAX_CHANNELS        (128)
+#define NUM_RUNS            (7)   /* the best of alternating runs is reported */
+
+/* Copies input to output, so both conversions are exercised. */
+static int patestCallback( const void *inputBuffer, void *outputBuffer,
+                           unsigned long framesPerBuffer,
+                           const PaStreamCallbackTimeInfo* timeInfo,
+                           PaStreamCallbackFlags statusFlags,
+                           void *userData )
+{
+    int channelCount = *(int*)userData;
+    (void) timeInfo; /* Prevent unused variable warnings. */
+    (void) statusFlags;
+
+    memcpy( outputBuffer, inputBuffer, framesPerBuffer * channelCount * sizeof(float) );
+    return paContinue;
+}
+
+/* Processes NUM_BUFFERS host buffers, registering them as packed or channel by
+   channel, and returns the time taken in seconds. */
+static double Run( int channelCount, int packed, const short *in, short *out )
+{
+    PaUtilBufferProcessor bp;
+    PaStreamCallbackTimeInfo timeInfo = { 0, 0, 0 };
+    int callbackResult = paContinue;
+    PaTime start;
+    int i, c;
+
+    if( PaUtil_InitializeBufferProcessor( &bp, channelCount, paFloat32, paInt16, channelCount, paFloat32, paInt16,
+            SAMPLE_RATE, paClipOff | paDitherOff, 0, FRAMES_PER_BUFFER, paUtilFixedHostBufferSize, patestCallback,
+            &channelCount ) != paNoError )
+        return -1.;
+
+    start = PaUtil_GetTime();
+    for( i = 0; i < NUM_BUFFERS; ++i )
+    {
+        PaUtil_BeginBufferProcessing( &bp, &timeInfo, 0 );
+
+        PaUtil_SetInputFrameCount( &bp, FRAMES_PER_BUFFER );
+        PaUtil_SetOutputFrameCount( &bp, FRAMES_PER_BUFFER );
+        if( packed )
+        {
+            PaUtil_SetInterleavedInputChannels( &bp, 0, (void*)in, 0 );
+            PaUtil_SetInterleavedOutputChannels( &bp, 0, out, 0 );
+        }
+        else
+        {
+            for( c = 0; c < channelCount; ++c )
+            {
+                PaUtil_SetInputChannel( &bp, c, (void*)( in + c ), channelCount );
+                PaUtil_SetOutputChannel( &bp, c, out + c, channelCount );
+            }
+        }
+
+        PaUtil_EndBufferProcessing( &bp, &callbackResult );
+    }
+    start = PaUtil_GetTime() - start;
+
+    PaUtil_TerminateBufferProcessor( &bp );
+    return start;
+}
+
+int main(void);
+int main(void)
+{
+    static const int channelCounts[] = { 2, 8, 32, MAX_CHANNELS };
+    short *in, *outPacked, *outChannels;
+    size_t samples = FRAMES_PER_BUFFER * MAX_CHANNELS;
+    size_t i, j;
+    int result = 0;
+
+    printf( "PortAudio Test: packed vs per-channel conversion, Int16 <-> Float32 full duplex, %d frames, "
+            "%d buffers\n", FRAMES_PER_BUFFER, NUM_BUFFERS );
+
+    in = (short*)malloc( samples * sizeof(short) );
+    outPacked = (short*)malloc( samples * sizeof(short) );
+    outChannels = (short*)malloc( samples * sizeof(short) );
+    if( !in || !outPacked || !outChannels )
+    {
+        fprintf( stderr, "Error: Out of memory.\n" );
+        return 1;
+    }
+    for( i = 0; i < samples; ++i )
+        in[i] = (short)( ( i * 7919 ) & 0xffff );
+
+    printf( "%8s %16s %16s %8s\n", "channels", "per-channel usec", "packed usec", "speedup" );
+    for( j = 0; j < sizeof(channelCounts) / sizeof(channelCounts[0]); ++j )
+    {
+        int channelCount = channelCounts[j];
+        double channelTime = -1., packedTime = -1., t;
+        int run;
+
+        memset( outPacked, 0, samples * sizeof(short) );
+        memset( outChannels, 0xff, samples * sizeof(short) );
+        for( run = 0; run < NUM_RUNS && result == 0; ++run )
+        {
+            t = Run( channelCount, run & 1, in, ( run & 1 ) ? outPacked : outChannels );
+            if( t < 0. )
+            {
+                fprintf( stderr, "Error: Failed to initialize the buffer processor.\n" );
+                result = 1;
+            }
+            else if( run & 1 )
+                packedTime = ( packedTime < 0. || t < packedTime ) ? t : packedTime;
+            else
+                channelTime = ( channelTime < 0. || t < channelTime ) ? t : channelTime;
+        }
+        if( result != 0 )
+            break;
+        if( memcmp( outPacked, outChannels, FRAMES_PER_BUFFER * channelCount * sizeof(short) ) != 0 )
+        {
+            fprintf( stderr, "Error: Output of packed conversion differs for %d channels.\n", channelCount );
+            result = 1;
+        }
+
+        printf( "%8d %16.2f %16.2f %7.2fx\n", channelCount, channelTime * 1e6 / NUM_BUFFERS,
+                packedTime * 1e6 / NUM_BUFFERS, channelTime / packedTime );
+    }
+
+    free( in );
+    free( outPacked );
+    free( outChannels );
+    printf( result == 0 ? "Test finished.\n" : "Test failed.\n" );
+    return result;
+}
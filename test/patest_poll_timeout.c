@@ -0,0 +1,218 @@
+/** @file patest_poll_timeout.c
+	@ingroup test_src
+	@brief Play a sine wave from an event loop: wait on the stream's poll
+	descriptor with epoll and write with Pa_WriteStreamTimeout() and a zero
+	timeout, so that the loop never blocks in PortAudio. Reports how often the
+	descriptor woke the loop without the stream taking any frames.
+*/
+/*
+ * $Id$
+ *
+ * This program uses the PortAudio Portable Audio Library.
+ * For more information see: http://www.portaudio.com/
+ * Copyright (c) 1999-2000 Ross Bencina and Phil Burk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The text above constitutes the entire PortAudio license; however,
+ * the PortAudio community also makes the following non-binding requests:
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version. It is also
+ * requested that these non-binding requests be included along with the
+ * license above.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "portaudio.h"
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+#define NUM_SECONDS         (5)
+#define SAMPLE_RATE         (44100)
+#define FRAMES_PER_BUFFER   (256)
+#define WAIT_MSEC           (1000)
+
+#ifndef M_PI
+#define M_PI  (3.14159265)
+#endif
+
+#define TABLE_SIZE   (200)
+
+
+int main(void);
+int main(void)
+{
+#ifdef __linux__
+    PaStreamParameters outputParameters;
+    PaStream *stream = NULL;
+    PaError err;
+    float buffer[FRAMES_PER_BUFFER][2]; /* stereo output buffer */
+    float sine[TABLE_SIZE]; /* sine wavetable */
+    int left_phase = 0;
+    int right_phase = 0;
+    int i;
+    int fd;
+    int epfd = -1;
+    struct epoll_event event;
+    unsigned long framesLeft = NUM_SECONDS * SAMPLE_RATE;
+    unsigned long pending = 0; /* frames in buffer not yet taken by the stream */
+    unsigned long offset = 0;
+    long wakeups = 0, idleWakeups = 0, timeouts = 0;
+
+    printf( "PortAudio Test: output sine wave from an epoll loop. SR = %d, BufSize = %d\n",
+            SAMPLE_RATE, FRAMES_PER_BUFFER );
+
+    /* initialise sinusoidal wavetable */
+    for( i=0; i<TABLE_SIZE; i++ )
+    {
+        sine[i] = (float) sin( ((double)i/(double)TABLE_SIZE) * M_PI * 2. );
+    }
+
+    err = Pa_Initialize();
+    if( err != paNoError ) goto error;
+
+    outputParameters.device = Pa_GetDefaultOutputDevice(); /* default output device */
+    if( outputParameters.device == paNoDevice )
+    {
+        fprintf( stderr, "Error: No default output device.\n" );
+        err = paInvalidDevice;
+        goto error;
+    }
+    outputParameters.channelCount = 2;       /* stereo output */
+    outputParameters.sampleFormat = paFloat32; /* 32 bit floating point output */
+    outputParameters.suggestedLatency = Pa_GetDeviceInfo( outputParameters.device )->defaultLowOutputLatency;
+    outputParameters.hostApiSpecificStreamInfo = NULL;
+
+    err = Pa_OpenStream(
+              &stream,
+              NULL, /* no input */
+              &outputParameters,
+              SAMPLE_RATE,
+              FRAMES_PER_BUFFER,
+              paClipOff,      /* we won't output out of range samples so don't bother clipping them */
+              NULL, /* no callback, use blocking API */
+              NULL ); /* no callback, so no callback userData */
+    if( err != paNoError ) goto error;
+
+    err = Pa_GetStreamPollDescriptor( stream, &fd );
+    if( err != paNoError ) goto error;
+
+    epfd = epoll_create1( 0 );
+    if( epfd < 0 )
+    {
+        perror( "epoll_create1" );
+        goto done;
+    }
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if( epoll_ctl( epfd, EPOLL_CTL_ADD, fd, &event ) < 0 )
+    {
+        perror( "epoll_ctl" );
+        goto done;
+    }
+
+    err = Pa_StartStream( stream );
+    if( err != paNoError ) goto error;
+
+    while( framesLeft > 0 )
+    {
+        unsigned long frames;
+        int n = epoll_wait( epfd, &event, 1, WAIT_MSEC );
+        if( n < 0 )
+        {
+            perror( "epoll_wait" );
+            break;
+        }
+        else if( n == 0 )
+        {
+            ++timeouts;
+            continue;
+        }
+        ++wakeups;
+
+        if( pending == 0 )
+        {
+            /* compute the next buffer */
+            for( i=0; i < FRAMES_PER_BUFFER; i++ )
+            {
+                buffer[i][0] = sine[left_phase];  /* left */
+                buffer[i][1] = sine[right_phase];  /* right */
+                left_phase += 1;
+                if( left_phase >= TABLE_SIZE ) left_phase -= TABLE_SIZE;
+                right_phase += 3; /* higher pitch so we can distinguish left and right. */
+                if( right_phase >= TABLE_SIZE ) right_phase -= TABLE_SIZE;
+            }
+            pending = FRAMES_PER_BUFFER;
+            offset = 0;
+        }
+
+        /* never waits, writes whatever the stream can take right now */
+        frames = pending;
+        err = Pa_WriteStreamTimeout( stream, buffer[offset], &frames, 0. );
+        if( err == paOutputUnderflowed )
+            printf( "Output underflowed.\n" );
+        else if( err != paNoError )
+            goto error;
+
+        if( frames == 0 )
+            ++idleWakeups;
+        pending -= frames;
+        offset += frames;
+        framesLeft = framesLeft > frames ? framesLeft - frames : 0;
+    }
+
+    err = Pa_StopStream( stream );
+    if( err != paNoError ) goto error;
+
+    printf( "%ld wakeups, %ld without frames written (%.1f%%), %ld epoll timeouts.\n", wakeups, idleWakeups,
+            wakeups > 0 ? 100. * idleWakeups / wakeups : 0., timeouts );
+
+done:
+    if( epfd >= 0 )
+        close( epfd );
+    epfd = -1;
+    err = Pa_CloseStream( stream );
+    if( err != paNoError ) goto error;
+
+    Pa_Terminate();
+    printf("Test finished.\n");
+
+    return err;
+error:
+    if( epfd >= 0 )
+        close( epfd );
+    Pa_Terminate();
+    fprintf( stderr, "An error occured while using the portaudio stream\n" );
+    fprintf( stderr, "Error number: %d\n", err );
+    fprintf( stderr, "Error message: %s\n", Pa_GetErrorText( err ) );
+    return err;
+#else
+    printf( "PortAudio Test: this test needs epoll, which is only available on Linux.\n" );
+    return 0;
+#endif
+}
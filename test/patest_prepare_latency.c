@@ -0,0 +1,192 @@
+/** @file patest_prepare_latency.c
+	@ingroup test_src
+	@brief Measure how long starting an output stream takes with and without
+	calling Pa_PrepareStream() beforehand: the time Pa_StartStream() takes to
+	return and the time until the stream callback is first called, averaged over
+	a number of starts.
+*/
+/*
+ * $Id$
+ *
+ * This program uses the PortAudio Portable Audio Library.
+ * For more information see: http://www.portaudio.com/
+ * Copyright (c) 1999-2000 Ross Bencina and Phil Burk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The text above constitutes the entire PortAudio license; however,
+ * the PortAudio community also makes the following non-binding requests:
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version. It is also
+ * requested that these non-binding requests be included along with the
+ * license above.
+ */
+
+#include <stdio.h>
+#include "portaudio.h"
+#include "pa_util.h"
+
+#define SAMPLE_RATE         (44100)
+#define FRAMES_PER_BUFFER   (256)
+#define NUM_ROUNDS          (10)
+#define RUN_MSEC            (100)
+#define WAIT_MSEC           (2000)
+
+typedef struct
+{
+    volatile PaTime firstCallTime; /* zero until the callback is first called */
+}
+paTestData;
+
+/* Outputs silence, remembering when it is first called. */
+static int patestCallback( const void *inputBuffer, void *outputBuffer,
+                           unsigned long framesPerBuffer,
+                           const PaStreamCallbackTimeInfo* timeInfo,
+                           PaStreamCallbackFlags statusFlags,
+                           void *userData )
+{
+    paTestData *data = (paTestData*)userData;
+    float *out = (float*)outputBuffer;
+    unsigned long i;
+    (void) inputBuffer; /* Prevent unused variable warnings. */
+    (void) timeInfo;
+    (void) statusFlags;
+
+    if( data->firstCallTime == 0. )
+        data->firstCallTime = PaUtil_GetTime();
+    for( i=0; i<framesPerBuffer; i++ )
+    {
+        *out++ = 0;  /* left */
+        *out++ = 0;  /* right */
+    }
+    return paContinue;
+}
+
+/* Starts and stops the stream NUM_ROUNDS times, preparing it first if asked to. */
+static PaError MeasureStarts( PaStream *stream, paTestData *data, int prepare )
+{
+    PaError err = paNoError;
+    PaTime prepareTime = 0., startTime = 0., firstCallTime = 0.;
+    PaTime t0, t1;
+    int round, msec;
+
+    for( round = 0; round < NUM_ROUNDS; ++round )
+    {
+        data->firstCallTime = 0.;
+
+        if( prepare )
+        {
+            t0 = PaUtil_GetTime();
+            err = Pa_PrepareStream( stream );
+            if( err != paNoError ) return err;
+            prepareTime += PaUtil_GetTime() - t0;
+            Pa_Sleep( RUN_MSEC ); /* preparation happens ahead of the start */
+        }
+
+        t0 = PaUtil_GetTime();
+        err = Pa_StartStream( stream );
+        if( err != paNoError ) return err;
+        t1 = PaUtil_GetTime();
+
+        for( msec = 0; data->firstCallTime == 0. && msec < WAIT_MSEC; msec += 1 )
+            Pa_Sleep( 1 );
+        if( data->firstCallTime == 0. )
+        {
+            fprintf( stderr, "Error: Stream wasn't called within %d msec.\n", WAIT_MSEC );
+            return paTimedOut;
+        }
+
+        startTime += t1 - t0;
+        firstCallTime += data->firstCallTime - t0;
+
+        Pa_Sleep( RUN_MSEC );
+        err = Pa_StopStream( stream );
+        if( err != paNoError ) return err;
+    }
+
+    printf( "%-12s", prepare ? "prepared" : "unprepared" );
+    if( prepare )
+        printf( " Pa_PrepareStream %8.3f msec,", prepareTime * 1000. / NUM_ROUNDS );
+    printf( " Pa_StartStream %8.3f msec, first callback after %8.3f msec\n",
+            startTime * 1000. / NUM_ROUNDS, firstCallTime * 1000. / NUM_ROUNDS );
+    return err;
+}
+
+/*******************************************************************/
+int main(void);
+int main(void)
+{
+    PaStreamParameters outputParameters;
+    PaStream *stream;
+    paTestData data;
+    PaError err;
+
+    printf( "PortAudio Test: start latency with Pa_PrepareStream. SR = %d, BufSize = %d, averaged over %d starts\n",
+            SAMPLE_RATE, FRAMES_PER_BUFFER, NUM_ROUNDS );
+
+    err = Pa_Initialize();
+    if( err != paNoError ) goto error;
+
+    outputParameters.device = Pa_GetDefaultOutputDevice(); /* default output device */
+    if( outputParameters.device == paNoDevice )
+    {
+        fprintf( stderr, "Error: No default output device.\n" );
+        err = paInvalidDevice;
+        goto error;
+    }
+    outputParameters.channelCount = 2;       /* stereo output */
+    outputParameters.sampleFormat = paFloat32; /* 32 bit floating point output */
+    outputParameters.suggestedLatency = Pa_GetDeviceInfo( outputParameters.device )->defaultLowOutputLatency;
+    outputParameters.hostApiSpecificStreamInfo = NULL;
+
+    err = Pa_OpenStream(
+              &stream,
+              NULL, /* no input */
+              &outputParameters,
+              SAMPLE_RATE,
+              FRAMES_PER_BUFFER,
+              paClipOff,      /* we won't output out of range samples so don't bother clipping them */
+              patestCallback,
+              &data );
+    if( err != paNoError ) goto error;
+
+    err = MeasureStarts( stream, &data, 0 );
+    if( err != paNoError ) goto error;
+    err = MeasureStarts( stream, &data, 1 );
+    if( err != paNoError ) goto error;
+
+    err = Pa_CloseStream( stream );
+    if( err != paNoError ) goto error;
+
+    Pa_Terminate();
+    printf("Test finished.\n");
+
+    return err;
+error:
+    Pa_Terminate();
+    fprintf( stderr, "An error occured while using the portaudio stream\n" );
+    fprintf( stderr, "Error number: %d\n", err );
+    fprintf( stderr, "Error message: %s\n", Pa_GetErrorText( err ) );
+    return err;
+}
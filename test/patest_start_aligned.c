@@ -0,0 +1,239 @@
+/** @file patest_start_aligned.c
+	@ingroup test_src
+	@brief Start two output streams together, first with Pa_StartStreamAt() and a
+	common start time, then with Pa_StartStreams(), and report how far apart the
+	first buffers of the streams reach the DAC according to the timeInfo passed
+	to their callbacks.
+
+	Usage: patest_start_aligned [device1 device2]
+
+	Both streams use the default output device unless two devices are given,
+	which should belong to the same host API so that their times compare.
+*/
+/*
+ * $Id$
+ *
+ * This program uses the PortAudio Portable Audio Library.
+ * For more information see: http://www.portaudio.com/
+ * Copyright (c) 1999-2000 Ross Bencina and Phil Burk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The text above constitutes the entire PortAudio license; however,
+ * the PortAudio community also makes the following non-binding requests:
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version. It is also
+ * requested that these non-binding requests be included along with the
+ * license above.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "portaudio.h"
+
+#define SAMPLE_RATE         (44100)
+#define FRAMES_PER_BUFFER   (256)
+#define NUM_ROUNDS          (5)
+#define START_DELAY         (0.5) /* seconds from now for Pa_StartStreamAt() */
+#define RUN_MSEC            (200)
+#define WAIT_MSEC           (2000)
+#define NUM_STREAMS         (2)
+
+typedef struct
+{
+    volatile int called;
+    volatile PaTime firstDacTime;
+}
+paTestData;
+
+/* Outputs silence, remembering when the first buffer reaches the DAC. */
+static int patestCallback( const void *inputBuffer, void *outputBuffer,
+                           unsigned long framesPerBuffer,
+                           const PaStreamCallbackTimeInfo* timeInfo,
+                           PaStreamCallbackFlags statusFlags,
+                           void *userData )
+{
+    paTestData *data = (paTestData*)userData;
+    float *out = (float*)outputBuffer;
+    unsigned long i;
+    (void) inputBuffer; /* Prevent unused variable warnings. */
+    (void) statusFlags;
+
+    if( !data->called )
+    {
+        data->firstDacTime = timeInfo->outputBufferDacTime;
+        data->called = 1;
+    }
+    for( i=0; i<framesPerBuffer; i++ )
+    {
+        *out++ = 0;  /* left */
+        *out++ = 0;  /* right */
+    }
+    return paContinue;
+}
+
+/* Waits for the first callback of every stream. */
+static int WaitForFirstCallbacks( paTestData *data )
+{
+    int i, msec;
+    for( msec = 0; msec < WAIT_MSEC; msec += 10 )
+    {
+        for( i = 0; i < NUM_STREAMS && data[i].called; ++i )
+            ;
+        if( i == NUM_STREAMS )
+            return 1;
+        Pa_Sleep( 10 );
+    }
+    fprintf( stderr, "Error: Streams weren't called within %d msec.\n", WAIT_MSEC );
+    return 0;
+}
+
+/*******************************************************************/
+int main(int argc, char **argv);
+int main(int argc, char **argv)
+{
+    PaStreamParameters outputParameters;
+    PaStream *streams[NUM_STREAMS];
+    paTestData data[NUM_STREAMS];
+    PaError err;
+    PaDeviceIndex devices[NUM_STREAMS];
+    PaTime when, skew, maxSkew, offset, maxOffset;
+    int i, round;
+
+    printf( "PortAudio Test: start two streams aligned. SR = %d, BufSize = %d\n", SAMPLE_RATE, FRAMES_PER_BUFFER );
+
+    err = Pa_Initialize();
+    if( err != paNoError ) goto error;
+
+    for( i = 0; i < NUM_STREAMS; ++i )
+    {
+        devices[i] = argc > NUM_STREAMS ? atoi( argv[1 + i] ) : Pa_GetDefaultOutputDevice();
+        if( devices[i] == paNoDevice || devices[i] >= Pa_GetDeviceCount() )
+        {
+            fprintf( stderr, "Error: No such output device.\n" );
+            err = paInvalidDevice;
+            goto error;
+        }
+    }
+
+    for( i = 0; i < NUM_STREAMS; ++i )
+    {
+        outputParameters.device = devices[i];
+        outputParameters.channelCount = 2;       /* stereo output */
+        outputParameters.sampleFormat = paFloat32; /* 32 bit floating point output */
+        outputParameters.suggestedLatency = Pa_GetDeviceInfo( outputParameters.device )->defaultLowOutputLatency;
+        outputParameters.hostApiSpecificStreamInfo = NULL;
+
+        err = Pa_OpenStream(
+                  &streams[i],
+                  NULL, /* no input */
+                  &outputParameters,
+                  SAMPLE_RATE,
+                  FRAMES_PER_BUFFER,
+                  paClipOff,      /* we won't output out of range samples so don't bother clipping them */
+                  patestCallback,
+                  &data[i] );
+        if( err != paNoError ) goto error;
+        printf( "Stream %d on %s\n", i, Pa_GetDeviceInfo( devices[i] )->name );
+    }
+
+    printf( "\nPa_StartStreamAt(), %.1f seconds ahead:\n", START_DELAY );
+    maxSkew = maxOffset = 0.;
+    for( round = 0; round < NUM_ROUNDS; ++round )
+    {
+        for( i = 0; i < NUM_STREAMS; ++i )
+            data[i].called = 0;
+
+        when = Pa_GetStreamTime( streams[0] ) + START_DELAY;
+        for( i = 0; i < NUM_STREAMS; ++i )
+        {
+            err = Pa_StartStreamAt( streams[i], when );
+            if( err != paNoError ) goto error;
+        }
+        if( !WaitForFirstCallbacks( data ) )
+        {
+            err = paTimedOut;
+            goto error;
+        }
+        Pa_Sleep( RUN_MSEC );
+        err = Pa_StopStreams( streams, NUM_STREAMS );
+        if( err != paNoError ) goto error;
+
+        skew = fabs( data[1].firstDacTime - data[0].firstDacTime );
+        offset = 0.;
+        for( i = 0; i < NUM_STREAMS; ++i )
+        {
+            if( fabs( data[i].firstDacTime - when ) > offset )
+                offset = fabs( data[i].firstDacTime - when );
+        }
+        printf( "round %d: skew %8.3f msec, %8.3f msec from the requested time\n", round, skew * 1000.,
+                offset * 1000. );
+        if( skew > maxSkew ) maxSkew = skew;
+        if( offset > maxOffset ) maxOffset = offset;
+    }
+    printf( "max skew %.3f msec (%.1f frames), max offset %.3f msec\n", maxSkew * 1000., maxSkew * SAMPLE_RATE,
+            maxOffset * 1000. );
+
+    printf( "\nPa_StartStreams():\n" );
+    maxSkew = 0.;
+    for( round = 0; round < NUM_ROUNDS; ++round )
+    {
+        for( i = 0; i < NUM_STREAMS; ++i )
+            data[i].called = 0;
+
+        err = Pa_StartStreams( streams, NUM_STREAMS );
+        if( err != paNoError ) goto error;
+        if( !WaitForFirstCallbacks( data ) )
+        {
+            err = paTimedOut;
+            goto error;
+        }
+        Pa_Sleep( RUN_MSEC );
+        err = Pa_StopStreams( streams, NUM_STREAMS );
+        if( err != paNoError ) goto error;
+
+        skew = fabs( data[1].firstDacTime - data[0].firstDacTime );
+        printf( "round %d: skew %8.3f msec\n", round, skew * 1000. );
+        if( skew > maxSkew ) maxSkew = skew;
+    }
+    printf( "max skew %.3f msec (%.1f frames)\n", maxSkew * 1000., maxSkew * SAMPLE_RATE );
+
+    for( i = 0; i < NUM_STREAMS; ++i )
+    {
+        err = Pa_CloseStream( streams[i] );
+        if( err != paNoError ) goto error;
+    }
+
+    Pa_Terminate();
+    printf("Test finished.\n");
+
+    return err;
+error:
+    Pa_Terminate();
+    fprintf( stderr, "An error occured while using the portaudio stream\n" );
+    fprintf( stderr, "Error number: %d\n", err );
+    fprintf( stderr, "Error message: %s\n", Pa_GetErrorText( err ) );
+    return err;
+}
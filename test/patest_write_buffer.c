@@ -0,0 +1,181 @@
+/** @file patest_write_buffer.c
+	@ingroup test_src
+	@brief Play a sine wave by writing it straight into the buffer acquired with
+	Pa_GetStreamWriteBuffer() and committing it with Pa_CommitStreamWriteBuffer().
+	Also checks that a second acquisition before the commit is refused. Reports
+	how often the stream handed out fewer frames than wanted.
+*/
+/*
+ * $Id$
+ *
+ * This program uses the PortAudio Portable Audio Library.
+ * For more information see: http://www.portaudio.com/
+ * Copyright (c) 1999-2000 Ross Bencina and Phil Burk
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The text above constitutes the entire PortAudio license; however,
+ * the PortAudio community also makes the following non-binding requests:
+ *
+ * Any person wishing to distribute modifications to the Software is
+ * requested to send the modifications to the original developer so that
+ * they can be incorporated into the canonical version. It is also
+ * requested that these non-binding requests be included along with the
+ * license above.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "portaudio.h"
+
+#define NUM_SECONDS         (5)
+#define SAMPLE_RATE         (44100)
+#define FRAMES_PER_BUFFER   (256)
+
+#ifndef M_PI
+#define M_PI  (3.14159265)
+#endif
+
+#define TABLE_SIZE   (200)
+
+
+int main(void);
+int main(void)
+{
+    PaStreamParameters outputParameters;
+    PaStream *stream;
+    PaError err;
+    float sine[TABLE_SIZE]; /* sine wavetable */
+    int left_phase = 0;
+    int right_phase = 0;
+    int i;
+    void *buffer, *buffer2;
+    unsigned long frames, frames2;
+    unsigned long framesLeft = NUM_SECONDS * SAMPLE_RATE;
+    long acquisitions = 0, shortAcquisitions = 0;
+
+    printf( "PortAudio Test: output sine wave written into the stream's buffer. SR = %d, BufSize = %d\n",
+            SAMPLE_RATE, FRAMES_PER_BUFFER );
+
+    /* initialise sinusoidal wavetable */
+    for( i=0; i<TABLE_SIZE; i++ )
+    {
+        sine[i] = (float) sin( ((double)i/(double)TABLE_SIZE) * M_PI * 2. );
+    }
+
+    err = Pa_Initialize();
+    if( err != paNoError ) goto error;
+
+    outputParameters.device = Pa_GetDefaultOutputDevice(); /* default output device */
+    if( outputParameters.device == paNoDevice )
+    {
+        fprintf( stderr, "Error: No default output device.\n" );
+        err = paInvalidDevice;
+        goto error;
+    }
+    outputParameters.channelCount = 2;       /* stereo output */
+    outputParameters.sampleFormat = paFloat32; /* 32 bit floating point output */
+    outputParameters.suggestedLatency = Pa_GetDeviceInfo( outputParameters.device )->defaultLowOutputLatency;
+    outputParameters.hostApiSpecificStreamInfo = NULL;
+
+    err = Pa_OpenStream(
+              &stream,
+              NULL, /* no input */
+              &outputParameters,
+              SAMPLE_RATE,
+              FRAMES_PER_BUFFER,
+              paClipOff,      /* we won't output out of range samples so don't bother clipping them */
+              NULL, /* no callback, use blocking API */
+              NULL ); /* no callback, so no callback userData */
+    if( err != paNoError ) goto error;
+
+    err = Pa_StartStream( stream );
+    if( err != paNoError ) goto error;
+
+    /* a buffer must be committed before the next one is acquired */
+    frames = FRAMES_PER_BUFFER;
+    err = Pa_GetStreamWriteBuffer( stream, &buffer, &frames );
+    if( err != paNoError ) goto error;
+    frames2 = FRAMES_PER_BUFFER;
+    err = Pa_GetStreamWriteBuffer( stream, &buffer2, &frames2 );
+    if( err != paWriteBufferNotCommitted )
+    {
+        fprintf( stderr, "Error: second acquisition returned %d (%s), expected paWriteBufferNotCommitted.\n",
+                 err, Pa_GetErrorText( err ) );
+        if( err == paNoError )
+            err = paInternalError;
+        goto error;
+    }
+    err = Pa_CommitStreamWriteBuffer( stream, 0 ); /* release without writing */
+    if( err != paNoError ) goto error;
+
+    while( framesLeft > 0 )
+    {
+        float *out;
+        unsigned long wanted = framesLeft < FRAMES_PER_BUFFER ? framesLeft : FRAMES_PER_BUFFER;
+
+        frames = wanted;
+        err = Pa_GetStreamWriteBuffer( stream, &buffer, &frames );
+        if( err != paNoError ) goto error;
+        ++acquisitions;
+        if( frames < wanted )
+            ++shortAcquisitions;
+
+        out = (float *)buffer;
+        for( i=0; i < (int)frames; i++ )
+        {
+            *out++ = sine[left_phase];  /* left */
+            *out++ = sine[right_phase];  /* right */
+            left_phase += 1;
+            if( left_phase >= TABLE_SIZE ) left_phase -= TABLE_SIZE;
+            right_phase += 3; /* higher pitch so we can distinguish left and right. */
+            if( right_phase >= TABLE_SIZE ) right_phase -= TABLE_SIZE;
+        }
+
+        err = Pa_CommitStreamWriteBuffer( stream, frames );
+        if( err == paOutputUnderflowed )
+            printf( "Output underflowed.\n" );
+        else if( err != paNoError )
+            goto error;
+
+        framesLeft -= frames;
+    }
+
+    err = Pa_StopStream( stream );
+    if( err != paNoError ) goto error;
+
+    printf( "%ld acquisitions, %ld with fewer frames than wanted.\n", acquisitions, shortAcquisitions );
+
+    err = Pa_CloseStream( stream );
+    if( err != paNoError ) goto error;
+
+    Pa_Terminate();
+    printf("Test finished.\n");
+
+    return err;
+error:
+    Pa_Terminate();
+    fprintf( stderr, "An error occured while using the portaudio stream\n" );
+    fprintf( stderr, "Error number: %d\n", err );
+    fprintf( stderr, "Error message: %s\n", Pa_GetErrorText( err ) );
+    return err;
+}